@@ -0,0 +1,169 @@
+/*
+ * Host benchmark of the exact multiplies in ipsa_bigint.c against operand
+ * size.
+ *
+ * First the 64 bit overflow checked multiply, then multi-limb products of
+ * two random operands of 1 to 4096 limbs each, by schoolbook multiplication
+ * and by vBigMul(), which switches to Karatsuba at bigKARATSUBA_THRESHOLD
+ * limbs.  Every vBigMul() product is compared with the schoolbook one, for
+ * equal sizes and for a few unbalanced pairs, so a wrong result aborts the
+ * run.  Results are printed as CSV.
+ *
+ *   gcc -O2 bigint_bench.c ipsa_bigint.c -o bigint_bench
+ *   ./bigint_bench [largest size in limbs]
+ *
+ * Build with -DbigKARATSUBA_THRESHOLD=n to try another crossover.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include "ipsa_bigint.h"
+
+#define DEFAULT_MAX_LIMBS  4096
+#define MIN_TIME_NS        200000000ULL
+
+static volatile int64_t sink;
+
+static uint64_t now_ns( void )
+{
+	struct timespec ts;
+
+	clock_gettime( CLOCK_MONOTONIC, &ts );
+	return ( uint64_t ) ts.tv_sec * 1000000000ULL + ( uint64_t ) ts.tv_nsec;
+}
+
+static uint64_t next_random( uint64_t * state )
+{
+	/* xorshift64 */
+	*state ^= *state << 13;
+	*state ^= *state >> 7;
+	*state ^= *state << 17;
+	return *state;
+}
+
+static void fill( BigLimb_t * limbs, size_t n, uint64_t * state )
+{
+	for ( size_t i = 0; i < n; i++ )
+		limbs[ i ] = ( BigLimb_t ) next_random( state );
+}
+
+static void check( const BigLimb_t * a, size_t na, const BigLimb_t * b, size_t nb,
+                   BigLimb_t * expected, BigLimb_t * result, BigLimb_t * scratch )
+{
+	vBigMulSchoolbook( a, na, b, nb, expected );
+	vBigMul( a, na, b, nb, result, scratch );
+
+	if ( memcmp( expected, result, ( na + nb ) * sizeof( BigLimb_t ) ) != 0 ) {
+		fprintf( stderr, "vBigMul() differs from schoolbook for %zu x %zu limbs\n", na, nb );
+		exit( 1 );
+	}
+}
+
+/* Multiplies per second of fn on two n limb operands, repeated for at least
+ * MIN_TIME_NS. */
+static double rate( int karatsuba, const BigLimb_t * a, const BigLimb_t * b, size_t n,
+                    BigLimb_t * result, BigLimb_t * scratch )
+{
+	uint64_t start = now_ns(), elapsed;
+	unsigned long count = 0;
+
+	do {
+		if ( karatsuba )
+			vBigMul( a, n, b, n, result, scratch );
+		else
+			vBigMulSchoolbook( a, n, b, n, result );
+		count++;
+		elapsed = now_ns() - start;
+	} while ( elapsed < MIN_TIME_NS );
+
+	sink += ( int64_t ) result[ n ];
+	return count / ( elapsed / 1e9 );
+}
+
+static void bench_checked64( void )
+{
+	static volatile int64_t operands[ 2 ] = { 519195165119LL, 784816654984LL };
+	unsigned long overflows = 0, count = 0;
+	uint64_t start = now_ns(), elapsed;
+	int64_t product;
+
+	do {
+		for ( int i = 0; i < 1000; i++ )
+			overflows += iBigMulChecked64( operands[ 0 ], operands[ 1 ] >> ( i & 31 ), &product );
+		count += 1000;
+		elapsed = now_ns() - start;
+	} while ( elapsed < MIN_TIME_NS );
+
+	sink += product;
+	fprintf( stderr, "checked 64 bit multiply: %.1f M/s, %lu of %lu overflowed\n",
+	         count / ( elapsed / 1e3 ), overflows, count );
+}
+
+int main( int argc, char * argv[] )
+{
+	size_t max_limbs = argc > 1 ? strtoul( argv[ 1 ], NULL, 0 ) : DEFAULT_MAX_LIMBS;
+	size_t scratch_limbs = xBigMulScratchLimbs( max_limbs, max_limbs );
+	BigLimb_t * a, * b, * expected, * result, * scratch;
+	uint64_t seed = 88172645463325252ULL;
+
+	if ( max_limbs == 0 ) {
+		fprintf( stderr, "usage: %s [largest size in limbs]\n", argv[ 0 ] );
+		return 1;
+	}
+
+	a = malloc( max_limbs * sizeof( BigLimb_t ) );
+	b = malloc( max_limbs * sizeof( BigLimb_t ) );
+	expected = malloc( 2 * max_limbs * sizeof( BigLimb_t ) );
+	result = malloc( 2 * max_limbs * sizeof( BigLimb_t ) );
+	scratch = malloc( ( scratch_limbs ? scratch_limbs : 1 ) * sizeof( BigLimb_t ) );
+
+	if ( a == NULL || b == NULL || expected == NULL || result == NULL || scratch == NULL ) {
+		fprintf( stderr, "not enough memory for %zu limbs\n", max_limbs );
+		return 1;
+	}
+
+	fprintf( stderr, "%d bit limbs, Karatsuba from %d limbs\n", bigLIMB_BITS, bigKARATSUBA_THRESHOLD );
+	bench_checked64();
+
+	/* Unbalanced and odd sizes exercise the slicing in vBigMul(). */
+	static const size_t pairs[][ 2 ] = { { 1000, 300 }, { 300, 1000 }, { 257, 129 }, { 97, 96 }, { 4095, 33 } };
+	for ( size_t p = 0; p < sizeof( pairs ) / sizeof( pairs[ 0 ] ); p++ ) {
+		if ( pairs[ p ][ 0 ] > max_limbs || pairs[ p ][ 1 ] > max_limbs )
+			continue;
+		fill( a, pairs[ p ][ 0 ], &seed );
+		fill( b, pairs[ p ][ 1 ], &seed );
+		check( a, pairs[ p ][ 0 ], b, pairs[ p ][ 1 ], expected, result, scratch );
+	}
+
+	printf( "limbs,bits,schoolbook_per_s,vbigmul_per_s,speedup\n" );
+
+	for ( size_t n = 1; n <= max_limbs; n *= 2 ) {
+		double schoolbook, karatsuba;
+
+		fill( a, n, &seed );
+		fill( b, n, &seed );
+		check( a, n, b, n, expected, result, scratch );
+
+		/* All ones is the worst case for the carries. */
+		memset( a, 0xff, n * sizeof( BigLimb_t ) );
+		check( a, n, a, n, expected, result, scratch );
+		fill( a, n, &seed );
+
+		schoolbook = rate( 0, a, b, n, result, scratch );
+		karatsuba = rate( 1, a, b, n, result, scratch );
+
+		printf( "%zu,%zu,%.0f,%.0f,%.2f\n", n, n * bigLIMB_BITS, schoolbook, karatsuba, karatsuba / schoolbook );
+		fflush( stdout );
+	}
+
+	free( a );
+	free( b );
+	free( expected );
+	free( result );
+	free( scratch );
+	return 0;
+}
@@ -1,32 +1,35 @@
 #include<stdio.h>
 
-int binary_search(int a[],int b){
+/* Recherche dichotomique de b dans les n valeurs triées de a.
+ * Renvoie l'indice de b, ou -1 s'il n'est pas dans le tableau. */
+int binary_search(const int a[],int n,int b){
 
-	int i=a[0];
-	int taille = sizeof(a)/sizeof(a[0])/2; // taille de la liste :2
-	int compteur=1;
+	int debut=0;
+	int fin=n; // on cherche dans [debut, fin[
 
-	while (i!=b){
-		if (i<=a[taille]){
-			i=a[taille];
-			taille = taille + taille/ compteur;
-			compteur++;
+	while (debut<fin){
+		int milieu = debut + (fin-debut)/2;
+
+		if (a[milieu]<b){
+			debut=milieu+1;
+			}
+		else if (a[milieu]>b){
+			fin=milieu;
 			}
-		else {	
-			i=a[taille];
-			taille = taille - taille/compteur;
-			compteur++;
+		else {
+			return milieu;
 			}
 
 	}
-	return i;
+	return -1;
 }
 
 int main(){
 
 	int y[6]={1,5,14,50,89,99},search_n=89;
 
-	if (binary_search(y,search_n) == search_n){
+	// la taille doit être calculée ici : dans binary_search, a n'est qu'un pointeur
+	if (binary_search(y,sizeof(y)/sizeof(y[0]),search_n) >= 0){
 		printf("On a trouvé le nombre !!\n");
 		}
 
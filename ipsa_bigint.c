@@ -0,0 +1,358 @@
+/*
+ * Exact integer multiplication.  See ipsa_bigint.h.
+ */
+
+#include <string.h>
+
+/* Local includes. */
+#include "ipsa_bigint.h"
+
+#if ( bigKARATSUBA_THRESHOLD < 4 )
+    #error bigKARATSUBA_THRESHOLD must be at least 4 for the Karatsuba recursion to shrink
+#endif
+
+/* The largest power of ten that fits in a limb, and its number of zeros, for
+ * converting to decimal one limb's worth of digits at a time. */
+#if ( bigLIMB_BITS == 64 )
+    #define bigDECIMAL_CHUNK           ( 10000000000000000000ULL )
+    #define bigDECIMAL_CHUNK_DIGITS    ( 19 )
+#else
+    #define bigDECIMAL_CHUNK           ( 1000000000UL )
+    #define bigDECIMAL_CHUNK_DIGITS    ( 9 )
+#endif
+
+/*-----------------------------------------------------------*/
+
+/*
+ * pxResult[ 0 .. xA ) = pxA + pxB, with xA >= xB.  Returns the carry out.
+ */
+static BigLimb_t prvAdd( BigLimb_t * pxResult,
+                         const BigLimb_t * pxA,
+                         size_t xA,
+                         const BigLimb_t * pxB,
+                         size_t xB );
+
+/*
+ * pxValue[ 0 .. xValue ) += or -= pxOther[ 0 .. xOther ), with
+ * xValue >= xOther.  Return the carry or borrow out.
+ */
+static BigLimb_t prvAddInPlace( BigLimb_t * pxValue,
+                                size_t xValue,
+                                const BigLimb_t * pxOther,
+                                size_t xOther );
+static BigLimb_t prvSubInPlace( BigLimb_t * pxValue,
+                                size_t xValue,
+                                const BigLimb_t * pxOther,
+                                size_t xOther );
+
+/*
+ * pxResult[ 0 .. 2 * xLength ) = pxA * pxB, both xLength limbs long.
+ */
+static void prvKaratsuba( const BigLimb_t * pxA,
+                          const BigLimb_t * pxB,
+                          size_t xLength,
+                          BigLimb_t * pxResult,
+                          BigLimb_t * pxScratch );
+static size_t prvKaratsubaScratchLimbs( size_t xLength );
+
+/*-----------------------------------------------------------*/
+
+int iBigMulChecked64( int64_t llA,
+                      int64_t llB,
+                      int64_t * pllProduct )
+{
+    #if defined( __SIZEOF_INT128__ )
+        __int128 xProduct = ( __int128 ) llA * llB;
+
+        *pllProduct = ( int64_t ) ( uint64_t ) xProduct;
+
+        return ( ( xProduct < INT64_MIN ) || ( xProduct > INT64_MAX ) ) ? 1 : 0;
+    #else
+        return __builtin_mul_overflow( llA, llB, pllProduct ) ? 1 : 0;
+    #endif
+}
+/*-----------------------------------------------------------*/
+
+static BigLimb_t prvAdd( BigLimb_t * pxResult,
+                         const BigLimb_t * pxA,
+                         size_t xA,
+                         const BigLimb_t * pxB,
+                         size_t xB )
+{
+    BigDoubleLimb_t xSum;
+    BigLimb_t xCarry = 0;
+    size_t x;
+
+    for( x = 0; x < xA; x++ )
+    {
+        xSum = ( BigDoubleLimb_t ) pxA[ x ] + ( ( x < xB ) ? pxB[ x ] : 0 ) + xCarry;
+        pxResult[ x ] = ( BigLimb_t ) xSum;
+        xCarry = ( BigLimb_t ) ( xSum >> bigLIMB_BITS );
+    }
+
+    return xCarry;
+}
+/*-----------------------------------------------------------*/
+
+static BigLimb_t prvAddInPlace( BigLimb_t * pxValue,
+                                size_t xValue,
+                                const BigLimb_t * pxOther,
+                                size_t xOther )
+{
+    BigDoubleLimb_t xSum;
+    BigLimb_t xCarry = 0;
+    size_t x;
+
+    for( x = 0; ( x < xValue ) && ( ( x < xOther ) || ( xCarry != 0 ) ); x++ )
+    {
+        xSum = ( BigDoubleLimb_t ) pxValue[ x ] + ( ( x < xOther ) ? pxOther[ x ] : 0 ) + xCarry;
+        pxValue[ x ] = ( BigLimb_t ) xSum;
+        xCarry = ( BigLimb_t ) ( xSum >> bigLIMB_BITS );
+    }
+
+    return xCarry;
+}
+/*-----------------------------------------------------------*/
+
+static BigLimb_t prvSubInPlace( BigLimb_t * pxValue,
+                                size_t xValue,
+                                const BigLimb_t * pxOther,
+                                size_t xOther )
+{
+    BigLimb_t xOperand, xBorrow = 0, xNext;
+    size_t x;
+
+    for( x = 0; ( x < xValue ) && ( ( x < xOther ) || ( xBorrow != 0 ) ); x++ )
+    {
+        xOperand = ( x < xOther ) ? pxOther[ x ] : 0;
+        xNext = ( pxValue[ x ] < xOperand ) || ( ( pxValue[ x ] == xOperand ) && ( xBorrow != 0 ) );
+        pxValue[ x ] = pxValue[ x ] - xOperand - xBorrow;
+        xBorrow = xNext;
+    }
+
+    return xBorrow;
+}
+/*-----------------------------------------------------------*/
+
+void vBigMulSchoolbook( const BigLimb_t * pxA,
+                        size_t xA,
+                        const BigLimb_t * pxB,
+                        size_t xB,
+                        BigLimb_t * pxResult )
+{
+    BigDoubleLimb_t xProduct;
+    BigLimb_t xCarry;
+    size_t i, j;
+
+    memset( pxResult, 0, ( xA + xB ) * sizeof( BigLimb_t ) );
+
+    for( i = 0; i < xA; i++ )
+    {
+        xCarry = 0;
+
+        for( j = 0; j < xB; j++ )
+        {
+            /* Cannot overflow: ( 2^n - 1 )^2 + 2 ( 2^n - 1 ) = 2^2n - 1. */
+            xProduct = ( ( BigDoubleLimb_t ) pxA[ i ] * pxB[ j ] ) + pxResult[ i + j ] + xCarry;
+            pxResult[ i + j ] = ( BigLimb_t ) xProduct;
+            xCarry = ( BigLimb_t ) ( xProduct >> bigLIMB_BITS );
+        }
+
+        pxResult[ i + xB ] = xCarry;
+    }
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvKaratsubaScratchLimbs( size_t xLength )
+{
+    size_t xHigh = xLength - ( xLength / 2 );
+
+    if( xLength < bigKARATSUBA_THRESHOLD )
+    {
+        return 0;
+    }
+
+    /* The two half sums, their product, and what the recursion on that
+     * product needs.  The low and high products reuse the same space. */
+    return ( 4 * ( xHigh + 1 ) ) + prvKaratsubaScratchLimbs( xHigh + 1 );
+}
+/*-----------------------------------------------------------*/
+
+static void prvKaratsuba( const BigLimb_t * pxA,
+                          const BigLimb_t * pxB,
+                          size_t xLength,
+                          BigLimb_t * pxResult,
+                          BigLimb_t * pxScratch )
+{
+    size_t xLow = xLength / 2, xHigh = xLength - xLow;
+    BigLimb_t * pxSumA = pxScratch;
+    BigLimb_t * pxSumB = &( pxScratch[ xHigh + 1 ] );
+    BigLimb_t * pxMiddle = &( pxScratch[ 2 * ( xHigh + 1 ) ] );
+    BigLimb_t * pxNext = &( pxScratch[ 4 * ( xHigh + 1 ) ] );
+
+    if( xLength < bigKARATSUBA_THRESHOLD )
+    {
+        vBigMulSchoolbook( pxA, xLength, pxB, xLength, pxResult );
+        return;
+    }
+
+    /* With A = A1 B^m + A0 and B = B1 B^m + B0:
+     *   A B = z2 B^2m + ( z1 - z2 - z0 ) B^m + z0
+     * where z0 = A0 B0, z2 = A1 B1 and z1 = ( A0 + A1 ) ( B0 + B1 ).
+     * z0 and z2 go straight into the two halves of the result. */
+    pxSumA[ xHigh ] = prvAdd( pxSumA, &( pxA[ xLow ] ), xHigh, pxA, xLow );
+    pxSumB[ xHigh ] = prvAdd( pxSumB, &( pxB[ xLow ] ), xHigh, pxB, xLow );
+
+    prvKaratsuba( pxA, pxB, xLow, pxResult, pxNext );
+    prvKaratsuba( &( pxA[ xLow ] ), &( pxB[ xLow ] ), xHigh, &( pxResult[ 2 * xLow ] ), pxNext );
+    prvKaratsuba( pxSumA, pxSumB, xHigh + 1, pxMiddle, pxNext );
+
+    ( void ) prvSubInPlace( pxMiddle, 2 * ( xHigh + 1 ), pxResult, 2 * xLow );
+    ( void ) prvSubInPlace( pxMiddle, 2 * ( xHigh + 1 ), &( pxResult[ 2 * xLow ] ), 2 * xHigh );
+
+    /* The middle term is below B^( 2 xHigh + 1 ), so only its top limb can be
+     * beyond the end of the result when it is zero. */
+    ( void ) prvAddInPlace( &( pxResult[ xLow ] ), xLow + ( 2 * xHigh ), pxMiddle, ( 2 * xHigh ) + 1 );
+}
+/*-----------------------------------------------------------*/
+
+size_t xBigMulScratchLimbs( size_t xA,
+                            size_t xB )
+{
+    size_t xLong = ( xA > xB ) ? xA : xB;
+    size_t xShort = ( xA > xB ) ? xB : xA;
+    size_t xScratch, xTail;
+
+    if( xShort < bigKARATSUBA_THRESHOLD )
+    {
+        return 0;
+    }
+
+    /* A partial product of each xShort limb slice of the long operand, and
+     * the scratch space for computing it. */
+    xScratch = ( 2 * xShort ) + prvKaratsubaScratchLimbs( xShort );
+
+    if( ( xLong % xShort ) != 0 )
+    {
+        xTail = ( 2 * xShort ) + xBigMulScratchLimbs( xShort, xLong % xShort );
+        xScratch = ( xTail > xScratch ) ? xTail : xScratch;
+    }
+
+    return xScratch;
+}
+/*-----------------------------------------------------------*/
+
+void vBigMul( const BigLimb_t * pxA,
+              size_t xA,
+              const BigLimb_t * pxB,
+              size_t xB,
+              BigLimb_t * pxResult,
+              BigLimb_t * pxScratch )
+{
+    const BigLimb_t * pxLong = ( xA >= xB ) ? pxA : pxB;
+    const BigLimb_t * pxShort = ( xA >= xB ) ? pxB : pxA;
+    size_t xLong = ( xA >= xB ) ? xA : xB;
+    size_t xShort = ( xA >= xB ) ? xB : xA;
+    BigLimb_t * pxPartial = pxScratch;
+    size_t xOffset, xSlice;
+
+    if( xShort < bigKARATSUBA_THRESHOLD )
+    {
+        vBigMulSchoolbook( pxLong, xLong, pxShort, xShort, pxResult );
+        return;
+    }
+
+    /* Karatsuba works on operands of equal size, so multiply the short
+     * operand by each slice of the long one that size and add the partial
+     * products in at the slice's offset. */
+    memset( pxResult, 0, ( xLong + xShort ) * sizeof( BigLimb_t ) );
+
+    for( xOffset = 0; xOffset < xLong; xOffset += xShort )
+    {
+        xSlice = ( ( xLong - xOffset ) < xShort ) ? ( xLong - xOffset ) : xShort;
+
+        if( xSlice == xShort )
+        {
+            prvKaratsuba( &( pxLong[ xOffset ] ), pxShort, xShort, pxPartial, &( pxScratch[ 2 * xShort ] ) );
+        }
+        else
+        {
+            vBigMul( pxShort, xShort, &( pxLong[ xOffset ] ), xSlice, pxPartial, &( pxScratch[ 2 * xShort ] ) );
+        }
+
+        ( void ) prvAddInPlace( &( pxResult[ xOffset ] ), xLong + xShort - xOffset, pxPartial, xSlice + xShort );
+    }
+}
+/*-----------------------------------------------------------*/
+
+size_t xBigToDecimal( BigLimb_t * pxLimbs,
+                      size_t xCount,
+                      char * pcBuffer,
+                      size_t xBufferSize )
+{
+    BigDoubleLimb_t xCurrent;
+    BigLimb_t xRemainder;
+    size_t xLength = 0, x;
+    int iDigits;
+    char cDigit;
+
+    while( ( xCount > 0 ) && ( pxLimbs[ xCount - 1 ] == 0 ) )
+    {
+        xCount--;
+    }
+
+    if( xCount == 0 )
+    {
+        if( xBufferSize < 2 )
+        {
+            return 0;
+        }
+
+        pcBuffer[ 0 ] = '0';
+        pcBuffer[ 1 ] = '\0';
+        return 1;
+    }
+
+    /* Divide by the largest power of ten that fits in a limb until nothing is
+     * left, emitting the remainders' digits least significant first. */
+    while( xCount > 0 )
+    {
+        xRemainder = 0;
+
+        for( x = xCount; x > 0; x-- )
+        {
+            xCurrent = ( ( BigDoubleLimb_t ) xRemainder << bigLIMB_BITS ) | pxLimbs[ x - 1 ];
+            pxLimbs[ x - 1 ] = ( BigLimb_t ) ( xCurrent / bigDECIMAL_CHUNK );
+            xRemainder = ( BigLimb_t ) ( xCurrent % bigDECIMAL_CHUNK );
+        }
+
+        while( ( xCount > 0 ) && ( pxLimbs[ xCount - 1 ] == 0 ) )
+        {
+            xCount--;
+        }
+
+        /* Every chunk but the most significant one is padded with zeros. */
+        for( iDigits = 0; ( iDigits < bigDECIMAL_CHUNK_DIGITS ) && ( ( xCount > 0 ) || ( xRemainder != 0 ) ); iDigits++ )
+        {
+            if( ( xLength + 1 ) >= xBufferSize )
+            {
+                return 0;
+            }
+
+            pcBuffer[ xLength++ ] = ( char ) ( '0' + ( xRemainder % 10 ) );
+            xRemainder /= 10;
+        }
+    }
+
+    for( x = 0; x < ( xLength / 2 ); x++ )
+    {
+        cDigit = pcBuffer[ x ];
+        pcBuffer[ x ] = pcBuffer[ xLength - 1 - x ];
+        pcBuffer[ xLength - 1 - x ] = cDigit;
+    }
+
+    pcBuffer[ xLength ] = '\0';
+
+    return xLength;
+}
+/*-----------------------------------------------------------*/
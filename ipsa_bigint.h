@@ -0,0 +1,87 @@
+/*
+ * Exact integer multiplication for the ipsa_sched compute workload.
+ *
+ * iBigMulChecked64() multiplies two 64 bit integers and reports whether the
+ * product fits in 64 bits, using a 128 bit product where the compiler has
+ * __int128.
+ *
+ * Larger values are unsigned multi-limb integers: arrays of BigLimb_t, least
+ * significant limb first.  vBigMul() multiplies them by schoolbook long
+ * multiplication while the shorter operand is below bigKARATSUBA_THRESHOLD
+ * limbs, and with Karatsuba's method, which replaces four half size products
+ * by three, above it.  All memory is supplied by the caller, so nothing here
+ * allocates or calls the kernel.  bigint_bench.c measures both against the
+ * operand size and checks that they agree.
+ */
+
+#ifndef IPSA_BIGINT_H
+#define IPSA_BIGINT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Limbs are as wide as the widest product the compiler can form in one
+ * operation allows. */
+#if defined( __SIZEOF_INT128__ )
+    typedef uint64_t BigLimb_t;
+    typedef unsigned __int128 BigDoubleLimb_t;
+    #define bigLIMB_BITS             ( 64 )
+#else
+    typedef uint32_t BigLimb_t;
+    typedef uint64_t BigDoubleLimb_t;
+    #define bigLIMB_BITS             ( 32 )
+#endif
+
+/* Limbs needed to hold a 64 bit magnitude. */
+#define bigLIMBS_PER_64              ( 64 / bigLIMB_BITS )
+
+/* Operand size, in limbs, from which vBigMul() switches to Karatsuba.  Must
+ * be at least 4; see bigint_bench.c for the crossover on the host. */
+#ifndef bigKARATSUBA_THRESHOLD
+    #define bigKARATSUBA_THRESHOLD   ( 48 )
+#endif
+
+/*
+ * Store llA * llB, truncated to 64 bits, in *pllProduct.  Returns 0 if that is
+ * the exact product and 1 if it overflowed.
+ */
+int iBigMulChecked64( int64_t llA,
+                      int64_t llB,
+                      int64_t * pllProduct );
+
+/*
+ * pxResult[ 0 .. xA + xB ) = pxA[ 0 .. xA ) * pxB[ 0 .. xB ).  pxResult must
+ * not overlap either operand.
+ */
+void vBigMulSchoolbook( const BigLimb_t * pxA,
+                        size_t xA,
+                        const BigLimb_t * pxB,
+                        size_t xB,
+                        BigLimb_t * pxResult );
+
+/*
+ * As vBigMulSchoolbook(), but with Karatsuba's method for operands of
+ * bigKARATSUBA_THRESHOLD limbs or more.  pxScratch must hold
+ * xBigMulScratchLimbs( xA, xB ) limbs.
+ */
+void vBigMul( const BigLimb_t * pxA,
+              size_t xA,
+              const BigLimb_t * pxB,
+              size_t xB,
+              BigLimb_t * pxResult,
+              BigLimb_t * pxScratch );
+
+size_t xBigMulScratchLimbs( size_t xA,
+                            size_t xB );
+
+/*
+ * Write the xCount limb value at pxLimbs to pcBuffer in decimal, NUL
+ * terminated.  The value is destroyed.  Returns the number of digits, or 0 if
+ * xBufferSize is too small.
+ */
+size_t xBigToDecimal( BigLimb_t * pxLimbs,
+                      size_t xCount,
+                      char * pcBuffer,
+                      size_t xBufferSize );
+
+#endif /* IPSA_BIGINT_H */
@@ -0,0 +1,151 @@
+/*
+ * Broadcast channel used by the ipsa_sched demo.  See ipsa_broadcast.h.
+ *
+ * The ring is written by one task at a time (publishers suspend the scheduler
+ * for the few instructions it takes to store the message and advance the write
+ * index) and read without locks: a subscriber copies the slot, then checks
+ * the write index again to make sure the slot was not reused while it was
+ * being read.
+ */
+
+#include <string.h>
+
+/* Kernel includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Local includes. */
+#include "ipsa_broadcast.h"
+
+#define broadcastRING_MASK    ( broadcastRING_LENGTH - 1U )
+
+#if ( ( broadcastRING_LENGTH & broadcastRING_MASK ) != 0 )
+    #error broadcastRING_LENGTH must be a power of two
+#endif
+
+/*-----------------------------------------------------------*/
+
+void vBroadcastInit( Broadcast_t * pxBroadcast )
+{
+    memset( pxBroadcast, 0, sizeof( *pxBroadcast ) );
+}
+/*-----------------------------------------------------------*/
+
+BroadcastSubscriber_t * pxBroadcastSubscribe( Broadcast_t * pxBroadcast,
+                                              TaskHandle_t xTask )
+{
+    BroadcastSubscriber_t * pxSubscriber = NULL;
+
+    if( xTask == NULL )
+    {
+        xTask = xTaskGetCurrentTaskHandle();
+    }
+
+    vTaskSuspendAll();
+    {
+        if( pxBroadcast->uxSubscriberCount < broadcastMAX_SUBSCRIBERS )
+        {
+            pxSubscriber = &( pxBroadcast->xSubscribers[ pxBroadcast->uxSubscriberCount ] );
+            pxSubscriber->xTask = xTask;
+            pxSubscriber->ulReadIndex = pxBroadcast->ulWriteIndex;
+            pxSubscriber->ulDelivered = 0;
+            pxSubscriber->ulDropped = 0;
+            pxSubscriber->ulMaxLag = 0;
+
+            /* Publish the count last so a publisher never notifies a
+             * half-initialised subscriber. */
+            __atomic_store_n( &( pxBroadcast->uxSubscriberCount ), pxBroadcast->uxSubscriberCount + 1, __ATOMIC_RELEASE );
+        }
+    }
+    ( void ) xTaskResumeAll();
+
+    return pxSubscriber;
+}
+/*-----------------------------------------------------------*/
+
+void vBroadcastPublish( Broadcast_t * pxBroadcast,
+                        const IpsaMessage_t * pxMessage )
+{
+    UBaseType_t ux, uxCount;
+    uint32_t ulIndex;
+
+    /* Suspending the scheduler serialises publishers and batches the wake ups:
+     * the subscribers only start running once every one of them has been
+     * notified. */
+    vTaskSuspendAll();
+    {
+        ulIndex = pxBroadcast->ulWriteIndex;
+        pxBroadcast->xRing[ ulIndex & broadcastRING_MASK ] = *pxMessage;
+        __atomic_store_n( &( pxBroadcast->ulWriteIndex ), ulIndex + 1U, __ATOMIC_RELEASE );
+        pxBroadcast->ulPublished++;
+
+        uxCount = __atomic_load_n( &( pxBroadcast->uxSubscriberCount ), __ATOMIC_ACQUIRE );
+
+        for( ux = 0; ux < uxCount; ux++ )
+        {
+            xTaskNotifyGive( pxBroadcast->xSubscribers[ ux ].xTask );
+        }
+    }
+    ( void ) xTaskResumeAll();
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xBroadcastReceive( Broadcast_t * pxBroadcast,
+                              BroadcastSubscriber_t * pxSubscriber,
+                              IpsaMessage_t * pxMessage,
+                              TickType_t xTicksToWait )
+{
+    uint32_t ulWrite, ulRead, ulLag;
+    IpsaMessage_t xMessage;
+
+    for( ; ; )
+    {
+        ulWrite = __atomic_load_n( &( pxBroadcast->ulWriteIndex ), __ATOMIC_ACQUIRE );
+        ulRead = pxSubscriber->ulReadIndex;
+        ulLag = ulWrite - ulRead;
+
+        if( ulLag == 0U )
+        {
+            /* Nothing new.  The notification count is latched by the
+             * publisher, so a value published after the check above still
+             * wakes this task. */
+            if( ulTaskNotifyTake( pdTRUE, xTicksToWait ) == 0U )
+            {
+                return pdFAIL;
+            }
+
+            continue;
+        }
+
+        if( ulLag > pxSubscriber->ulMaxLag )
+        {
+            pxSubscriber->ulMaxLag = ulLag;
+        }
+
+        if( ulLag > broadcastRING_LENGTH )
+        {
+            /* The oldest values have already been overwritten. */
+            pxSubscriber->ulDropped += ulLag - broadcastRING_LENGTH;
+            ulRead = ulWrite - broadcastRING_LENGTH;
+        }
+
+        xMessage = pxBroadcast->xRing[ ulRead & broadcastRING_MASK ];
+
+        /* If the publisher wrapped onto the slot while it was being copied the
+         * copy may be torn, so go round again and count it as dropped. */
+        ulWrite = __atomic_load_n( &( pxBroadcast->ulWriteIndex ), __ATOMIC_ACQUIRE );
+
+        if( ( ulWrite - ulRead ) > broadcastRING_LENGTH )
+        {
+            pxSubscriber->ulReadIndex = ulRead;
+            continue;
+        }
+
+        pxSubscriber->ulReadIndex = ulRead + 1U;
+        pxSubscriber->ulDelivered++;
+        *pxMessage = xMessage;
+
+        return pdPASS;
+    }
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,80 @@
+/*
+ * Single-publish / multi-subscriber broadcast channel for the ipsa_sched demo.
+ *
+ * A message is written once into a shared ring and every subscriber reads it
+ * through its own read index, so publishing does not copy the value per
+ * subscriber.  A subscriber that falls more than broadcastRING_LENGTH values
+ * behind loses the oldest ones; the loss is counted in ulDropped rather than
+ * blocking the publisher.  Subscribers are woken with a direct to task
+ * notification.
+ *
+ * Publishers must be tasks (the timer daemon counts), not interrupts.
+ */
+
+#ifndef IPSA_BROADCAST_H
+#define IPSA_BROADCAST_H
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Local includes. */
+#include "ipsa_message.h"
+
+/* Number of messages held by the shared ring.  Must be a power of two. */
+#ifndef broadcastRING_LENGTH
+    #define broadcastRING_LENGTH       ( 16U )
+#endif
+
+/* Maximum number of tasks that can subscribe to one broadcast channel. */
+#ifndef broadcastMAX_SUBSCRIBERS
+    #define broadcastMAX_SUBSCRIBERS   ( 64U )
+#endif
+
+typedef struct BroadcastSubscriber
+{
+    TaskHandle_t xTask;   /* Task notified when a value is published. */
+    uint32_t ulReadIndex; /* Sequence number of the next value to read. */
+    uint32_t ulDelivered; /* Values handed to the subscriber. */
+    uint32_t ulDropped;   /* Values overwritten before they were read. */
+    uint32_t ulMaxLag;    /* Largest backlog seen on a receive. */
+} BroadcastSubscriber_t;
+
+typedef struct Broadcast
+{
+    uint32_t ulWriteIndex; /* Sequence number of the next value to publish. */
+    uint32_t ulPublished;  /* Total values published. */
+    IpsaMessage_t xRing[ broadcastRING_LENGTH ];
+    UBaseType_t uxSubscriberCount;
+    BroadcastSubscriber_t xSubscribers[ broadcastMAX_SUBSCRIBERS ];
+} Broadcast_t;
+
+/*
+ * Reset the channel.  Must be called before any task subscribes or publishes.
+ */
+void vBroadcastInit( Broadcast_t * pxBroadcast );
+
+/*
+ * Register xTask (or the calling task if xTask is NULL) as a subscriber.
+ * Only values published after this call are delivered.  Returns NULL when
+ * broadcastMAX_SUBSCRIBERS is reached.
+ */
+BroadcastSubscriber_t * pxBroadcastSubscribe( Broadcast_t * pxBroadcast,
+                                              TaskHandle_t xTask );
+
+/*
+ * Publish one message to every subscriber.  Never blocks.
+ */
+void vBroadcastPublish( Broadcast_t * pxBroadcast,
+                        const IpsaMessage_t * pxMessage );
+
+/*
+ * Wait up to xTicksToWait for the next message for pxSubscriber.  Returns
+ * pdPASS and copies the message to pxMessage, or pdFAIL on timeout.  Must be
+ * called by the subscribing task.
+ */
+BaseType_t xBroadcastReceive( Broadcast_t * pxBroadcast,
+                              BroadcastSubscriber_t * pxSubscriber,
+                              IpsaMessage_t * pxMessage,
+                              TickType_t xTicksToWait );
+
+#endif /* IPSA_BROADCAST_H */
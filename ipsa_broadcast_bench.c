@@ -0,0 +1,162 @@
+/*
+ * Fan-out benchmark for the broadcast channel in ipsa_broadcast.c.
+ *
+ * ipsa_broadcast_bench() is called from main() in place of ipsa_sched().  For
+ * each subscriber count in xSubscriberCounts[] it starts one publisher task
+ * and that many subscriber tasks, lets them run for benchRUN_TIME_MS, then
+ * prints the number of values delivered per second (summed over every
+ * subscriber) together with the drop and worst lag figures.
+ *
+ * The publisher runs below the subscribers, so each publish wakes every
+ * subscriber before the next value is written - the figure measured is the
+ * cost of one complete fan-out.
+ */
+
+#include <stdio.h>
+
+/* Kernel includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Local includes. */
+#include "console.h"
+#include "ipsa_broadcast.h"
+
+#define benchCONTROL_TASK_PRIORITY       ( tskIDLE_PRIORITY + 3 )
+#define benchSUBSCRIBER_TASK_PRIORITY    ( tskIDLE_PRIORITY + 2 )
+#define benchPUBLISHER_TASK_PRIORITY     ( tskIDLE_PRIORITY + 1 )
+
+#define benchRUN_TIME_MS                 pdMS_TO_TICKS( 2000UL )
+
+/*-----------------------------------------------------------*/
+
+static void prvControlTask( void * pvParameters );
+static void prvPublisherTask( void * pvParameters );
+static void prvSubscriberTask( void * pvParameters );
+
+/*-----------------------------------------------------------*/
+
+static const UBaseType_t xSubscriberCounts[] = { 4, 8, 16, 32, 64 };
+
+static Broadcast_t xBroadcast;
+
+/*-----------------------------------------------------------*/
+
+void ipsa_broadcast_bench( void )
+{
+    xTaskCreate( prvControlTask, "Bench", configMINIMAL_STACK_SIZE * 2, NULL, benchCONTROL_TASK_PRIORITY, NULL );
+
+    vTaskStartScheduler();
+
+    /* Only reached if there was not enough heap for the idle task. */
+    for( ; ; )
+    {
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvControlTask( void * pvParameters )
+{
+    static TaskHandle_t xSubscribers[ broadcastMAX_SUBSCRIBERS ];
+    BroadcastSubscriber_t * pxSubscriber;
+    TaskHandle_t xPublisher;
+    UBaseType_t uxRun, uxCount, ux;
+    uint32_t ulDelivered, ulDropped, ulMaxLag;
+
+    ( void ) pvParameters;
+
+    console_print( "subscribers,published,delivered,delivered_per_s,dropped,max_lag\n" );
+
+    for( uxRun = 0; uxRun < sizeof( xSubscriberCounts ) / sizeof( xSubscriberCounts[ 0 ] ); uxRun++ )
+    {
+        uxCount = xSubscriberCounts[ uxRun ];
+        vBroadcastInit( &xBroadcast );
+
+        for( ux = 0; ux < uxCount; ux++ )
+        {
+            xSubscribers[ ux ] = NULL;
+
+            /* Subscriptions are handed out in order, so the task's slot is
+             * known before it is created.  Subscribing on behalf of the task
+             * (it cannot run until this task blocks) means it cannot miss the
+             * first values published. */
+            if( xTaskCreate( prvSubscriberTask, "Sub", configMINIMAL_STACK_SIZE, &( xBroadcast.xSubscribers[ ux ] ), benchSUBSCRIBER_TASK_PRIORITY, &( xSubscribers[ ux ] ) ) == pdPASS )
+            {
+                pxSubscriber = pxBroadcastSubscribe( &xBroadcast, xSubscribers[ ux ] );
+                configASSERT( pxSubscriber == &( xBroadcast.xSubscribers[ ux ] ) );
+                ( void ) pxSubscriber;
+            }
+        }
+
+        xTaskCreate( prvPublisherTask, "Pub", configMINIMAL_STACK_SIZE, NULL, benchPUBLISHER_TASK_PRIORITY, &xPublisher );
+
+        vTaskDelay( benchRUN_TIME_MS );
+
+        /* Stop everything before reading the counters so they are stable. */
+        vTaskDelete( xPublisher );
+
+        ulDelivered = 0;
+        ulDropped = 0;
+        ulMaxLag = 0;
+
+        for( ux = 0; ux < xBroadcast.uxSubscriberCount; ux++ )
+        {
+            ulDelivered += xBroadcast.xSubscribers[ ux ].ulDelivered;
+            ulDropped += xBroadcast.xSubscribers[ ux ].ulDropped;
+
+            if( xBroadcast.xSubscribers[ ux ].ulMaxLag > ulMaxLag )
+            {
+                ulMaxLag = xBroadcast.xSubscribers[ ux ].ulMaxLag;
+            }
+        }
+
+        for( ux = 0; ux < uxCount; ux++ )
+        {
+            if( xSubscribers[ ux ] != NULL )
+            {
+                vTaskDelete( xSubscribers[ ux ] );
+            }
+        }
+
+        console_print( "%lu,%lu,%lu,%lu,%lu,%lu\n",
+                       ( unsigned long ) uxCount,
+                       ( unsigned long ) xBroadcast.ulPublished,
+                       ( unsigned long ) ulDelivered,
+                       ( unsigned long ) ( ( ( uint64_t ) ulDelivered * configTICK_RATE_HZ ) / benchRUN_TIME_MS ),
+                       ( unsigned long ) ulDropped,
+                       ( unsigned long ) ulMaxLag );
+
+        /* Give the idle task a chance to free the deleted tasks. */
+        vTaskDelay( pdMS_TO_TICKS( 100UL ) );
+    }
+
+    console_print( "Broadcast benchmark done\n" );
+    vTaskDelete( NULL );
+}
+/*-----------------------------------------------------------*/
+
+static void prvPublisherTask( void * pvParameters )
+{
+    IpsaMessage_t xMessage = { 0 };
+
+    ( void ) pvParameters;
+
+    for( ; ; )
+    {
+        vBroadcastPublish( &xBroadcast, &xMessage );
+        xMessage.ulValue++;
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvSubscriberTask( void * pvParameters )
+{
+    BroadcastSubscriber_t * pxSubscriber = ( BroadcastSubscriber_t * ) pvParameters;
+    IpsaMessage_t xMessage;
+
+    for( ; ; )
+    {
+        ( void ) xBroadcastReceive( &xBroadcast, pxSubscriber, &xMessage, portMAX_DELAY );
+    }
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,126 @@
+/*
+ * Two lane priority message bus.  See ipsa_bus.h.
+ *
+ * There are never fewer messages in the lanes than the semaphore count plus
+ * the receivers that have taken it and not yet taken their message, since a
+ * message is queued before the semaphore is given and dequeued after it is
+ * taken.  A receiver that took the semaphore can still find a lane empty that
+ * it just looked at, if another receiver got there first, but its message is
+ * then in a lane it has not looked at yet, so it scans the lanes again until
+ * it has one.
+ */
+
+#include <string.h>
+
+/* Kernel includes. */
+#include "FreeRTOS.h"
+#include "queue.h"
+#include "semphr.h"
+
+/* Local includes. */
+#include "ipsa_bus.h"
+
+/*-----------------------------------------------------------*/
+
+void vBusInit( Bus_t * pxBus,
+               QueueHandle_t xUrgent,
+               QueueHandle_t xNormal,
+               QueueHandle_t xPending )
+{
+    memset( pxBus, 0, sizeof( *pxBus ) );
+    pxBus->xLanes[ eBusUrgent ] = xUrgent;
+    pxBus->xLanes[ eBusNormal ] = xNormal;
+    pxBus->xPending = xPending;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xBusCreate( Bus_t * pxBus,
+                       UBaseType_t uxUrgentLength,
+                       UBaseType_t uxNormalLength )
+{
+    QueueHandle_t xUrgent = xQueueCreate( uxUrgentLength, sizeof( IpsaMessage_t ) );
+    QueueHandle_t xNormal = xQueueCreate( uxNormalLength, sizeof( IpsaMessage_t ) );
+    QueueHandle_t xPending = xSemaphoreCreateCounting( uxUrgentLength + uxNormalLength, 0 );
+
+    vBusInit( pxBus, xUrgent, xNormal, xPending );
+
+    if( ( xUrgent == NULL ) || ( xNormal == NULL ) || ( xPending == NULL ) )
+    {
+        vBusDelete( pxBus );
+        return pdFAIL;
+    }
+
+    return pdPASS;
+}
+/*-----------------------------------------------------------*/
+
+void vBusDelete( Bus_t * pxBus )
+{
+    BaseType_t xLane;
+
+    for( xLane = 0; xLane < eBusLaneCount; xLane++ )
+    {
+        if( pxBus->xLanes[ xLane ] != NULL )
+        {
+            vQueueDelete( pxBus->xLanes[ xLane ] );
+            pxBus->xLanes[ xLane ] = NULL;
+        }
+    }
+
+    if( pxBus->xPending != NULL )
+    {
+        vSemaphoreDelete( pxBus->xPending );
+        pxBus->xPending = NULL;
+    }
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xBusSend( Bus_t * pxBus,
+                     BusLane_t eLane,
+                     const IpsaMessage_t * pxMessage,
+                     TickType_t xTicksToWait )
+{
+    if( xQueueSend( pxBus->xLanes[ eLane ], pxMessage, xTicksToWait ) != pdPASS )
+    {
+        ( void ) __atomic_fetch_add( &( pxBus->ulDropped[ eLane ] ), 1U, __ATOMIC_RELAXED );
+
+        return pdFAIL;
+    }
+
+    /* Cannot fail: the count never exceeds the messages in the lanes. */
+    ( void ) xSemaphoreGive( pxBus->xPending );
+    ( void ) __atomic_fetch_add( &( pxBus->ulSent[ eLane ] ), 1U, __ATOMIC_RELAXED );
+
+    return pdPASS;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xBusReceive( Bus_t * pxBus,
+                        IpsaMessage_t * pxMessage,
+                        BusLane_t * peLane,
+                        TickType_t xTicksToWait )
+{
+    BaseType_t xLane;
+
+    if( xSemaphoreTake( pxBus->xPending, xTicksToWait ) != pdPASS )
+    {
+        return pdFAIL;
+    }
+
+    for( ; ; )
+    {
+        for( xLane = 0; xLane < eBusLaneCount; xLane++ )
+        {
+            if( xQueueReceive( pxBus->xLanes[ xLane ], pxMessage, 0U ) == pdPASS )
+            {
+                if( peLane != NULL )
+                {
+                    *peLane = ( BusLane_t ) xLane;
+                }
+
+                return pdPASS;
+            }
+        }
+    }
+}
+/*-----------------------------------------------------------*/
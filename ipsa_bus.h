@@ -0,0 +1,90 @@
+/*
+ * Two lane priority message bus for the ipsa_sched demo.
+ *
+ * A single FIFO queue serves messages in the order they were sent, so an
+ * urgent message waits behind every normal one already queued, and is
+ * dropped if normal traffic has filled the queue.  The bus keeps one queue
+ * per lane, each with its own capacity, so normal traffic can only ever fill
+ * the normal lane, and a receive always takes from the urgent lane first.
+ * Messages within a lane stay in FIFO order.
+ *
+ * Receivers block on one counting semaphore that is given once for every
+ * message sent to any lane, so a task waits on the whole bus at once and any
+ * number of tasks can receive from it.  A sender fills the lane before it
+ * gives the semaphore, so a receiver that takes the semaphore always finds a
+ * message in one of the lanes.
+ *
+ * Senders must be tasks (the timer daemon counts), not interrupts.
+ */
+
+#ifndef IPSA_BUS_H
+#define IPSA_BUS_H
+
+#include "FreeRTOS.h"
+#include "queue.h"
+
+/* Local includes. */
+#include "ipsa_message.h"
+
+typedef enum
+{
+    eBusUrgent = 0, /* Served first. */
+    eBusNormal,
+    eBusLaneCount
+} BusLane_t;
+
+typedef struct Bus
+{
+    QueueHandle_t xLanes[ eBusLaneCount ];
+    QueueHandle_t xPending;                   /* Counting semaphore: messages in all lanes. */
+    uint32_t ulSent[ eBusLaneCount ];         /* Messages accepted by each lane. */
+    uint32_t ulDropped[ eBusLaneCount ];      /* Messages that found their lane full. */
+} Bus_t;
+
+/*
+ * Set up a bus over kernel objects created by the caller: a queue of
+ * IpsaMessage_t per lane, with the capacity wanted for that lane, and
+ * xPending, a counting semaphore - a queue with an item size of 0 - that
+ * can count at least the total capacity of the lanes and starts at 0.  This
+ * lets the caller create them statically.
+ */
+void vBusInit( Bus_t * pxBus,
+               QueueHandle_t xUrgent,
+               QueueHandle_t xNormal,
+               QueueHandle_t xPending );
+
+/*
+ * Create the kernel objects for a bus with the given lane capacities from
+ * the heap and set it up.  Returns pdFAIL if there is not enough heap.
+ */
+BaseType_t xBusCreate( Bus_t * pxBus,
+                       UBaseType_t uxUrgentLength,
+                       UBaseType_t uxNormalLength );
+
+/*
+ * Delete the kernel objects of a bus made with xBusCreate().
+ */
+void vBusDelete( Bus_t * pxBus );
+
+/*
+ * Send a message to one lane, waiting up to xTicksToWait for space in that
+ * lane.  Returns pdPASS, or pdFAIL if the lane stayed full, in which case
+ * the message is counted in ulDropped.
+ */
+BaseType_t xBusSend( Bus_t * pxBus,
+                     BusLane_t eLane,
+                     const IpsaMessage_t * pxMessage,
+                     TickType_t xTicksToWait );
+
+/*
+ * Wait up to xTicksToWait for a message on any lane.  Returns pdPASS and
+ * copies the oldest message of the most urgent lane that has one to
+ * pxMessage, and its lane to *peLane if peLane is not NULL.  Returns pdFAIL
+ * on timeout.
+ */
+BaseType_t xBusReceive( Bus_t * pxBus,
+                        IpsaMessage_t * pxMessage,
+                        BusLane_t * peLane,
+                        TickType_t xTicksToWait );
+
+#endif /* IPSA_BUS_H */
@@ -0,0 +1,210 @@
+/*
+ * Benchmark of the urgent lane of the priority bus in ipsa_bus.c against a
+ * single FIFO queue, with the normal traffic saturating the consumer.
+ *
+ * ipsa_bus_bench() is called from main() in place of ipsa_sched().  Three
+ * tasks share a bus:
+ *   Flood    - sends normal messages as fast as the normal lane takes them,
+ *              blocking while it is full, at a priority above the consumer
+ *              so the lane is refilled as soon as a message is taken;
+ *   Urgent   - sends an urgent message every benchURGENT_PERIOD, without
+ *              blocking, as prvQueueSendTimerCallback() does;
+ *   Consumer - receives, and spins for benchWORK_US per message, so it
+ *              cannot keep up with the flood.
+ * In "fifo" mode the urgent messages are sent on the normal lane, which is
+ * then exactly one shared queue; in "bus" mode they have their own lane.
+ * The latency of an urgent message is from just before it is sent to when
+ * the consumer takes it.  One CSV line is printed per mode.  In fifo mode
+ * most urgent messages find the queue full and are dropped, and those that
+ * get through wait behind a whole queue of normal work.
+ */
+
+#include <stdio.h>
+
+/* Kernel includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+
+/* Local includes. */
+#include "console.h"
+#include "ipsa_bus.h"
+#include "ipsa_clock.h"
+#include "ipsa_hist.h"
+
+#define benchCONTROL_TASK_PRIORITY     ( configMAX_PRIORITIES - 1 )
+#define benchURGENT_TASK_PRIORITY      ( tskIDLE_PRIORITY + 3 )
+#define benchFLOOD_TASK_PRIORITY       ( tskIDLE_PRIORITY + 2 )
+#define benchCONSUMER_TASK_PRIORITY    ( tskIDLE_PRIORITY + 1 )
+
+#define benchRUN_TIME_MS               pdMS_TO_TICKS( 5000UL )
+#define benchURGENT_PERIOD             pdMS_TO_TICKS( 5UL )
+#define benchURGENT_LENGTH             ( 4 )
+#define benchNORMAL_LENGTH             ( 32 )
+#define benchWORK_US                   ( 20ULL )
+
+#define benchVALUE_NORMAL              ( 0UL )
+#define benchVALUE_URGENT              ( 1UL )
+
+/*-----------------------------------------------------------*/
+
+static void prvControlTask( void * pvParameters );
+static void prvFloodTask( void * pvParameters );
+static void prvUrgentTask( void * pvParameters );
+static void prvConsumerTask( void * pvParameters );
+
+/*-----------------------------------------------------------*/
+
+static Bus_t xBus;
+
+/* The lane the urgent messages are sent on in the current mode. */
+static BusLane_t eUrgentLane;
+
+static Histogram_t xUrgentLatency;
+static uint32_t ulUrgentSent;
+static uint32_t ulUrgentDropped;
+static uint32_t ulNormalReceived;
+
+/*-----------------------------------------------------------*/
+
+void ipsa_bus_bench( void )
+{
+    xTaskCreate( prvControlTask, "Bench", configMINIMAL_STACK_SIZE * 2, NULL, benchCONTROL_TASK_PRIORITY, NULL );
+
+    vTaskStartScheduler();
+
+    /* Only reached if there was not enough heap for the idle task. */
+    for( ; ; )
+    {
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvControlTask( void * pvParameters )
+{
+    static const char * const pcModeNames[] = { "fifo", "bus" };
+    TaskHandle_t xTasks[ 3 ];
+    BaseType_t xMode;
+    size_t x;
+
+    ( void ) pvParameters;
+
+    console_print( "mode,urgent_sent,urgent_dropped,normal_received,urgent_p50_us,urgent_p99_us,urgent_max_us\n" );
+
+    for( xMode = 0; xMode < 2; xMode++ )
+    {
+        if( xBusCreate( &xBus, benchURGENT_LENGTH, benchNORMAL_LENGTH ) == pdFAIL )
+        {
+            console_print( "%s: not enough heap\n", pcModeNames[ xMode ] );
+            continue;
+        }
+
+        eUrgentLane = ( xMode == 0 ) ? eBusNormal : eBusUrgent;
+        vHistogramReset( &xUrgentLatency );
+        ulUrgentSent = 0;
+        ulUrgentDropped = 0;
+        ulNormalReceived = 0;
+
+        xTaskCreate( prvConsumerTask, "Consumer", configMINIMAL_STACK_SIZE, NULL, benchCONSUMER_TASK_PRIORITY, &( xTasks[ 0 ] ) );
+        xTaskCreate( prvFloodTask, "Flood", configMINIMAL_STACK_SIZE, NULL, benchFLOOD_TASK_PRIORITY, &( xTasks[ 1 ] ) );
+        xTaskCreate( prvUrgentTask, "Urgent", configMINIMAL_STACK_SIZE, NULL, benchURGENT_TASK_PRIORITY, &( xTasks[ 2 ] ) );
+
+        vTaskDelay( benchRUN_TIME_MS );
+
+        /* Stop all three before reading the counters so they are stable. */
+        for( x = 0; x < 3; x++ )
+        {
+            vTaskDelete( xTasks[ x ] );
+        }
+
+        console_print( "%s,%lu,%lu,%lu,%.1f,%.1f,%.1f\n",
+                       pcModeNames[ xMode ],
+                       ( unsigned long ) ulUrgentSent,
+                       ( unsigned long ) ulUrgentDropped,
+                       ( unsigned long ) ulNormalReceived,
+                       ullHistogramPercentile( &xUrgentLatency, 50.0 ) / 1000.0,
+                       ullHistogramPercentile( &xUrgentLatency, 99.0 ) / 1000.0,
+                       xUrgentLatency.ullMax / 1000.0 );
+
+        vBusDelete( &xBus );
+
+        /* Give the idle task a chance to free the deleted tasks. */
+        vTaskDelay( pdMS_TO_TICKS( 100UL ) );
+    }
+
+    console_print( "Bus benchmark done\n" );
+    vTaskDelete( NULL );
+}
+/*-----------------------------------------------------------*/
+
+static void prvFloodTask( void * pvParameters )
+{
+    IpsaMessage_t xMessage;
+
+    ( void ) pvParameters;
+
+    xMessage.ulValue = benchVALUE_NORMAL;
+
+    for( ; ; )
+    {
+        xMessage.ullReleaseNs = ullIpsaClockNs();
+        ( void ) xBusSend( &xBus, eBusNormal, &xMessage, portMAX_DELAY );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvUrgentTask( void * pvParameters )
+{
+    TickType_t xLastRelease = xTaskGetTickCount();
+    IpsaMessage_t xMessage;
+
+    ( void ) pvParameters;
+
+    xMessage.ulValue = benchVALUE_URGENT;
+
+    for( ; ; )
+    {
+        vTaskDelayUntil( &xLastRelease, benchURGENT_PERIOD );
+
+        xMessage.ullReleaseNs = ullIpsaClockNs();
+
+        if( xBusSend( &xBus, eUrgentLane, &xMessage, 0U ) == pdPASS )
+        {
+            ulUrgentSent++;
+        }
+        else
+        {
+            ulUrgentDropped++;
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvConsumerTask( void * pvParameters )
+{
+    IpsaMessage_t xMessage;
+    uint64_t ullWorkEndNs;
+
+    ( void ) pvParameters;
+
+    for( ; ; )
+    {
+        ( void ) xBusReceive( &xBus, &xMessage, NULL, portMAX_DELAY );
+
+        if( xMessage.ulValue == benchVALUE_URGENT )
+        {
+            vHistogramRecord( &xUrgentLatency, ullIpsaClockNs() - xMessage.ullReleaseNs );
+        }
+        else
+        {
+            ulNormalReceived++;
+        }
+
+        ullWorkEndNs = ullIpsaClockNs() + ( benchWORK_US * 1000ULL );
+
+        while( ullIpsaClockNs() < ullWorkEndNs )
+        {
+        }
+    }
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,42 @@
+/*
+ * High resolution monotonic clock for the ipsa_sched instrumentation.
+ *
+ * On the Linux port clock_gettime( CLOCK_MONOTONIC ) is served by the vDSO, so
+ * reading it from a task does not make a system call and does not disturb the
+ * port the way console output does.  The tick count is far too coarse (1 ms)
+ * to measure task latencies.
+ */
+
+#ifndef IPSA_CLOCK_H
+#define IPSA_CLOCK_H
+
+#include <stdint.h>
+#include <time.h>
+
+static inline uint64_t ullIpsaClockNs( void )
+{
+    struct timespec xNow;
+
+    clock_gettime( CLOCK_MONOTONIC, &xNow );
+
+    return ( ( uint64_t ) xNow.tv_sec * 1000000000ULL ) + ( uint64_t ) xNow.tv_nsec;
+}
+
+/*
+ * The run time stats counter, in microseconds.  It wraps after about 71
+ * minutes, which the kernel and the stats task handle by only ever using
+ * differences.  To use it, add
+ *
+ *     #define configGENERATE_RUN_TIME_STATS            1
+ *     #define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()
+ *     #define portGET_RUN_TIME_COUNTER_VALUE()         ulIpsaRunTimeCounter()
+ *     #include "ipsa_clock.h"
+ *
+ * to FreeRTOSConfig.h in place of the demo's own run time counter.
+ */
+static inline uint32_t ulIpsaRunTimeCounter( void )
+{
+    return ( uint32_t ) ( ullIpsaClockNs() / 1000ULL );
+}
+
+#endif /* IPSA_CLOCK_H */
@@ -0,0 +1,136 @@
+/*
+ * Log-linear latency histogram.  See ipsa_hist.h.
+ */
+
+#include <string.h>
+
+/* Local includes. */
+#include "ipsa_hist.h"
+
+/*-----------------------------------------------------------*/
+
+static uint32_t prvBucketIndex( uint64_t ullValue )
+{
+    uint32_t ulExponent, ulIndex;
+
+    if( ullValue < histSUB_BUCKETS )
+    {
+        return ( uint32_t ) ullValue;
+    }
+
+    ulExponent = 63U - ( uint32_t ) __builtin_clzll( ullValue );
+
+    if( ulExponent >= histMAX_VALUE_BITS )
+    {
+        return histBUCKETS - 1U;
+    }
+
+    /* The top histSUB_BUCKET_BITS + 1 bits of the value select the bucket:
+     * the leading one gives the power of two range, the rest the position
+     * within it. */
+    ulIndex = ( ulExponent - histSUB_BUCKET_BITS + 1U ) * histSUB_BUCKETS;
+    ulIndex += ( uint32_t ) ( ullValue >> ( ulExponent - histSUB_BUCKET_BITS ) ) & ( histSUB_BUCKETS - 1U );
+
+    return ulIndex;
+}
+/*-----------------------------------------------------------*/
+
+static uint64_t prvBucketUpperBound( uint32_t ulIndex )
+{
+    uint32_t ulRange, ulSub, ulShift;
+
+    if( ulIndex < histSUB_BUCKETS )
+    {
+        return ulIndex;
+    }
+
+    ulRange = ulIndex / histSUB_BUCKETS;
+    ulSub = ulIndex % histSUB_BUCKETS;
+    ulShift = ulRange - 1U;
+
+    return ( ( ( uint64_t ) histSUB_BUCKETS + ulSub + 1U ) << ulShift ) - 1U;
+}
+/*-----------------------------------------------------------*/
+
+void vHistogramReset( Histogram_t * pxHistogram )
+{
+    memset( pxHistogram, 0, sizeof( *pxHistogram ) );
+    pxHistogram->ullMin = UINT64_MAX;
+}
+/*-----------------------------------------------------------*/
+
+void vHistogramRecord( Histogram_t * pxHistogram,
+                       uint64_t ullValue )
+{
+    pxHistogram->ulBuckets[ prvBucketIndex( ullValue ) ]++;
+    pxHistogram->ullCount++;
+
+    if( ullValue > pxHistogram->ullMax )
+    {
+        pxHistogram->ullMax = ullValue;
+    }
+
+    if( ullValue < pxHistogram->ullMin )
+    {
+        pxHistogram->ullMin = ullValue;
+    }
+}
+/*-----------------------------------------------------------*/
+
+void vHistogramMerge( Histogram_t * pxInto,
+                      const Histogram_t * pxFrom )
+{
+    uint32_t ul;
+
+    for( ul = 0; ul < histBUCKETS; ul++ )
+    {
+        pxInto->ulBuckets[ ul ] += pxFrom->ulBuckets[ ul ];
+    }
+
+    pxInto->ullCount += pxFrom->ullCount;
+
+    if( pxFrom->ullMax > pxInto->ullMax )
+    {
+        pxInto->ullMax = pxFrom->ullMax;
+    }
+
+    if( pxFrom->ullMin < pxInto->ullMin )
+    {
+        pxInto->ullMin = pxFrom->ullMin;
+    }
+}
+/*-----------------------------------------------------------*/
+
+uint64_t ullHistogramPercentile( const Histogram_t * pxHistogram,
+                                 double dPercentile )
+{
+    uint64_t ullRank, ullSeen = 0, ullBound;
+    uint32_t ul;
+
+    if( pxHistogram->ullCount == 0 )
+    {
+        return 0;
+    }
+
+    /* The rank of the value wanted, counting from 1. */
+    ullRank = ( uint64_t ) ( ( dPercentile / 100.0 ) * ( double ) pxHistogram->ullCount + 0.999999 );
+
+    if( ullRank == 0 )
+    {
+        ullRank = 1;
+    }
+
+    for( ul = 0; ul < histBUCKETS; ul++ )
+    {
+        ullSeen += pxHistogram->ulBuckets[ ul ];
+
+        if( ullSeen >= ullRank )
+        {
+            ullBound = prvBucketUpperBound( ul );
+            return ( ullBound < pxHistogram->ullMax ) ? ullBound : pxHistogram->ullMax;
+        }
+    }
+
+    return pxHistogram->ullMax;
+}
+/*-----------------------------------------------------------*/
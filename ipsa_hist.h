@@ -0,0 +1,53 @@
+/*
+ * Fixed size log-linear latency histogram.
+ *
+ * Values below 2^histSUB_BUCKET_BITS are counted exactly.  Above that each
+ * power of two range is split into 2^histSUB_BUCKET_BITS equal buckets, so a
+ * reported percentile is within 1 / 2^histSUB_BUCKET_BITS (about 3%) of the
+ * true value, for any value up to 2^histMAX_VALUE_BITS.  Recording is a few
+ * instructions and never allocates.  Larger values are counted in the top
+ * bucket, and the exact maximum is kept separately.
+ *
+ * A histogram must only be written by one task at a time.  It has no kernel
+ * dependency so it can also be used by the host benchmarks.
+ */
+
+#ifndef IPSA_HIST_H
+#define IPSA_HIST_H
+
+#include <stdint.h>
+
+#define histSUB_BUCKET_BITS    ( 5 )
+#define histMAX_VALUE_BITS     ( 40 ) /* 2^40 ns is about 18 minutes. */
+#define histSUB_BUCKETS        ( 1U << histSUB_BUCKET_BITS )
+#define histBUCKETS            ( ( histMAX_VALUE_BITS - histSUB_BUCKET_BITS + 1 ) * histSUB_BUCKETS )
+
+typedef struct Histogram
+{
+    uint64_t ullCount;
+    uint64_t ullMin;
+    uint64_t ullMax;
+    uint32_t ulBuckets[ histBUCKETS ];
+} Histogram_t;
+
+void vHistogramReset( Histogram_t * pxHistogram );
+
+void vHistogramRecord( Histogram_t * pxHistogram,
+                       uint64_t ullValue );
+
+/*
+ * Add the values recorded in pxFrom to pxInto, for example to combine the
+ * histograms kept by several tasks once they have stopped.
+ */
+void vHistogramMerge( Histogram_t * pxInto,
+                      const Histogram_t * pxFrom );
+
+/*
+ * Return the value below which dPercentile percent (0 to 100) of the
+ * recorded values fall, rounded up to the end of its bucket and capped at the
+ * recorded maximum.  Returns 0 for an empty histogram.
+ */
+uint64_t ullHistogramPercentile( const Histogram_t * pxHistogram,
+                                 double dPercentile );
+
+#endif /* IPSA_HIST_H */
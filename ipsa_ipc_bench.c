@@ -0,0 +1,448 @@
+/*
+ * Benchmark of the kernel primitives that can carry a release from one task
+ * to another: queues, direct to task notifications, binary semaphores,
+ * stream buffers and event groups.
+ *
+ * ipsa_ipc_bench() is called from main() in place of ipsa_sched().  For each
+ * primitive it runs two tests:
+ *   round trip - a client and a server task at the same priority pass one
+ *                uint32_t back and forth benchROUND_TRIPS times, and the
+ *                time of each round trip goes into a histogram;
+ *   throughput - a producer sends uint32_t values as fast as it can to a
+ *                consumer at a higher priority for benchRUN_TIME_MS, so, as
+ *                with prvQueueSendTask() and the receive tasks, every send
+ *                wakes the consumer.
+ * Context switches are counted by each task when a kernel call returns and
+ * the other task of the pair ran since its own last call, so switches to
+ * the idle or timer tasks are not included.  The results are printed as CSV,
+ * one line per primitive.
+ *
+ * Semaphores and event groups carry no data, so with those the value is only
+ * signalled; the figures show what the copy in the other primitives costs.
+ */
+
+#include <stdio.h>
+
+/* Kernel includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+#include "stream_buffer.h"
+#include "event_groups.h"
+
+/* Local includes. */
+#include "console.h"
+#include "ipsa_clock.h"
+#include "ipsa_hist.h"
+
+#define benchCONTROL_TASK_PRIORITY     ( tskIDLE_PRIORITY + 3 )
+#define benchCONSUMER_TASK_PRIORITY    ( tskIDLE_PRIORITY + 2 )
+#define benchPRODUCER_TASK_PRIORITY    ( tskIDLE_PRIORITY + 1 )
+#define benchPING_PONG_TASK_PRIORITY   ( tskIDLE_PRIORITY + 1 )
+
+#define benchRUN_TIME_MS               pdMS_TO_TICKS( 2000UL )
+#define benchROUND_TRIPS               ( 20000UL )
+
+/* The event group bit used by each direction of a pair. */
+#define benchEVENT_BIT_FORWARD         ( ( EventBits_t ) 0x01 )
+#define benchEVENT_BIT_BACK            ( ( EventBits_t ) 0x02 )
+
+/*-----------------------------------------------------------*/
+
+typedef enum
+{
+    eIpcQueue = 0,
+    eIpcNotify,
+    eIpcSemaphore,
+    eIpcStreamBuffer,
+    eIpcEventGroup,
+    eIpcPrimitiveCount
+} IpcPrimitive_t;
+
+/*
+ * One direction of communication between two tasks, over whichever
+ * primitive is being measured.
+ */
+typedef struct IpcChannel
+{
+    IpcPrimitive_t ePrimitive;
+    QueueHandle_t xQueue;
+    SemaphoreHandle_t xSemaphore;
+    StreamBufferHandle_t xStreamBuffer;
+    EventGroupHandle_t xEventGroup; /* Shared by both directions. */
+    EventBits_t xEventBit;
+    TaskHandle_t xReceiver;         /* Notified in eIpcNotify mode. */
+} IpcChannel_t;
+
+/*
+ * The state shared by the two tasks of a test.
+ */
+typedef struct IpcPair
+{
+    IpcChannel_t xForward;          /* Client to server, or producer to consumer. */
+    IpcChannel_t xBack;             /* Server to client; unused by the throughput test. */
+    TaskHandle_t xLastRunner;       /* Task that last returned from a kernel call. */
+    uint32_t ulSwitches;
+    uint32_t ulMessages;
+    TaskHandle_t xControl;          /* Notified when the round trips are done. */
+} IpcPair_t;
+
+/*-----------------------------------------------------------*/
+
+static void prvControlTask( void * pvParameters );
+static void prvClientTask( void * pvParameters );
+static void prvServerTask( void * pvParameters );
+static void prvProducerTask( void * pvParameters );
+static void prvConsumerTask( void * pvParameters );
+
+/*
+ * Create and delete the kernel objects behind both channels of xPair.
+ * Returns pdFAIL if there is not enough heap.
+ */
+static BaseType_t prvOpenChannels( IpcPrimitive_t ePrimitive );
+static void prvCloseChannels( void );
+
+static void prvSend( IpcChannel_t * pxChannel,
+                     uint32_t ulValue );
+static uint32_t prvReceive( IpcChannel_t * pxChannel );
+
+/*
+ * Count a context switch if a task other than the caller ran since the
+ * caller's last kernel call.
+ */
+static void prvNoteRunner( void );
+
+/*-----------------------------------------------------------*/
+
+static const char * const pcPrimitiveNames[ eIpcPrimitiveCount ] =
+{
+    "queue", "notify", "semaphore", "stream_buffer", "event_group"
+};
+
+static IpcPair_t xPair;
+
+static Histogram_t xRoundTrips;
+
+/*-----------------------------------------------------------*/
+
+void ipsa_ipc_bench( void )
+{
+    xTaskCreate( prvControlTask, "Bench", configMINIMAL_STACK_SIZE * 2, NULL, benchCONTROL_TASK_PRIORITY, NULL );
+
+    vTaskStartScheduler();
+
+    /* Only reached if there was not enough heap for the idle task. */
+    for( ; ; )
+    {
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvControlTask( void * pvParameters )
+{
+    TaskHandle_t xFirst, xSecond;
+    IpcPrimitive_t ePrimitive;
+    uint32_t ulRoundTripSwitches;
+
+    ( void ) pvParameters;
+
+    console_print( "primitive,round_trip_p50_us,round_trip_p99_us,round_trip_max_us,round_trip_switches,messages_per_s,switches_per_message\n" );
+
+    for( ePrimitive = eIpcQueue; ePrimitive < eIpcPrimitiveCount; ePrimitive++ )
+    {
+        /* Round trips.  Both tasks are created before either can run, as
+         * this task has the higher priority, so the notification targets can
+         * be filled in first. */
+        if( prvOpenChannels( ePrimitive ) == pdFAIL )
+        {
+            console_print( "%s: not enough heap\n", pcPrimitiveNames[ ePrimitive ] );
+            continue;
+        }
+
+        vHistogramReset( &xRoundTrips );
+        xPair.xControl = xTaskGetCurrentTaskHandle();
+        xTaskCreate( prvServerTask, "Server", configMINIMAL_STACK_SIZE, NULL, benchPING_PONG_TASK_PRIORITY, &xSecond );
+        xTaskCreate( prvClientTask, "Client", configMINIMAL_STACK_SIZE, NULL, benchPING_PONG_TASK_PRIORITY, &xFirst );
+        xPair.xForward.xReceiver = xSecond;
+        xPair.xBack.xReceiver = xFirst;
+
+        ( void ) ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+
+        ulRoundTripSwitches = xPair.ulSwitches;
+        vTaskDelete( xFirst );
+        vTaskDelete( xSecond );
+        prvCloseChannels();
+
+        /* Throughput. */
+        if( prvOpenChannels( ePrimitive ) == pdFAIL )
+        {
+            console_print( "%s: not enough heap\n", pcPrimitiveNames[ ePrimitive ] );
+            continue;
+        }
+
+        xTaskCreate( prvConsumerTask, "Consumer", configMINIMAL_STACK_SIZE, NULL, benchCONSUMER_TASK_PRIORITY, &xSecond );
+        xTaskCreate( prvProducerTask, "Producer", configMINIMAL_STACK_SIZE, NULL, benchPRODUCER_TASK_PRIORITY, &xFirst );
+        xPair.xForward.xReceiver = xSecond;
+
+        vTaskDelay( benchRUN_TIME_MS );
+
+        /* Stop both before reading the counters so they are stable. */
+        vTaskDelete( xFirst );
+        vTaskDelete( xSecond );
+
+        console_print( "%s,%.1f,%.1f,%.1f,%.2f,%lu,%.2f\n",
+                       pcPrimitiveNames[ ePrimitive ],
+                       ullHistogramPercentile( &xRoundTrips, 50.0 ) / 1000.0,
+                       ullHistogramPercentile( &xRoundTrips, 99.0 ) / 1000.0,
+                       xRoundTrips.ullMax / 1000.0,
+                       ( double ) ulRoundTripSwitches / ( double ) benchROUND_TRIPS,
+                       ( unsigned long ) ( ( ( uint64_t ) xPair.ulMessages * configTICK_RATE_HZ ) / benchRUN_TIME_MS ),
+                       ( xPair.ulMessages != 0U ) ? ( double ) xPair.ulSwitches / ( double ) xPair.ulMessages : 0.0 );
+
+        prvCloseChannels();
+
+        /* Give the idle task a chance to free the deleted tasks. */
+        vTaskDelay( pdMS_TO_TICKS( 100UL ) );
+    }
+
+    console_print( "IPC benchmark done\n" );
+    vTaskDelete( NULL );
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvOpenChannels( IpcPrimitive_t ePrimitive )
+{
+    IpcChannel_t * pxChannels[ 2 ] = { &( xPair.xForward ), &( xPair.xBack ) };
+    EventGroupHandle_t xEventGroup = NULL;
+    BaseType_t xResult = pdPASS;
+    size_t x;
+
+    xPair.xLastRunner = NULL;
+    xPair.ulSwitches = 0;
+    xPair.ulMessages = 0;
+
+    if( ePrimitive == eIpcEventGroup )
+    {
+        xEventGroup = xEventGroupCreate();
+        xResult = ( xEventGroup != NULL ) ? pdPASS : pdFAIL;
+    }
+
+    for( x = 0; x < 2; x++ )
+    {
+        IpcChannel_t * pxChannel = pxChannels[ x ];
+
+        pxChannel->ePrimitive = ePrimitive;
+        pxChannel->xQueue = NULL;
+        pxChannel->xSemaphore = NULL;
+        pxChannel->xStreamBuffer = NULL;
+        pxChannel->xEventGroup = xEventGroup;
+        pxChannel->xEventBit = ( x == 0 ) ? benchEVENT_BIT_FORWARD : benchEVENT_BIT_BACK;
+        pxChannel->xReceiver = NULL;
+
+        switch( ePrimitive )
+        {
+            case eIpcQueue:
+                pxChannel->xQueue = xQueueCreate( 1, sizeof( uint32_t ) );
+                xResult = ( pxChannel->xQueue != NULL ) ? xResult : pdFAIL;
+                break;
+
+            case eIpcSemaphore:
+                pxChannel->xSemaphore = xSemaphoreCreateBinary();
+                xResult = ( pxChannel->xSemaphore != NULL ) ? xResult : pdFAIL;
+                break;
+
+            case eIpcStreamBuffer:
+                /* Room for one value, and wake the reader as soon as it is
+                 * complete. */
+                pxChannel->xStreamBuffer = xStreamBufferCreate( sizeof( uint32_t ), sizeof( uint32_t ) );
+                xResult = ( pxChannel->xStreamBuffer != NULL ) ? xResult : pdFAIL;
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    if( xResult == pdFAIL )
+    {
+        prvCloseChannels();
+    }
+
+    return xResult;
+}
+/*-----------------------------------------------------------*/
+
+static void prvCloseChannels( void )
+{
+    IpcChannel_t * pxChannels[ 2 ] = { &( xPair.xForward ), &( xPair.xBack ) };
+    size_t x;
+
+    for( x = 0; x < 2; x++ )
+    {
+        if( pxChannels[ x ]->xQueue != NULL )
+        {
+            vQueueDelete( pxChannels[ x ]->xQueue );
+            pxChannels[ x ]->xQueue = NULL;
+        }
+
+        if( pxChannels[ x ]->xSemaphore != NULL )
+        {
+            vSemaphoreDelete( pxChannels[ x ]->xSemaphore );
+            pxChannels[ x ]->xSemaphore = NULL;
+        }
+
+        if( pxChannels[ x ]->xStreamBuffer != NULL )
+        {
+            vStreamBufferDelete( pxChannels[ x ]->xStreamBuffer );
+            pxChannels[ x ]->xStreamBuffer = NULL;
+        }
+    }
+
+    if( xPair.xForward.xEventGroup != NULL )
+    {
+        vEventGroupDelete( xPair.xForward.xEventGroup );
+        xPair.xForward.xEventGroup = NULL;
+        xPair.xBack.xEventGroup = NULL;
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvSend( IpcChannel_t * pxChannel,
+                     uint32_t ulValue )
+{
+    switch( pxChannel->ePrimitive )
+    {
+        case eIpcQueue:
+            ( void ) xQueueSend( pxChannel->xQueue, &ulValue, portMAX_DELAY );
+            break;
+
+        case eIpcNotify:
+            ( void ) xTaskNotify( pxChannel->xReceiver, ulValue, eSetValueWithOverwrite );
+            break;
+
+        case eIpcSemaphore:
+            ( void ) xSemaphoreGive( pxChannel->xSemaphore );
+            break;
+
+        case eIpcStreamBuffer:
+            ( void ) xStreamBufferSend( pxChannel->xStreamBuffer, &ulValue, sizeof( ulValue ), portMAX_DELAY );
+            break;
+
+        default:
+            ( void ) xEventGroupSetBits( pxChannel->xEventGroup, pxChannel->xEventBit );
+            break;
+    }
+
+    prvNoteRunner();
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t prvReceive( IpcChannel_t * pxChannel )
+{
+    uint32_t ulValue = 0;
+
+    switch( pxChannel->ePrimitive )
+    {
+        case eIpcQueue:
+            ( void ) xQueueReceive( pxChannel->xQueue, &ulValue, portMAX_DELAY );
+            break;
+
+        case eIpcNotify:
+            ( void ) xTaskNotifyWait( 0, 0, &ulValue, portMAX_DELAY );
+            break;
+
+        case eIpcSemaphore:
+            ( void ) xSemaphoreTake( pxChannel->xSemaphore, portMAX_DELAY );
+            break;
+
+        case eIpcStreamBuffer:
+            ( void ) xStreamBufferReceive( pxChannel->xStreamBuffer, &ulValue, sizeof( ulValue ), portMAX_DELAY );
+            break;
+
+        default:
+            ( void ) xEventGroupWaitBits( pxChannel->xEventGroup, pxChannel->xEventBit, pdTRUE, pdFALSE, portMAX_DELAY );
+            break;
+    }
+
+    prvNoteRunner();
+
+    return ulValue;
+}
+/*-----------------------------------------------------------*/
+
+static void prvNoteRunner( void )
+{
+    TaskHandle_t xSelf = xTaskGetCurrentTaskHandle();
+
+    if( xPair.xLastRunner != xSelf )
+    {
+        if( xPair.xLastRunner != NULL )
+        {
+            xPair.ulSwitches++;
+        }
+
+        xPair.xLastRunner = xSelf;
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvClientTask( void * pvParameters )
+{
+    uint64_t ullStartNs;
+    uint32_t ul;
+
+    ( void ) pvParameters;
+
+    for( ul = 0; ul < benchROUND_TRIPS; ul++ )
+    {
+        ullStartNs = ullIpsaClockNs();
+        prvSend( &( xPair.xForward ), ul );
+        ( void ) prvReceive( &( xPair.xBack ) );
+        vHistogramRecord( &xRoundTrips, ullIpsaClockNs() - ullStartNs );
+    }
+
+    xTaskNotifyGive( xPair.xControl );
+
+    for( ; ; )
+    {
+        vTaskSuspend( NULL );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvServerTask( void * pvParameters )
+{
+    ( void ) pvParameters;
+
+    for( ; ; )
+    {
+        prvSend( &( xPair.xBack ), prvReceive( &( xPair.xForward ) ) );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvProducerTask( void * pvParameters )
+{
+    uint32_t ulValue = 0;
+
+    ( void ) pvParameters;
+
+    for( ; ; )
+    {
+        prvSend( &( xPair.xForward ), ulValue++ );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvConsumerTask( void * pvParameters )
+{
+    ( void ) pvParameters;
+
+    for( ; ; )
+    {
+        ( void ) prvReceive( &( xPair.xForward ) );
+        xPair.ulMessages++;
+    }
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,354 @@
+/*
+ * Deferred, lock-free logging.  See ipsa_log.h.
+ *
+ * The ring is a bounded queue in which every slot carries a sequence number.
+ * A writer claims the next slot by advancing the write position with a
+ * compare and swap, fills it, then publishes it by storing the position + 1
+ * in the slot's sequence number.  The reader consumes a slot only once its
+ * sequence number says it has been published, and hands it back to the
+ * writers by storing the position + logRING_LENGTH.  No writer ever waits for
+ * another one, so a task preempted half way through a write only delays the
+ * drain, never the other writers.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+/* Local includes. */
+#include "ipsa_log.h"
+
+#define logRING_MASK       ( logRING_LENGTH - 1U )
+
+#if ( ( logRING_LENGTH & logRING_MASK ) != 0 )
+    #error logRING_LENGTH must be a power of two
+#endif
+
+/* Longest conversion specification copied out of a format string. */
+#define logMAX_SPEC        ( 16 )
+
+typedef struct LogRecord
+{
+    uint32_t ulSequence; /* Stored relative to the slot index, see prvGetSequence(). */
+    uint32_t ulArgCount;
+    const char * pcFormat;
+    LogArg_t xArgs[ logMAX_ARGS ];
+} LogRecord_t;
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Read and write a slot's sequence number.  Slot i has to start out free for
+ * position i, i.e. with sequence number i.  Storing the sequence number minus
+ * the slot index lets the ring start in that state from plain zero
+ * initialisation, with no set up call.
+ */
+static uint32_t prvGetSequence( uint32_t ulSlot );
+static void prvSetSequence( uint32_t ulSlot,
+                            uint32_t ulSequence );
+
+/*
+ * Format one record into pcBuffer.  Returns the number of characters the
+ * complete line needs, which may be more than xBufferSize.
+ */
+static size_t prvFormatRecord( const LogRecord_t * pxRecord,
+                               char * pcBuffer,
+                               size_t xBufferSize );
+
+/*-----------------------------------------------------------*/
+
+static LogRecord_t xRing[ logRING_LENGTH ];
+static uint32_t ulWritePosition = 0;
+static uint32_t ulReadPosition = 0;
+static uint32_t ulOverflows = 0;
+static uint32_t ulOverflowsReported = 0;
+
+/*-----------------------------------------------------------*/
+
+static uint32_t prvGetSequence( uint32_t ulSlot )
+{
+    return __atomic_load_n( &( xRing[ ulSlot ].ulSequence ), __ATOMIC_ACQUIRE ) + ulSlot;
+}
+/*-----------------------------------------------------------*/
+
+static void prvSetSequence( uint32_t ulSlot,
+                            uint32_t ulSequence )
+{
+    __atomic_store_n( &( xRing[ ulSlot ].ulSequence ), ulSequence - ulSlot, __ATOMIC_RELEASE );
+}
+/*-----------------------------------------------------------*/
+
+void vLogWrite( const char * pcFormat,
+                const LogArg_t * pxArgs,
+                uint32_t ulArgCount )
+{
+    LogRecord_t * pxRecord;
+    uint32_t ulPosition, ulSequence, ul;
+    int32_t lDifference;
+
+    ulPosition = __atomic_load_n( &ulWritePosition, __ATOMIC_RELAXED );
+
+    for( ; ; )
+    {
+        ulSequence = prvGetSequence( ulPosition & logRING_MASK );
+        lDifference = ( int32_t ) ( ulSequence - ulPosition );
+
+        if( lDifference == 0 )
+        {
+            /* The slot is free - try to claim it.  On failure ulPosition is
+             * updated to the current write position. */
+            if( __atomic_compare_exchange_n( &ulWritePosition, &ulPosition, ulPosition + 1U, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED ) )
+            {
+                break;
+            }
+        }
+        else if( lDifference < 0 )
+        {
+            /* The reader has not released this slot yet - the ring is full. */
+            __atomic_fetch_add( &ulOverflows, 1U, __ATOMIC_RELAXED );
+            return;
+        }
+        else
+        {
+            /* Another writer claimed the slot first. */
+            ulPosition = __atomic_load_n( &ulWritePosition, __ATOMIC_RELAXED );
+        }
+    }
+
+    pxRecord = &( xRing[ ulPosition & logRING_MASK ] );
+
+    if( ulArgCount > logMAX_ARGS )
+    {
+        ulArgCount = logMAX_ARGS;
+    }
+
+    pxRecord->pcFormat = pcFormat;
+    pxRecord->ulArgCount = ulArgCount;
+
+    for( ul = 0; ul < ulArgCount; ul++ )
+    {
+        pxRecord->xArgs[ ul ] = pxArgs[ ul ];
+    }
+
+    prvSetSequence( ulPosition & logRING_MASK, ulPosition + 1U );
+}
+/*-----------------------------------------------------------*/
+
+size_t xLogDrain( char * pcBuffer,
+                  size_t xBufferSize )
+{
+    LogRecord_t * pxRecord;
+    uint32_t ulSequence, ulOverflowCount;
+    size_t xLength = 0, xNeeded;
+    int iWritten;
+
+    if( xBufferSize == 0 )
+    {
+        return 0;
+    }
+
+    pcBuffer[ 0 ] = '\0';
+
+    ulOverflowCount = __atomic_load_n( &ulOverflows, __ATOMIC_RELAXED );
+
+    if( ulOverflowCount != ulOverflowsReported )
+    {
+        iWritten = snprintf( pcBuffer, xBufferSize, "[log] %lu records lost\n", ( unsigned long ) ( ulOverflowCount - ulOverflowsReported ) );
+
+        if( ( iWritten > 0 ) && ( ( size_t ) iWritten < xBufferSize ) )
+        {
+            xLength = ( size_t ) iWritten;
+            ulOverflowsReported = ulOverflowCount;
+        }
+    }
+
+    for( ; ; )
+    {
+        pxRecord = &( xRing[ ulReadPosition & logRING_MASK ] );
+        ulSequence = prvGetSequence( ulReadPosition & logRING_MASK );
+
+        if( ulSequence != ( ulReadPosition + 1U ) )
+        {
+            /* Empty, or the next record is still being written. */
+            break;
+        }
+
+        xNeeded = prvFormatRecord( pxRecord, &( pcBuffer[ xLength ] ), xBufferSize - xLength );
+
+        if( ( xLength + xNeeded ) >= xBufferSize )
+        {
+            /* Leave the record for the next drain unless it can never fit. */
+            if( xLength != 0 )
+            {
+                pcBuffer[ xLength ] = '\0';
+                break;
+            }
+
+            xNeeded = xBufferSize - 1;
+        }
+
+        xLength += xNeeded;
+
+        prvSetSequence( ulReadPosition & logRING_MASK, ulReadPosition + logRING_LENGTH );
+        ulReadPosition++;
+    }
+
+    return xLength;
+}
+/*-----------------------------------------------------------*/
+
+uint32_t ulLogGetOverflowCount( void )
+{
+    return __atomic_load_n( &ulOverflows, __ATOMIC_RELAXED );
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvFormatRecord( const LogRecord_t * pxRecord,
+                               char * pcBuffer,
+                               size_t xBufferSize )
+{
+    const char * pcFormat = pxRecord->pcFormat;
+    const char * pcStart;
+    char cSpec[ logMAX_SPEC ];
+    char cScratch[ 1 ];
+    char * pcOut;
+    size_t xLength = 0, xSpecLength, xSpace;
+    uint32_t ulArg = 0;
+    int iWritten, iLongs;
+    char cConversion;
+    LogArg_t xArg;
+
+    while( *pcFormat != '\0' )
+    {
+        if( ( *pcFormat != '%' ) || ( pcFormat[ 1 ] == '%' ) )
+        {
+            if( xLength + 1 < xBufferSize )
+            {
+                pcBuffer[ xLength ] = *pcFormat;
+            }
+
+            xLength++;
+            pcFormat += ( *pcFormat == '%' ) ? 2 : 1;
+            continue;
+        }
+
+        /* Copy the whole conversion specification, flags to conversion
+         * character, so snprintf() applies the width and precision. */
+        pcStart = pcFormat++;
+        iLongs = 0;
+
+        while( ( *pcFormat != '\0' ) && ( strchr( "diouxXcsfFeEgGaA", *pcFormat ) == NULL ) )
+        {
+            if( *pcFormat == 'l' )
+            {
+                iLongs++;
+            }
+            else if( *pcFormat == 'z' )
+            {
+                iLongs = 1;
+            }
+
+            pcFormat++;
+        }
+
+        if( *pcFormat == '\0' )
+        {
+            break;
+        }
+
+        cConversion = *pcFormat++;
+        xSpecLength = ( size_t ) ( pcFormat - pcStart );
+
+        if( xSpecLength >= logMAX_SPEC )
+        {
+            xSpecLength = logMAX_SPEC - 1;
+        }
+
+        memcpy( cSpec, pcStart, xSpecLength );
+        cSpec[ xSpecLength ] = '\0';
+
+        /* A missing argument prints as zero rather than reading garbage. */
+        xArg.ullUnsigned = 0;
+
+        if( ulArg < pxRecord->ulArgCount )
+        {
+            xArg = pxRecord->xArgs[ ulArg ];
+        }
+
+        ulArg++;
+
+        /* Past the end of the buffer only the length is needed. */
+        if( xLength < xBufferSize )
+        {
+            pcOut = &( pcBuffer[ xLength ] );
+            xSpace = xBufferSize - xLength;
+        }
+        else
+        {
+            pcOut = cScratch;
+            xSpace = sizeof( cScratch );
+        }
+
+        switch( cConversion )
+        {
+            case 'd':
+            case 'i':
+            case 'c':
+
+                if( iLongs >= 2 )
+                {
+                    iWritten = snprintf( pcOut, xSpace, cSpec, ( long long ) xArg.llSigned );
+                }
+                else if( iLongs == 1 )
+                {
+                    iWritten = snprintf( pcOut, xSpace, cSpec, ( long ) xArg.llSigned );
+                }
+                else
+                {
+                    iWritten = snprintf( pcOut, xSpace, cSpec, ( int ) xArg.llSigned );
+                }
+
+                break;
+
+            case 'o':
+            case 'u':
+            case 'x':
+            case 'X':
+
+                if( iLongs >= 2 )
+                {
+                    iWritten = snprintf( pcOut, xSpace, cSpec, ( unsigned long long ) xArg.ullUnsigned );
+                }
+                else if( iLongs == 1 )
+                {
+                    iWritten = snprintf( pcOut, xSpace, cSpec, ( unsigned long ) xArg.ullUnsigned );
+                }
+                else
+                {
+                    iWritten = snprintf( pcOut, xSpace, cSpec, ( unsigned int ) xArg.ullUnsigned );
+                }
+
+                break;
+
+            case 's':
+                iWritten = snprintf( pcOut, xSpace, cSpec, ( xArg.pcString != NULL ) ? xArg.pcString : "(null)" );
+                break;
+
+            default:
+                iWritten = snprintf( pcOut, xSpace, cSpec, xArg.dFloat );
+                break;
+        }
+
+        if( iWritten > 0 )
+        {
+            xLength += ( size_t ) iWritten;
+        }
+    }
+
+    if( xLength < xBufferSize )
+    {
+        pcBuffer[ xLength ] = '\0';
+    }
+
+    return xLength;
+}
+/*-----------------------------------------------------------*/
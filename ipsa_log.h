@@ -0,0 +1,128 @@
+/*
+ * Deferred, lock-free logging for the ipsa_sched demo.
+ *
+ * vLogPrint() takes the same arguments as console_print(), but does not format
+ * anything or make any system call.  It stores a pointer to the format string
+ * (which therefore has to be a string literal) and the raw argument values in
+ * a fixed size multi-producer / single-consumer ring.  A low priority task
+ * later calls xLogDrain() to format a batch of records into one buffer and
+ * write it out with a single call.  When the ring is full the record is
+ * discarded and counted - a writer never blocks.
+ *
+ * Supported conversions are the integer ones (d i u x X o c, with the h l ll z
+ * modifiers), the floating point ones (f F e E g G) and s.  Arguments are
+ * captured by type, so each one must be an arithmetic type or a string.
+ *
+ * This file has no kernel dependency so the ring can also be benchmarked on
+ * the host, see log_bench.c.
+ */
+
+#ifndef IPSA_LOG_H
+#define IPSA_LOG_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Number of records held by the ring.  Must be a power of two. */
+#ifndef logRING_LENGTH
+    #define logRING_LENGTH    ( 256U )
+#endif
+
+/* Maximum number of arguments a record can carry. */
+#define logMAX_ARGS           ( 4 )
+
+typedef union LogArg
+{
+    int64_t llSigned;
+    uint64_t ullUnsigned;
+    double dFloat;
+    const char * pcString;
+} LogArg_t;
+
+static inline LogArg_t xLogArgSigned( int64_t llValue )
+{
+    LogArg_t xArg;
+
+    xArg.llSigned = llValue;
+    return xArg;
+}
+
+static inline LogArg_t xLogArgUnsigned( uint64_t ullValue )
+{
+    LogArg_t xArg;
+
+    xArg.ullUnsigned = ullValue;
+    return xArg;
+}
+
+static inline LogArg_t xLogArgFloat( double dValue )
+{
+    LogArg_t xArg;
+
+    xArg.dFloat = dValue;
+    return xArg;
+}
+
+static inline LogArg_t xLogArgString( const char * pcValue )
+{
+    LogArg_t xArg;
+
+    xArg.pcString = pcValue;
+    return xArg;
+}
+
+/* Capture one argument without converting it to text. */
+#define logARG( x )                                 \
+    _Generic( ( x ),                                \
+              float: xLogArgFloat,                  \
+              double: xLogArgFloat,                 \
+              char *: xLogArgString,                \
+              const char *: xLogArgString,          \
+              unsigned char: xLogArgUnsigned,       \
+              unsigned short: xLogArgUnsigned,      \
+              unsigned int: xLogArgUnsigned,        \
+              unsigned long: xLogArgUnsigned,       \
+              unsigned long long: xLogArgUnsigned,  \
+              default: xLogArgSigned )( x )
+
+#define logARGS_0()
+#define logARGS_1( a )                ,logARG( a )
+#define logARGS_2( a, b )             ,logARG( a ), logARG( b )
+#define logARGS_3( a, b, c )          ,logARG( a ), logARG( b ), logARG( c )
+#define logARGS_4( a, b, c, d )       ,logARG( a ), logARG( b ), logARG( c ), logARG( d )
+#define logSELECT( _0, _1, _2, _3, _4, NAME, ... )    NAME
+#define logCOUNT( ... )               logSELECT( _0, ## __VA_ARGS__, 4, 3, 2, 1, 0, 0 )
+#define logARGS( ... )                logSELECT( _0, ## __VA_ARGS__, logARGS_4, logARGS_3, logARGS_2, logARGS_1, logARGS_0, logARGS_0 )( __VA_ARGS__ )
+
+/*
+ * printf() style entry point.  Up to logMAX_ARGS arguments.
+ */
+#define vLogPrint( pcFormat, ... )                                   \
+    do {                                                             \
+        const LogArg_t xArgs_[ logMAX_ARGS + 1 ] = { { 0 } logARGS( __VA_ARGS__ ) }; \
+        vLogWrite( ( pcFormat ), &( xArgs_[ 1 ] ), logCOUNT( __VA_ARGS__ ) );      \
+    } while( 0 )
+
+/*
+ * Queue one record.  pcFormat must remain valid until the record is drained.
+ */
+void vLogWrite( const char * pcFormat,
+                const LogArg_t * pxArgs,
+                uint32_t ulArgCount );
+
+/*
+ * Format queued records into pcBuffer, oldest first, until the ring is empty
+ * or the next record would not fit.  A line reporting the number of records
+ * lost since the last drain is emitted first if any were.  Returns the number
+ * of characters written, excluding the terminating nul.  Only one task may
+ * drain.
+ */
+size_t xLogDrain( char * pcBuffer,
+                  size_t xBufferSize );
+
+/*
+ * Total number of records discarded because the ring was full.
+ */
+uint32_t ulLogGetOverflowCount( void );
+
+#endif /* IPSA_LOG_H */
@@ -0,0 +1,18 @@
+/*
+ * The item passed from the send task and the software timer to the receive
+ * tasks of the ipsa_sched demo, by queue or by broadcast channel.
+ */
+
+#ifndef IPSA_MESSAGE_H
+#define IPSA_MESSAGE_H
+
+#include <stdint.h>
+
+typedef struct IpsaMessage
+{
+    uint32_t ulValue;       /* mainVALUE_SENT_FROM_TASK or mainVALUE_SENT_FROM_TIMER. */
+    uint32_t ulSequence;    /* Number of the send, for matching a recorded run to a replay. */
+    uint64_t ullReleaseNs;  /* ullIpsaClockNs() when the sender was released. */
+} IpsaMessage_t;
+
+#endif /* IPSA_MESSAGE_H */
@@ -0,0 +1,111 @@
+/*
+ * Partitioned multi-core execution.  See ipsa_partition.h.
+ */
+
+#define _GNU_SOURCE
+
+#include <sched.h>
+#include <string.h>
+
+/* Local includes. */
+#include "ipsa_clock.h"
+#include "ipsa_partition.h"
+
+/*-----------------------------------------------------------*/
+
+static void * prvPartitionThread( void * pvParameters )
+{
+    Partition_t * pxPartition = ( Partition_t * ) pvParameters;
+    PartitionTask_t * pxTask;
+    IpsaMessage_t xMessage;
+    uint64_t ullStartNs;
+    size_t x;
+
+    while( __atomic_load_n( &( pxPartition->iRunning ), __ATOMIC_RELAXED ) != 0 )
+    {
+        for( x = 0; x < pxPartition->xTaskCount; x++ )
+        {
+            pxTask = pxPartition->pxTasks[ x ];
+
+            if( iSpscPop( pxTask->pxInbox, &xMessage ) != 0 )
+            {
+                ullStartNs = ullIpsaClockNs();
+                vHistogramRecord( &( pxTask->xReleaseToStart ),
+                                  ( ullStartNs > xMessage.ullReleaseNs ) ? ullStartNs - xMessage.ullReleaseNs : 0U );
+                pxTask->pvWorkload( &xMessage );
+                pxTask->ullRuns++;
+                break;
+            }
+        }
+
+        if( x == pxPartition->xTaskCount )
+        {
+            /* Nothing ready.  Let the other threads pinned to this core run. */
+            ( void ) sched_yield();
+        }
+    }
+
+    return NULL;
+}
+/*-----------------------------------------------------------*/
+
+void vPartitionInit( Partition_t * pxPartition,
+                     int iCore )
+{
+    memset( pxPartition, 0, sizeof( *pxPartition ) );
+    pxPartition->iCore = iCore;
+}
+/*-----------------------------------------------------------*/
+
+int iPartitionAddTask( Partition_t * pxPartition,
+                       PartitionTask_t * pxTask )
+{
+    if( pxPartition->xTaskCount >= partitionMAX_TASKS )
+    {
+        return -1;
+    }
+
+    vHistogramReset( &( pxTask->xReleaseToStart ) );
+    pxTask->ullRuns = 0;
+    pxPartition->pxTasks[ pxPartition->xTaskCount ] = pxTask;
+    pxPartition->xTaskCount++;
+
+    return 0;
+}
+/*-----------------------------------------------------------*/
+
+int iPartitionStart( Partition_t * pxPartition )
+{
+    cpu_set_t xCores;
+    int iError;
+
+    pxPartition->iRunning = 1;
+    iError = pthread_create( &( pxPartition->xThread ), NULL, prvPartitionThread, pxPartition );
+
+    if( ( iError == 0 ) && ( pxPartition->iCore >= 0 ) )
+    {
+        CPU_ZERO( &xCores );
+        CPU_SET( pxPartition->iCore, &xCores );
+        iError = pthread_setaffinity_np( pxPartition->xThread, sizeof( xCores ), &xCores );
+
+        if( iError != 0 )
+        {
+            vPartitionStop( pxPartition );
+        }
+    }
+
+    if( iError != 0 )
+    {
+        pxPartition->iRunning = 0;
+    }
+
+    return iError;
+}
+/*-----------------------------------------------------------*/
+
+void vPartitionStop( Partition_t * pxPartition )
+{
+    __atomic_store_n( &( pxPartition->iRunning ), 0, __ATOMIC_RELAXED );
+    ( void ) pthread_join( pxPartition->xThread, NULL );
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,81 @@
+/*
+ * Partitioned multi-core execution of a task set on the host.
+ *
+ * The FreeRTOS Linux port runs every task on one simulated core: the kernel
+ * in this tree has no SMP support, and its scheduler state is global to the
+ * process, so there cannot be one instance per core either.  A partition is
+ * the nearest host equivalent: one thread pinned to one host core, running a
+ * small fixed priority scheduler over the tasks assigned to it.  Each task
+ * has an inbox, an SPSC ring (ipsa_spsc.h) written by exactly one thread on
+ * another core, and is released by each message that arrives there.  The
+ * partition runs the highest priority task (the first added) that has a
+ * message waiting, to completion, then looks again from the top, so tasks
+ * are not preempted, as with configUSE_PREEMPTION set to 0.  When no task is
+ * ready the thread yields its core.
+ *
+ * The time from a message's ullReleaseNs to the start of the task is kept
+ * per task in a histogram.  Nothing here depends on the kernel; see
+ * smp_bench.c for the task set of ipsa_sched.c spread over 1 to N cores.
+ */
+
+#ifndef IPSA_PARTITION_H
+#define IPSA_PARTITION_H
+
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Local includes. */
+#include "ipsa_hist.h"
+#include "ipsa_spsc.h"
+
+/* Most tasks one partition can run. */
+#ifndef partitionMAX_TASKS
+    #define partitionMAX_TASKS    ( 32 )
+#endif
+
+typedef struct PartitionTask
+{
+    const char * pcName;
+    void ( * pvWorkload )( const IpsaMessage_t * pxMessage );
+    SpscRing_t * pxInbox;
+    Histogram_t xReleaseToStart;   /* Written by the partition thread only. */
+    uint64_t ullRuns;
+} PartitionTask_t;
+
+typedef struct Partition
+{
+    int iCore;                     /* Host CPU the thread is pinned to, or -1. */
+    PartitionTask_t * pxTasks[ partitionMAX_TASKS ];
+    size_t xTaskCount;
+    pthread_t xThread;
+    volatile int iRunning;
+} Partition_t;
+
+/*
+ * Set up an empty partition for host CPU iCore, or unpinned if iCore is -1.
+ */
+void vPartitionInit( Partition_t * pxPartition,
+                     int iCore );
+
+/*
+ * Add a task, at a lower priority than the tasks added before it, and reset
+ * its counters.  Returns 0, or -1 if the partition is full.  Tasks must be
+ * added before the partition is started.
+ */
+int iPartitionAddTask( Partition_t * pxPartition,
+                       PartitionTask_t * pxTask );
+
+/*
+ * Start the partition's thread.  Returns 0, or an error number if the thread
+ * could not be created or pinned.
+ */
+int iPartitionStart( Partition_t * pxPartition );
+
+/*
+ * Stop the thread once it has finished the task it is running, and wait for
+ * it.  Messages left in the inboxes are not handled.
+ */
+void vPartitionStop( Partition_t * pxPartition );
+
+#endif /* IPSA_PARTITION_H */
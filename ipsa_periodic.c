@@ -0,0 +1,180 @@
+/*
+ * Periodic release with deadline miss detection.  See ipsa_periodic.h.
+ *
+ * Release times are kept in ticks, as vTaskDelayUntil() keeps them, so a
+ * task only counts as late when it starts at least one tick after its
+ * release.  Tick counts wrap, so "after" is tested on the difference.
+ */
+
+#include <string.h>
+
+/* Kernel includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Local includes. */
+#include "ipsa_periodic.h"
+
+/* A tick count difference this large is a negative one. */
+#define periodicIN_THE_FUTURE    ( portMAX_DELAY / 2U )
+
+static Periodic_t * pxRegistered[ periodicMAX_TASKS ];
+static UBaseType_t uxRegisteredCount = 0;
+static uint32_t ulUnregisteredCount = 0;
+
+/*-----------------------------------------------------------*/
+
+BaseType_t xPeriodicInit( Periodic_t * pxPeriodic,
+                          const char * pcName,
+                          TickType_t xPeriod,
+                          PeriodicPolicy_t ePolicy )
+{
+    BaseType_t xResult = pdFAIL;
+
+    configASSERT( xPeriod > 0U );
+
+    memset( pxPeriodic, 0, sizeof( *pxPeriodic ) );
+    pxPeriodic->xStats.pcName = pcName;
+    pxPeriodic->xStats.ePolicy = ePolicy;
+    pxPeriodic->xStats.xPeriod = xPeriod;
+    pxPeriodic->xStats.xCurrentPeriod = xPeriod;
+    pxPeriodic->xLastRelease = xTaskGetTickCount();
+
+    vTaskSuspendAll();
+    {
+        if( uxRegisteredCount < periodicMAX_TASKS )
+        {
+            pxRegistered[ uxRegisteredCount ] = pxPeriodic;
+            uxRegisteredCount++;
+            xResult = pdPASS;
+        }
+        else
+        {
+            ulUnregisteredCount++;
+        }
+    }
+    ( void ) xTaskResumeAll();
+
+    return xResult;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xPeriodicWait( Periodic_t * pxPeriodic )
+{
+    PeriodicStats_t * pxStats = &( pxPeriodic->xStats );
+    TickType_t xPeriod = pxStats->xCurrentPeriod;
+    TickType_t xRelease = pxPeriodic->xLastRelease + xPeriod;
+    TickType_t xLateness, xPassed, xDropped;
+
+    xLateness = xTaskGetTickCount() - xRelease;
+
+    if( xLateness > periodicIN_THE_FUTURE )
+    {
+        /* The last job finished in time.  vTaskDelayUntil() rather than
+         * vTaskDelay() so a preemption between the check and the call does
+         * not push the release back. */
+        vTaskDelayUntil( &( pxPeriodic->xLastRelease ), xPeriod );
+        xLateness = xTaskGetTickCount() - xRelease;
+    }
+    else
+    {
+        /* The last job was still running at this release.  xPassed more
+         * releases have come and gone since. */
+        xPassed = xLateness / xPeriod;
+
+        if( ( pxStats->ePolicy == ePeriodicCatchUp ) && ( xPassed <= periodicCATCH_UP_LIMIT ) )
+        {
+            /* Run this release now; the next calls will find the others
+             * passed too and return at once. */
+            xDropped = 0;
+        }
+        else if( pxStats->ePolicy == ePeriodicCatchUp )
+        {
+            xDropped = xPassed - periodicCATCH_UP_LIMIT;
+        }
+        else
+        {
+            xDropped = xPassed;
+        }
+
+        xRelease += xDropped * xPeriod;
+        xLateness -= xDropped * xPeriod;
+        pxStats->ulMissed += ( uint32_t ) xDropped;
+
+        /* Reaching the release on its very tick is on time, and counted so
+         * below, so only a missed or late release lowers the rate. */
+        if( ( pxStats->ePolicy == ePeriodicDegrade ) &&
+            ( ( xPassed > 0U ) || ( xLateness > 0U ) ) &&
+            ( xPeriod < ( pxStats->xPeriod * periodicDEGRADE_MAX_FACTOR ) ) )
+        {
+            pxStats->xCurrentPeriod = xPeriod * 2U;
+            pxStats->ulRateChanges++;
+        }
+
+        pxPeriodic->xLastRelease = xRelease;
+    }
+
+    pxStats->ulReleases++;
+
+    if( xLateness > pxStats->xMaxLateness )
+    {
+        pxStats->xMaxLateness = xLateness;
+    }
+
+    if( xLateness != 0U )
+    {
+        pxStats->ulLate++;
+        pxPeriodic->ulOnTimeRun = 0;
+
+        return pdFALSE;
+    }
+
+    pxPeriodic->ulOnTimeRun++;
+
+    if( ( pxStats->ePolicy == ePeriodicDegrade ) &&
+        ( pxStats->xCurrentPeriod > pxStats->xPeriod ) &&
+        ( pxPeriodic->ulOnTimeRun >= periodicRECOVER_RELEASES ) )
+    {
+        pxStats->xCurrentPeriod /= 2U;
+        pxStats->ulRateChanges++;
+        pxPeriodic->ulOnTimeRun = 0;
+    }
+
+    return pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+void vPeriodicCountSend( Periodic_t * pxPeriodic,
+                         BaseType_t xResult )
+{
+    if( xResult != pdPASS )
+    {
+        pxPeriodic->xStats.ulDropped++;
+    }
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xPeriodicGetStats( UBaseType_t uxIndex,
+                              PeriodicStats_t * pxStats )
+{
+    BaseType_t xResult = pdFAIL;
+
+    vTaskSuspendAll();
+    {
+        if( uxIndex < uxRegisteredCount )
+        {
+            *pxStats = pxRegistered[ uxIndex ]->xStats;
+            xResult = pdPASS;
+        }
+    }
+    ( void ) xTaskResumeAll();
+
+    return xResult;
+}
+/*-----------------------------------------------------------*/
+
+uint32_t ulPeriodicGetUnregistered( void )
+{
+    return ulUnregisteredCount;
+}
+/*-----------------------------------------------------------*/
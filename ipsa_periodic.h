@@ -0,0 +1,117 @@
+/*
+ * Periodic release with deadline miss detection for the ipsa_sched demo.
+ *
+ * xPeriodicWait() takes the place of vTaskDelayUntil() at the top of a
+ * periodic task's loop.  Each release is due one period after the previous
+ * one and its deadline is the next release, so a job that is still running
+ * when its next release comes has overrun.  vTaskDelayUntil() hides that: it
+ * returns at once and lets the task run late, without saying so.
+ * xPeriodicWait() counts it, and applies the task's overrun policy:
+ *   ePeriodicSkip     - the releases that have already passed are dropped
+ *                       and the task runs once, for the latest of them;
+ *   ePeriodicCatchUp  - the passed releases are run back to back, up to
+ *                       periodicCATCH_UP_LIMIT of them, and any older ones
+ *                       are dropped;
+ *   ePeriodicDegrade  - as skip, but the period is also doubled, up to
+ *                       periodicDEGRADE_MAX_FACTOR times the nominal period,
+ *                       and halved again after periodicRECOVER_RELEASES
+ *                       releases in a row start on time.
+ *
+ * Every periodic task is registered when it is initialised, so its counters
+ * can be read by any task at run time with xPeriodicGetStats().
+ */
+
+#ifndef IPSA_PERIODIC_H
+#define IPSA_PERIODIC_H
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Most releases run back to back after an overrun by ePeriodicCatchUp. */
+#ifndef periodicCATCH_UP_LIMIT
+    #define periodicCATCH_UP_LIMIT        ( 4U )
+#endif
+
+/* Longest period ePeriodicDegrade falls back to, as a multiple of the
+ * nominal period, and the on time releases it takes to halve it again. */
+#ifndef periodicDEGRADE_MAX_FACTOR
+    #define periodicDEGRADE_MAX_FACTOR    ( 8U )
+#endif
+#define periodicRECOVER_RELEASES          ( 16U )
+
+/* Maximum number of periodic tasks whose counters can be read at run time.
+ * Must be the same in every file that includes this header. */
+#ifndef periodicMAX_TASKS
+    #define periodicMAX_TASKS             ( 16U )
+#endif
+
+typedef enum
+{
+    ePeriodicSkip = 0,
+    ePeriodicCatchUp,
+    ePeriodicDegrade
+} PeriodicPolicy_t;
+
+typedef struct PeriodicStats
+{
+    const char * pcName;
+    PeriodicPolicy_t ePolicy;
+    TickType_t xPeriod;        /* Nominal period. */
+    TickType_t xCurrentPeriod; /* Longer than xPeriod while degraded. */
+    uint32_t ulReleases;       /* Releases the task ran for. */
+    uint32_t ulLate;           /* Of those, the ones that started after their release time. */
+    uint32_t ulMissed;         /* Releases dropped by the overrun policy. */
+    uint32_t ulDropped;        /* Sends that failed, see vPeriodicCountSend(). */
+    uint32_t ulRateChanges;    /* Times ePeriodicDegrade changed the period. */
+    TickType_t xMaxLateness;   /* Latest start seen, in ticks after the release. */
+} PeriodicStats_t;
+
+typedef struct Periodic
+{
+    PeriodicStats_t xStats;
+    TickType_t xLastRelease;   /* Tick count of the release being run. */
+    uint32_t ulOnTimeRun;      /* Consecutive releases started on time. */
+} Periodic_t;
+
+/*
+ * Start a periodic task's release sequence.  The first release is one period
+ * after this call.  pxPeriodic must stay valid for as long as the system runs,
+ * as it is registered for xPeriodicGetStats().  Returns pdFAIL if
+ * periodicMAX_TASKS are already registered: the task still runs to its
+ * period, but its counters cannot be read and it is counted by
+ * ulPeriodicGetUnregistered() instead.
+ */
+BaseType_t xPeriodicInit( Periodic_t * pxPeriodic,
+                          const char * pcName,
+                          TickType_t xPeriod,
+                          PeriodicPolicy_t ePolicy );
+
+/*
+ * Block until the next release, applying the overrun policy if it has
+ * already passed.  Returns pdTRUE if the task starts on time for the
+ * release, pdFALSE if it starts late.  Must be called by the periodic task.
+ */
+BaseType_t xPeriodicWait( Periodic_t * pxPeriodic );
+
+/*
+ * Count a send made by the periodic task that failed, xResult being the
+ * value returned by the send (for example xQueueSend() with no block time).
+ */
+void vPeriodicCountSend( Periodic_t * pxPeriodic,
+                         BaseType_t xResult );
+
+/*
+ * Copy the counters of the uxIndex'th registered periodic task to pxStats.
+ * Returns pdFAIL if fewer tasks are registered.  The counters are updated
+ * without locking, so they can be off by the release being recorded at the
+ * time.
+ */
+BaseType_t xPeriodicGetStats( UBaseType_t uxIndex,
+                              PeriodicStats_t * pxStats );
+
+/*
+ * The number of periodic tasks xPeriodicInit() could not register.
+ */
+uint32_t ulPeriodicGetUnregistered( void );
+
+#endif /* IPSA_PERIODIC_H */
@@ -0,0 +1,190 @@
+/*
+ * Fixed block memory pool.  See ipsa_pool.h.
+ *
+ * The free list is linked through the block headers by index, and the head
+ * holds the index of the first free block with a tag that is incremented by
+ * every successful exchange.  A task that read the head, was preempted while
+ * the same block was taken and given back, and then tries its exchange finds
+ * the tag changed and starts again, where comparing the index alone would
+ * have installed a stale next index.
+ */
+
+#include <string.h>
+
+/* Kernel includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Local includes. */
+#include "ipsa_pool.h"
+
+#define poolNO_BLOCK        ( 0xffffffffUL )
+
+#define poolSTATE_FREE      ( 0U )
+#define poolSTATE_OWNED     ( 1U )
+#define poolSTATE_SENT      ( 2U ) /* Handed off, not yet accepted. */
+
+#define poolMAKE_HEAD( ullTag, ulIndex )    ( ( ( uint64_t ) ( ullTag ) << 32 ) | ( uint64_t ) ( ulIndex ) )
+#define poolHEAD_TAG( ullHead )             ( ( ullHead ) >> 32 )
+#define poolHEAD_INDEX( ullHead )           ( ( uint32_t ) ( ullHead ) )
+
+typedef struct PoolHeader
+{
+    uint32_t ulNext;     /* Next free block while this one is free. */
+    uint32_t ulState;    /* poolDEBUG only. */
+    TaskHandle_t xOwner; /* poolDEBUG only. */
+} PoolHeader_t;
+
+/*-----------------------------------------------------------*/
+
+static PoolHeader_t * prvHeader( Pool_t * pxPool,
+                                 uint32_t ulIndex )
+{
+    return ( PoolHeader_t * ) &( pxPool->pucStorage[ ( size_t ) ulIndex * pxPool->xStride ] );
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t prvIndexOf( Pool_t * pxPool,
+                            void * pvBlock )
+{
+    size_t xOffset = ( size_t ) ( ( uint8_t * ) pvBlock - pxPool->pucStorage ) - poolHEADER_SIZE;
+
+    #if ( poolDEBUG == 1 )
+        configASSERT( ( uint8_t * ) pvBlock >= pxPool->pucStorage + poolHEADER_SIZE );
+        configASSERT( ( xOffset % pxPool->xStride ) == 0U );
+        configASSERT( ( xOffset / pxPool->xStride ) < pxPool->ulBlockCount );
+    #endif
+
+    return ( uint32_t ) ( xOffset / pxPool->xStride );
+}
+/*-----------------------------------------------------------*/
+
+void vPoolInit( Pool_t * pxPool,
+                void * pvStorage,
+                size_t xBlockSize,
+                uint32_t ulBlockCount )
+{
+    uint32_t ul;
+
+    configASSERT( sizeof( PoolHeader_t ) <= poolHEADER_SIZE );
+    configASSERT( ( ( uintptr_t ) pvStorage % poolALIGNMENT ) == 0U );
+    configASSERT( ulBlockCount < poolNO_BLOCK );
+
+    memset( pxPool, 0, sizeof( *pxPool ) );
+    pxPool->pucStorage = pvStorage;
+    pxPool->xStride = poolSTRIDE( xBlockSize );
+    pxPool->ulBlockCount = ulBlockCount;
+
+    for( ul = 0; ul < ulBlockCount; ul++ )
+    {
+        PoolHeader_t * pxHeader = prvHeader( pxPool, ul );
+
+        pxHeader->ulNext = ( ul + 1U < ulBlockCount ) ? ul + 1U : poolNO_BLOCK;
+        pxHeader->ulState = poolSTATE_FREE;
+        pxHeader->xOwner = NULL;
+    }
+
+    pxPool->ullHead = poolMAKE_HEAD( 0U, ( ulBlockCount > 0U ) ? 0U : poolNO_BLOCK );
+}
+/*-----------------------------------------------------------*/
+
+void * pvPoolAlloc( Pool_t * pxPool )
+{
+    PoolHeader_t * pxHeader;
+    uint64_t ullHead, ullNewHead;
+    uint32_t ulIndex, ulInUse, ulMax;
+
+    ullHead = __atomic_load_n( &( pxPool->ullHead ), __ATOMIC_ACQUIRE );
+
+    do
+    {
+        ulIndex = poolHEAD_INDEX( ullHead );
+
+        if( ulIndex == poolNO_BLOCK )
+        {
+            ( void ) __atomic_fetch_add( &( pxPool->ulExhausted ), 1U, __ATOMIC_RELAXED );
+
+            return NULL;
+        }
+
+        /* The block may be taken by another task before the exchange, in
+         * which case this value is stale, but then the tag has moved on and
+         * the exchange fails. */
+        ullNewHead = poolMAKE_HEAD( poolHEAD_TAG( ullHead ) + 1U,
+                                    __atomic_load_n( &( prvHeader( pxPool, ulIndex )->ulNext ), __ATOMIC_RELAXED ) );
+    } while( __atomic_compare_exchange_n( &( pxPool->ullHead ), &ullHead, ullNewHead, pdFALSE, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE ) == 0 );
+
+    pxHeader = prvHeader( pxPool, ulIndex );
+
+    #if ( poolDEBUG == 1 )
+        configASSERT( pxHeader->ulState == poolSTATE_FREE );
+        pxHeader->ulState = poolSTATE_OWNED;
+        pxHeader->xOwner = xTaskGetCurrentTaskHandle();
+    #endif
+
+    ( void ) __atomic_fetch_add( &( pxPool->ulAllocs ), 1U, __ATOMIC_RELAXED );
+    ulInUse = __atomic_add_fetch( &( pxPool->ulInUse ), 1U, __ATOMIC_RELAXED );
+    ulMax = __atomic_load_n( &( pxPool->ulMaxInUse ), __ATOMIC_RELAXED );
+
+    while( ( ulInUse > ulMax ) &&
+           ( __atomic_compare_exchange_n( &( pxPool->ulMaxInUse ), &ulMax, ulInUse, pdTRUE, __ATOMIC_RELAXED, __ATOMIC_RELAXED ) == 0 ) )
+    {
+    }
+
+    return ( uint8_t * ) pxHeader + poolHEADER_SIZE;
+}
+/*-----------------------------------------------------------*/
+
+void vPoolFree( Pool_t * pxPool,
+                void * pvBlock )
+{
+    uint32_t ulIndex = prvIndexOf( pxPool, pvBlock );
+    PoolHeader_t * pxHeader = prvHeader( pxPool, ulIndex );
+    uint64_t ullHead, ullNewHead;
+
+    #if ( poolDEBUG == 1 )
+        /* Freed twice, or by a task that does not own it. */
+        configASSERT( pxHeader->ulState == poolSTATE_OWNED );
+        configASSERT( pxHeader->xOwner == xTaskGetCurrentTaskHandle() );
+        pxHeader->ulState = poolSTATE_FREE;
+        pxHeader->xOwner = NULL;
+    #endif
+
+    ( void ) __atomic_fetch_sub( &( pxPool->ulInUse ), 1U, __ATOMIC_RELAXED );
+
+    ullHead = __atomic_load_n( &( pxPool->ullHead ), __ATOMIC_RELAXED );
+
+    do
+    {
+        __atomic_store_n( &( pxHeader->ulNext ), poolHEAD_INDEX( ullHead ), __ATOMIC_RELAXED );
+        ullNewHead = poolMAKE_HEAD( poolHEAD_TAG( ullHead ) + 1U, ulIndex );
+    } while( __atomic_compare_exchange_n( &( pxPool->ullHead ), &ullHead, ullNewHead, pdFALSE, __ATOMIC_RELEASE, __ATOMIC_RELAXED ) == 0 );
+}
+/*-----------------------------------------------------------*/
+
+#if ( poolDEBUG == 1 )
+
+    void vPoolHandOff( Pool_t * pxPool,
+                       void * pvBlock )
+    {
+        PoolHeader_t * pxHeader = prvHeader( pxPool, prvIndexOf( pxPool, pvBlock ) );
+
+        configASSERT( pxHeader->ulState == poolSTATE_OWNED );
+        configASSERT( pxHeader->xOwner == xTaskGetCurrentTaskHandle() );
+        pxHeader->ulState = poolSTATE_SENT;
+        pxHeader->xOwner = NULL;
+    }
+/*-----------------------------------------------------------*/
+
+    void vPoolAccept( Pool_t * pxPool,
+                      void * pvBlock )
+    {
+        PoolHeader_t * pxHeader = prvHeader( pxPool, prvIndexOf( pxPool, pvBlock ) );
+
+        configASSERT( pxHeader->ulState == poolSTATE_SENT );
+        pxHeader->ulState = poolSTATE_OWNED;
+        pxHeader->xOwner = xTaskGetCurrentTaskHandle();
+    }
+/*-----------------------------------------------------------*/
+
+#endif /* poolDEBUG */
@@ -0,0 +1,109 @@
+/*
+ * Fixed block memory pool for passing large payloads between tasks without
+ * copying them.
+ *
+ * A producer takes a block with pvPoolAlloc(), fills it in place, and sends
+ * only the pointer through a queue.  The consumer uses the block and gives
+ * it back with vPoolFree().  Allocation and release are lock free: the free
+ * blocks form a stack whose head is swapped with a compare and exchange, with
+ * a tag that changes on every swap so a block taken and given back between a
+ * read of the head and the exchange cannot corrupt the list.  They never
+ * block, suspend the scheduler or enter a critical section.  When the pool
+ * is empty pvPoolAlloc() returns NULL and the failure is counted in
+ * ulExhausted.
+ *
+ * Ownership checks (poolDEBUG set to 1, the default unless NDEBUG is
+ * defined):  every block records the task that owns it.  A block must be
+ * freed by its owner, and only once, and a pointer that is not the start of
+ * a block of the pool fails too.  To pass a block on, the sender calls
+ * vPoolHandOff() before sending the pointer and the receiver vPoolAccept()
+ * once it has it, so a block used by two tasks at once is caught.  A failed
+ * check is a configASSERT().  With poolDEBUG set to 0 the hand off calls
+ * compile to nothing and only the counters are kept.
+ *
+ * The storage is provided by the caller, poolSTORAGE_SIZE() bytes aligned to
+ * poolALIGNMENT, so a pool can be statically allocated:
+ *
+ *     static uint8_t ucStorage[ poolSTORAGE_SIZE( 256, 8 ) ] __attribute__( ( aligned( poolALIGNMENT ) ) );
+ */
+
+#ifndef IPSA_POOL_H
+#define IPSA_POOL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#ifndef poolDEBUG
+    #ifdef NDEBUG
+        #define poolDEBUG    0
+    #else
+        #define poolDEBUG    1
+    #endif
+#endif
+
+/* Alignment of the storage and of every block. */
+#define poolALIGNMENT                             ( 16U )
+
+/* Each block is preceded by a header of this size. */
+#define poolHEADER_SIZE                           ( 16U )
+
+#define poolROUND( x )                            ( ( ( x ) + poolALIGNMENT - 1U ) & ~( ( size_t ) poolALIGNMENT - 1U ) )
+#define poolSTRIDE( xBlockSize )                  ( poolHEADER_SIZE + poolROUND( xBlockSize ) )
+#define poolSTORAGE_SIZE( xBlockSize, ulCount )   ( ( size_t ) ( ulCount ) * poolSTRIDE( xBlockSize ) )
+
+typedef struct Pool
+{
+    uint8_t * pucStorage;
+    size_t xStride;            /* Bytes from one block header to the next. */
+    uint32_t ulBlockCount;
+    uint64_t ullHead;          /* Tag in the top half, index of the first free block in the bottom half. */
+    uint32_t ulAllocs;
+    uint32_t ulExhausted;      /* pvPoolAlloc() calls that found the pool empty. */
+    uint32_t ulInUse;
+    uint32_t ulMaxInUse;       /* High water mark of ulInUse. */
+} Pool_t;
+
+/*
+ * Set up a pool of ulBlockCount blocks of xBlockSize bytes in pvStorage,
+ * which must be poolSTORAGE_SIZE( xBlockSize, ulBlockCount ) bytes aligned to
+ * poolALIGNMENT.  Must be called before any task uses the pool.
+ */
+void vPoolInit( Pool_t * pxPool,
+                void * pvStorage,
+                size_t xBlockSize,
+                uint32_t ulBlockCount );
+
+/*
+ * Take a block, owned by the calling task.  Returns NULL if every block is in
+ * use.
+ */
+void * pvPoolAlloc( Pool_t * pxPool );
+
+/*
+ * Give a block back to the pool.  The caller must own it.
+ */
+void vPoolFree( Pool_t * pxPool,
+                void * pvBlock );
+
+#if ( poolDEBUG == 1 )
+
+/*
+ * Release ownership of a block that is about to be sent to another task,
+ * and take ownership of a block that was received.
+ */
+    void vPoolHandOff( Pool_t * pxPool,
+                       void * pvBlock );
+    void vPoolAccept( Pool_t * pxPool,
+                      void * pvBlock );
+
+#else
+
+    #define vPoolHandOff( pxPool, pvBlock )    do { ( void ) ( pxPool ); ( void ) ( pvBlock ); } while( 0 )
+    #define vPoolAccept( pxPool, pvBlock )     do { ( void ) ( pxPool ); ( void ) ( pvBlock ); } while( 0 )
+
+#endif /* poolDEBUG */
+
+#endif /* IPSA_POOL_H */
@@ -0,0 +1,245 @@
+/*
+ * Benchmark of passing payloads from one task to another by copying them
+ * through a queue against passing pointers to blocks of the pool in
+ * ipsa_pool.c.
+ *
+ * ipsa_pool_bench() is called from main() in place of ipsa_sched().  For each
+ * payload size from 64 bytes to 4 KB a producer and a consumer at the same
+ * priority run for benchRUN_TIME_MS in each mode:
+ *   copy - the producer fills a local payload and sends it by value through
+ *          a queue of benchQUEUE_LENGTH payloads, and the consumer receives
+ *          it into a local payload, so every payload is copied twice;
+ *   pool - the producer fills a block from the pool in place and sends its
+ *          pointer through a queue of benchQUEUE_LENGTH pointers, and the
+ *          consumer reads the block and frees it.
+ * In both modes the producer writes the whole payload and the consumer reads
+ * all of it, so only the copies differ.  The pool has a block for each queue
+ * slot plus one each for the producer and the consumer, so it cannot run out;
+ * the exhausted column checks that.  One CSV line is printed per size and
+ * mode.  Build with NDEBUG defined to measure the pool without its ownership
+ * checks.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+/* Kernel includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+
+/* Local includes. */
+#include "console.h"
+#include "ipsa_pool.h"
+
+#define benchCONTROL_TASK_PRIORITY    ( tskIDLE_PRIORITY + 2 )
+#define benchPAIR_TASK_PRIORITY       ( tskIDLE_PRIORITY + 1 )
+
+#define benchRUN_TIME_MS              pdMS_TO_TICKS( 1000UL )
+#define benchQUEUE_LENGTH             ( 8U )
+#define benchPOOL_BLOCKS              ( benchQUEUE_LENGTH + 2U )
+#define benchMAX_PAYLOAD              ( 4096U )
+
+/*-----------------------------------------------------------*/
+
+static void prvControlTask( void * pvParameters );
+static void prvCopyProducerTask( void * pvParameters );
+static void prvCopyConsumerTask( void * pvParameters );
+static void prvPoolProducerTask( void * pvParameters );
+static void prvPoolConsumerTask( void * pvParameters );
+
+/*
+ * Write, or read back, every byte of a payload.
+ */
+static void prvFill( uint8_t * pucPayload,
+                     uint32_t ulSequence );
+static uint32_t prvRead( const uint8_t * pucPayload );
+
+/*-----------------------------------------------------------*/
+
+static const size_t xPayloadSizes[] = { 64, 256, 1024, 4096 };
+
+/* Size of the payloads in the current run. */
+static size_t xPayloadSize;
+
+static QueueHandle_t xQueue;
+static Pool_t xPool;
+static uint8_t ucPoolStorage[ poolSTORAGE_SIZE( benchMAX_PAYLOAD, benchPOOL_BLOCKS ) ] __attribute__( ( aligned( poolALIGNMENT ) ) );
+
+static uint32_t ulReceived;
+
+/* Stops the compiler from dropping the reads. */
+static volatile uint32_t ulSink;
+
+/*-----------------------------------------------------------*/
+
+void ipsa_pool_bench( void )
+{
+    xTaskCreate( prvControlTask, "Bench", configMINIMAL_STACK_SIZE * 2, NULL, benchCONTROL_TASK_PRIORITY, NULL );
+
+    vTaskStartScheduler();
+
+    /* Only reached if there was not enough heap for the idle task. */
+    for( ; ; )
+    {
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvControlTask( void * pvParameters )
+{
+    TaskHandle_t xProducer, xConsumer;
+    BaseType_t xPooled;
+    size_t x;
+
+    ( void ) pvParameters;
+
+    console_print( "payload_bytes,mode,messages_per_s,mbytes_per_s,exhausted\n" );
+
+    for( x = 0; x < sizeof( xPayloadSizes ) / sizeof( xPayloadSizes[ 0 ] ); x++ )
+    {
+        xPayloadSize = xPayloadSizes[ x ];
+
+        for( xPooled = pdFALSE; xPooled <= pdTRUE; xPooled++ )
+        {
+            if( xPooled != pdFALSE )
+            {
+                vPoolInit( &xPool, ucPoolStorage, xPayloadSize, benchPOOL_BLOCKS );
+                xQueue = xQueueCreate( benchQUEUE_LENGTH, sizeof( uint8_t * ) );
+            }
+            else
+            {
+                xQueue = xQueueCreate( benchQUEUE_LENGTH, xPayloadSize );
+            }
+
+            if( xQueue == NULL )
+            {
+                console_print( "%lu: not enough heap\n", ( unsigned long ) xPayloadSize );
+                continue;
+            }
+
+            ulReceived = 0;
+
+            /* The copy tasks keep a payload on their stack. */
+            xTaskCreate( ( xPooled != pdFALSE ) ? prvPoolConsumerTask : prvCopyConsumerTask, "Consumer",
+                         configMINIMAL_STACK_SIZE + ( benchMAX_PAYLOAD / sizeof( StackType_t ) ), NULL, benchPAIR_TASK_PRIORITY, &xConsumer );
+            xTaskCreate( ( xPooled != pdFALSE ) ? prvPoolProducerTask : prvCopyProducerTask, "Producer",
+                         configMINIMAL_STACK_SIZE + ( benchMAX_PAYLOAD / sizeof( StackType_t ) ), NULL, benchPAIR_TASK_PRIORITY, &xProducer );
+
+            vTaskDelay( benchRUN_TIME_MS );
+
+            /* Stop both before reading the counters so they are stable. */
+            vTaskDelete( xProducer );
+            vTaskDelete( xConsumer );
+
+            console_print( "%lu,%s,%lu,%.1f,%lu\n",
+                           ( unsigned long ) xPayloadSize,
+                           ( xPooled != pdFALSE ) ? "pool" : "copy",
+                           ( unsigned long ) ( ( ( uint64_t ) ulReceived * configTICK_RATE_HZ ) / benchRUN_TIME_MS ),
+                           ( ( double ) ulReceived * ( double ) xPayloadSize * configTICK_RATE_HZ ) / ( ( double ) benchRUN_TIME_MS * 1e6 ),
+                           ( unsigned long ) ( ( xPooled != pdFALSE ) ? xPool.ulExhausted : 0U ) );
+
+            vQueueDelete( xQueue );
+
+            /* Give the idle task a chance to free the deleted tasks. */
+            vTaskDelay( pdMS_TO_TICKS( 100UL ) );
+        }
+    }
+
+    console_print( "Pool benchmark done\n" );
+    vTaskDelete( NULL );
+}
+/*-----------------------------------------------------------*/
+
+static void prvFill( uint8_t * pucPayload,
+                     uint32_t ulSequence )
+{
+    memset( pucPayload, ( int ) ( ulSequence & 0xffU ), xPayloadSize );
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t prvRead( const uint8_t * pucPayload )
+{
+    uint32_t ulSum = 0;
+    size_t x;
+
+    for( x = 0; x < xPayloadSize; x++ )
+    {
+        ulSum += pucPayload[ x ];
+    }
+
+    return ulSum;
+}
+/*-----------------------------------------------------------*/
+
+static void prvCopyProducerTask( void * pvParameters )
+{
+    uint8_t ucPayload[ benchMAX_PAYLOAD ];
+    uint32_t ulSequence;
+
+    ( void ) pvParameters;
+
+    for( ulSequence = 0; ; ulSequence++ )
+    {
+        prvFill( ucPayload, ulSequence );
+        ( void ) xQueueSend( xQueue, ucPayload, portMAX_DELAY );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvCopyConsumerTask( void * pvParameters )
+{
+    uint8_t ucPayload[ benchMAX_PAYLOAD ];
+
+    ( void ) pvParameters;
+
+    for( ; ; )
+    {
+        ( void ) xQueueReceive( xQueue, ucPayload, portMAX_DELAY );
+        ulSink = prvRead( ucPayload );
+        ulReceived++;
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvPoolProducerTask( void * pvParameters )
+{
+    uint8_t * pucBlock;
+    uint32_t ulSequence;
+
+    ( void ) pvParameters;
+
+    for( ulSequence = 0; ; ulSequence++ )
+    {
+        pucBlock = pvPoolAlloc( &xPool );
+
+        if( pucBlock == NULL )
+        {
+            /* Cannot happen with benchPOOL_BLOCKS blocks, but counted. */
+            taskYIELD();
+            continue;
+        }
+
+        prvFill( pucBlock, ulSequence );
+        vPoolHandOff( &xPool, pucBlock );
+        ( void ) xQueueSend( xQueue, &pucBlock, portMAX_DELAY );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvPoolConsumerTask( void * pvParameters )
+{
+    uint8_t * pucBlock;
+
+    ( void ) pvParameters;
+
+    for( ; ; )
+    {
+        ( void ) xQueueReceive( xQueue, &pucBlock, portMAX_DELAY );
+        vPoolAccept( &xPool, pucBlock );
+        ulSink = prvRead( pucBlock );
+        vPoolFree( &xPool, pucBlock );
+        ulReceived++;
+    }
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,201 @@
+/*
+ * Record and replay of the ipsa_sched events.  See ipsa_replay.h.
+ *
+ * The send task, the timer daemon and the receive tasks all record, so a slot
+ * is claimed by advancing the write index atomically.  Unlike the scheduler
+ * trace the recording is not a ring: a replay needs the run from its start,
+ * so once the array is full further records are dropped, not the oldest.
+ *
+ * Claiming a slot and filling it are two steps, and a writer can be
+ * preempted in between, so each slot also has a flag set once its record is
+ * complete.  The dump writes the records up to the first slot not yet
+ * complete and counts the rest as lost: a replay needs the events without a
+ * gap, and a torn record would be replayed as a real one.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+/* Local includes. */
+#include "ipsa_replay.h"
+
+/*-----------------------------------------------------------*/
+
+/* The recording of this run. */
+static ReplayRecord_t xRecords[ replayBUFFER_RECORDS ];
+static uint8_t ucCommitted[ replayBUFFER_RECORDS ];
+static uint64_t ullWriteIndex = 0;
+static volatile uint32_t ulRecordEnabled = 1;
+
+/* The events loaded for replay, and how far the replay task and the input
+ * reader have gone through them. */
+static ReplayRecord_t xLoaded[ replayBUFFER_RECORDS ];
+static size_t xLoadedCount = 0;
+static size_t xNextSource = 0;
+static size_t xNextInput = 0;
+
+/*-----------------------------------------------------------*/
+
+void vReplayRecord( const ReplayRecord_t * pxRecord )
+{
+    uint64_t ullSlot;
+
+    if( ulRecordEnabled == 0U )
+    {
+        return;
+    }
+
+    ullSlot = __atomic_fetch_add( &ullWriteIndex, 1U, __ATOMIC_RELAXED );
+
+    if( ullSlot < replayBUFFER_RECORDS )
+    {
+        xRecords[ ullSlot ] = *pxRecord;
+
+        /* Release, so a dump that sees the flag also sees the record. */
+        __atomic_store_n( &( ucCommitted[ ullSlot ] ), 1U, __ATOMIC_RELEASE );
+    }
+}
+/*-----------------------------------------------------------*/
+
+int iReplayDump( const char * pcPath,
+                 uint32_t ulTickRateHz )
+{
+    ReplayFileHeader_t xHeader;
+    uint64_t ullWritten, ullClaimed, ullComplete;
+    FILE * pxFile;
+    int iResult = 0;
+
+    /* Slots claimed after this are not dumped.  A writer that claimed one
+     * before it but has not finished copying its record is not waited for:
+     * its slot is not yet flagged, so it ends the dump. */
+    ulRecordEnabled = 0;
+    ullWritten = __atomic_load_n( &ullWriteIndex, __ATOMIC_ACQUIRE );
+    ullClaimed = ( ullWritten < replayBUFFER_RECORDS ) ? ullWritten : replayBUFFER_RECORDS;
+
+    for( ullComplete = 0; ullComplete < ullClaimed; ullComplete++ )
+    {
+        if( __atomic_load_n( &( ucCommitted[ ullComplete ] ), __ATOMIC_ACQUIRE ) == 0U )
+        {
+            break;
+        }
+    }
+
+    memset( &xHeader, 0, sizeof( xHeader ) );
+    memcpy( xHeader.cMagic, replayFILE_MAGIC, sizeof( xHeader.cMagic ) );
+    xHeader.ulRecordSize = sizeof( ReplayRecord_t );
+    xHeader.ulTickRateHz = ulTickRateHz;
+    xHeader.ullRecordCount = ullComplete;
+    xHeader.ullLostCount = ullWritten - ullComplete;
+
+    pxFile = fopen( pcPath, "wb" );
+
+    if( pxFile == NULL )
+    {
+        return -1;
+    }
+
+    if( ( fwrite( &xHeader, sizeof( xHeader ), 1, pxFile ) != 1 ) ||
+        ( fwrite( xRecords, sizeof( ReplayRecord_t ), ( size_t ) xHeader.ullRecordCount, pxFile ) != ( size_t ) xHeader.ullRecordCount ) )
+    {
+        iResult = -1;
+    }
+
+    if( fclose( pxFile ) != 0 )
+    {
+        iResult = -1;
+    }
+
+    return iResult;
+}
+/*-----------------------------------------------------------*/
+
+int iReplayLoad( const char * pcPath,
+                 uint32_t ulTickRateHz )
+{
+    ReplayFileHeader_t xHeader;
+    ReplayRecord_t xRecord;
+    uint64_t ullIndex;
+    FILE * pxFile;
+    int iResult = 0;
+
+    xLoadedCount = 0;
+    xNextSource = 0;
+    xNextInput = 0;
+
+    pxFile = fopen( pcPath, "rb" );
+
+    if( pxFile == NULL )
+    {
+        return -1;
+    }
+
+    if( ( fread( &xHeader, sizeof( xHeader ), 1, pxFile ) != 1 ) ||
+        ( memcmp( xHeader.cMagic, replayFILE_MAGIC, sizeof( xHeader.cMagic ) ) != 0 ) ||
+        ( xHeader.ulRecordSize != sizeof( ReplayRecord_t ) ) ||
+        ( xHeader.ulTickRateHz != ulTickRateHz ) )
+    {
+        iResult = -1;
+    }
+
+    /* Only the input of the recorded run is kept; what it received is for
+     * replay_diff.c. */
+    for( ullIndex = 0; ( iResult == 0 ) && ( ullIndex < xHeader.ullRecordCount ); ullIndex++ )
+    {
+        if( fread( &xRecord, sizeof( xRecord ), 1, pxFile ) != 1 )
+        {
+            iResult = -1;
+        }
+        else if( ( xRecord.ucEvent != replayEVENT_RECEIVE ) && ( xLoadedCount < replayBUFFER_RECORDS ) )
+        {
+            xLoaded[ xLoadedCount ] = xRecord;
+            xLoadedCount++;
+        }
+    }
+
+    ( void ) fclose( pxFile );
+
+    if( iResult != 0 )
+    {
+        xLoadedCount = 0;
+    }
+
+    return iResult;
+}
+/*-----------------------------------------------------------*/
+
+const ReplayRecord_t * pxReplayNextSource( void )
+{
+    while( xNextSource < xLoadedCount )
+    {
+        const ReplayRecord_t * pxRecord = &( xLoaded[ xNextSource ] );
+
+        xNextSource++;
+
+        if( ( pxRecord->ucEvent == replayEVENT_SEND ) || ( pxRecord->ucEvent == replayEVENT_TIMER ) )
+        {
+            return pxRecord;
+        }
+    }
+
+    return NULL;
+}
+/*-----------------------------------------------------------*/
+
+int iReplayNextInput( uint32_t * pulInput )
+{
+    while( xNextInput < xLoadedCount )
+    {
+        const ReplayRecord_t * pxRecord = &( xLoaded[ xNextInput ] );
+
+        xNextInput++;
+
+        if( pxRecord->ucEvent == replayEVENT_INPUT )
+        {
+            *pulInput = pxRecord->ulValue;
+            return 1;
+        }
+    }
+
+    return 0;
+}
+/*-----------------------------------------------------------*/
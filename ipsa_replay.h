@@ -0,0 +1,103 @@
+/*
+ * Record and replay of the events that drive the ipsa_sched demo.
+ *
+ * What the receive tasks do in a run depends on live timing: when the send
+ * task and the software timer are released, which receive task wins each
+ * value, and what rand() gives Task 2.  The recorder keeps, in a preallocated
+ * array of fixed size 24 byte records stamped with the tick count, every
+ * value sent (and whether it was dropped), every timer expiry, every
+ * workload input and every value received, with the latencies the receive
+ * task measured for it.  iReplayDump() writes the recording to a binary
+ * file.
+ *
+ * iReplayLoad() reads the sends, timer expiries and inputs of such a file
+ * back, and the demo's replay task then makes the same sends at the same
+ * ticks while Task 2 takes the same inputs, so two builds can be measured on
+ * identical input.  replay_diff.c matches the received values of two
+ * recordings by send number and prints the latency differences per event
+ * and per task.
+ *
+ * Nothing here calls the kernel: the caller supplies the tick stamps.
+ */
+
+#ifndef IPSA_REPLAY_H
+#define IPSA_REPLAY_H
+
+#include <stdint.h>
+
+/* Most records one run can record, or load for replay. */
+#ifndef replayBUFFER_RECORDS
+    #define replayBUFFER_RECORDS    ( 65536U )
+#endif
+
+#define replayFILE_MAGIC            "IPSARPL1"
+
+/* Record types.  The first three are the input of a run, the last its
+ * outcome. */
+#define replayEVENT_SEND            ( 1U )
+#define replayEVENT_TIMER           ( 2U )
+#define replayEVENT_INPUT           ( 3U )
+#define replayEVENT_RECEIVE         ( 4U )
+
+/* Flags. */
+#define replayFLAG_DROPPED          ( 1U << 0 ) /* The send failed. */
+
+typedef struct ReplayRecord
+{
+    uint32_t ulTick;              /* Tick count when the event happened. */
+    uint8_t ucEvent;              /* One of replayEVENT_*. */
+    uint8_t ucTask;               /* Receive task index for receive and input events, otherwise 0. */
+    uint16_t usFlags;             /* replayFLAG_* for send events, otherwise 0. */
+    uint32_t ulSequence;          /* Send number, or input number for input events. */
+    uint32_t ulValue;             /* The value sent or received, or the input. */
+    uint32_t ulReleaseToStartNs;  /* Receive events: the receive task's latencies, */
+    uint32_t ulStartToFinishNs;   /* saturated at UINT32_MAX. */
+} ReplayRecord_t;
+
+/* The file is a ReplayFileHeader_t then ullRecordCount ReplayRecord_t, in the
+ * order they were recorded, all in host byte order. */
+typedef struct ReplayFileHeader
+{
+    char cMagic[ 8 ];
+    uint32_t ulRecordSize;
+    uint32_t ulTickRateHz;
+    uint64_t ullRecordCount;
+    uint64_t ullLostCount;        /* Records that did not fit, or were not
+                                   * complete when the dump was taken. */
+} ReplayFileHeader_t;
+
+/*
+ * Add a record.  Once replayBUFFER_RECORDS are held, or after iReplayDump(),
+ * records are only counted as lost.
+ */
+void vReplayRecord( const ReplayRecord_t * pxRecord );
+
+/*
+ * Stop recording and write the recording to pcPath.  Only the records up to
+ * the first one still being written are kept.  Returns 0 on success.  Makes
+ * Linux system calls, so call it from a task that can afford them.
+ */
+int iReplayDump( const char * pcPath,
+                 uint32_t ulTickRateHz );
+
+/*
+ * Load the send, timer and input events of the recording at pcPath for
+ * replay, and check it was made at ulTickRateHz.  Returns 0 on success.
+ * Call it before the scheduler starts.
+ */
+int iReplayLoad( const char * pcPath,
+                 uint32_t ulTickRateHz );
+
+/*
+ * The next send or timer event loaded, in recorded order, or NULL once they
+ * have all been taken.  For one task only.
+ */
+const ReplayRecord_t * pxReplayNextSource( void );
+
+/*
+ * Write the next input loaded to pulInput and return 1, or return 0 once they
+ * have all been taken.  For one task only.
+ */
+int iReplayNextInput( uint32_t * pulInput );
+
+#endif /* IPSA_REPLAY_H */
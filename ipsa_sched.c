@@ -49,7 +49,7 @@
  *
  * The Queue Send Task:
  * The queue send task is implemented by the prvQueueSendTask() function in
- * this file.  It uses vTaskDelayUntil() to create a periodic task that sends
+ * this file.  It uses xPeriodicWait() to create a periodic task that sends
  * the value 100 to the queue every 200 milliseconds (please read the notes
  * above regarding the accuracy of timing under Linux).
  *
@@ -58,12 +58,223 @@
  * callback function writes the value 200 to the queue.  The callback function
  * is implemented by prvQueueSendTimerCallback() within this file.
  *
- * The Queue Receive Task:
- * The queue receive task is implemented by the prvQueueReceiveTask() function
- * in this file.  prvQueueReceiveTask() waits for data to arrive on the queue.
- * When data is received, the task checks the value of the data, then outputs a
- * message to indicate if the data came from the queue send task or the queue
- * send software timer.
+ * The Queue Receive Tasks:
+ * All receive tasks run the same function, prvQueueReceiveTask(), and are
+ * created from the xReceiveTasks[] table in this file.  Each table entry is a
+ * ReceiveTaskDescriptor_t giving the task's name, priority, period, stack
+ * size and workload, and is passed to the task as its parameter.  A task with
+ * a period of zero waits for data to arrive on the queue.  When data is
+ * received, the task checks the value of the data: a value from the queue
+ * send task makes it report that it is working, a value from the queue send
+ * software timer makes it run its workload.  Once woken, a task handles
+ * every value already waiting before it blocks again, so a burst costs one
+ * wake up rather than one per value.  A task with a non-zero period does not
+ * use the queue and runs its workload once per period instead.
+ *
+ * Deferred Logging:
+ * Setting mainUSE_DEFERRED_LOG to 1 stops the tasks calling console_print()
+ * directly.  mainPRINT() then records the format string and the arguments in
+ * the lock-free ring in ipsa_log.c, without formatting them or making a system
+ * call, and the low priority "Log" task formats and writes the records in
+ * batches every mainLOG_DRAIN_PERIOD_MS.  Records that do not fit in the ring
+ * are counted and reported by the drain task.  log_bench.c compares the time
+ * spent in a task for both paths.
+ *
+ * Latency Histograms:
+ * Every message carries the time at which its sender was released - the send
+ * task waking from xPeriodicWait(), or the timer callback starting.  Each
+ * receive task records, in the fixed size histograms from ipsa_hist.c, the
+ * time from that release to the task starting to handle the message and the
+ * time it then takes to handle it.  ipsa_sched_print_latency() prints the
+ * p50, p99, p99.9 and maximum of each, and is also called every
+ * mainLATENCY_REPORT_PERIOD_MS when that is not zero.
+ *
+ * Deadline Monitoring:
+ * The send task and the periodic receive tasks wait for their releases with
+ * xPeriodicWait() from ipsa_periodic.c rather than vTaskDelayUntil(), which
+ * returns at once when a release has already passed and says nothing about
+ * it.  Each of these tasks counts the releases it started late, the releases
+ * dropped because the previous job overran, and the sends that failed
+ * because the queue was full.  mainOVERRUN_POLICY selects what happens after
+ * an overrun: skip the passed releases, run them back to back, or halve the
+ * task's rate until it keeps up again.  ipsa_sched_print_latency() prints the
+ * counters after the latency percentiles, with the number of periodic tasks
+ * that did not fit in the registry, whose counters are missing, and the sends
+ * the timer callback could not make.
+ *
+ * Scheduler Trace:
+ * When ipsa_trace.h is hooked into FreeRTOSConfig.h (see that file) the kernel
+ * records every task switch, queue operation and timer expiry.  The "Trace"
+ * task writes the capture to mainTRACE_FILE mainTRACE_CAPTURE_MS after start
+ * up; trace2json.c turns it into a timeline for chrome://tracing or Perfetto.
+ *
+ * Virtual Time and Tickless Idle:
+ * When ipsa_tickless.h is hooked into FreeRTOSConfig.h with ipsaVIRTUAL_TIME
+ * set (see that file), idle periods are skipped instead of waited out, so the
+ * demo runs through the same sequence of releases at the same tick counts,
+ * only much faster.  With ipsaTICKLESS_IDLE set instead, idle periods are
+ * waited out in one sleep rather than one signal per tick, which is what a
+ * demo that is idle almost all the time should cost the host.  Setting
+ * mainRUN_FOR_MS makes the "Horizon" task stop the scheduler after that many
+ * milliseconds of tick time and report the wall clock time it took, which
+ * makes long soak runs practical, and the host CPU time and context switches
+ * per second of the whole process.  Building the same run with and without
+ * ipsaTICKLESS_IDLE compares the tickless and ticking costs.
+ *
+ * Stress Mode:
+ * Setting mainSTRESS_TASK_COUNT above zero adds a scaling benchmark.  The
+ * "Scale" task adds periodic tasks to the running system in steps of
+ * mainSTRESS_TASK_STEP, all built from one descriptor, and after each step
+ * prints the heap consumed and the throughput of a background task running
+ * at the idle priority.  The drop in background throughput relative to the
+ * run with no stress tasks is the cost of the extra context switches.  Each
+ * stress task registers its deadline counters, so periodicMAX_TASKS must be
+ * raised, for ipsa_periodic.c as well, to at least mainSTRESS_TASK_COUNT
+ * plus the send task and Task 2; the build stops if it is not.
+ *
+ * Load Sweep:
+ * Setting mainLOAD_SWEEP to 1 measures the ceiling of the queue path.  The
+ * "Load" task builds a separate pipeline - a source task at a higher
+ * priority than mainLOAD_SINK_TASKS sink tasks, as the send task is above
+ * the receive tasks - for each queue length in uxLoadQueueLengths[], and
+ * raises the source's rate from 1 Hz, ten times then twice per step, until
+ * more than mainLOAD_DROP_LIMIT_PCT percent of the values are dropped.
+ * Above the tick rate the source sends a burst each tick.  The sinks drain
+ * the queue per wake up as the receive tasks do.  Each step prints the
+ * messages per second sent and received, the drop rate, the messages per
+ * wake up and the CPU time per message, taken from the throughput lost by a
+ * background task at the idle priority.
+ *
+ * Notification Release Mode:
+ * A queue copies each value in and out under a lock, although the values only
+ * say which of the two senders released the receive task.  Setting
+ * mainUSE_NOTIFY_RELEASE to 1 releases the receive tasks with direct to task
+ * notifications instead, which avoid the copies and the lock;
+ * ipsa_ipc_bench.c measures whether that makes them cheaper on a given
+ * target.  Each release still goes to exactly one receive task, a bit in the
+ * notification value says which sender it came from, and the release time is
+ * left in a slot belonging to that task.  This mode changes which task gets
+ * each release, and what happens when the receive tasks fall behind:
+ * - a release goes to the lowest numbered receive task blocked waiting, where
+ *   the queue wakes the one that has waited longest;
+ * - with none blocked, the tasks take turns, and the release waits for that
+ *   task even if another becomes free first, where a queued value goes to
+ *   whichever task asks next;
+ * - a release that finds the same bit still set merges with it and is
+ *   counted in ulReleasesMerged, where the queue holds mainQUEUE_LENGTH
+ *   values before it fails a send.
+ * Not available with mainUSE_BROADCAST, which uses the notifications itself.
+ *
+ * Broadcast Mode:
+ * By default the four receive tasks compete for the values on one queue, so
+ * each value reaches a single, arbitrary, receive task.  Setting
+ * mainUSE_BROADCAST to 1 replaces the queue with the broadcast channel in
+ * ipsa_broadcast.c: every value published by the send task or the software
+ * timer is delivered to all four receive tasks, each through its own read
+ * index, and values a slow receiver misses are counted rather than silently
+ * lost.  ipsa_broadcast_bench.c measures the fan-out cost.
+ *
+ * Priority Bus Mode:
+ * The send task and the software timer share one FIFO queue, so a timer value
+ * waits behind any task values already queued, and is dropped if they filled
+ * the queue.  Setting mainUSE_PRIORITY_BUS to 1 replaces the queue with the
+ * two lane bus in ipsa_bus.c: the timer sends on the urgent lane, the send
+ * task on the normal lane, each lane has its own capacity, and a receive
+ * task always takes an urgent value first.  The values sent and dropped per
+ * lane are printed with the latency report.  ipsa_bus_bench.c measures the
+ * urgent lane latency with the normal lane saturated.  Not available with
+ * mainUSE_BROADCAST or mainUSE_NOTIFY_RELEASE.
+ *
+ * Sensor Frame Mode:
+ * By default Task 2 converts a single random Fahrenheit reading, in double
+ * precision, each time the timer value arrives.  Setting
+ * mainUSE_SENSOR_FRAMES to 1 adds a "Sensor" task that fills a frame of
+ * sensorFRAME_SAMPLES readings every mainSENSOR_FRAME_PERIOD_MS in a block
+ * taken from the lock free pool in ipsa_pool.c, and hands Task 2 only the
+ * pointer, through a queue; Task 2 gives the block back once the frame is
+ * converted, so a frame is never copied.  Task 2 then runs at the same period
+ * and converts each whole frame with the block kernel in ipsa_sensor.c (SIMD,
+ * or fixed point when ipsaSENSOR_FIXED_POINT is set for targets without an
+ * FPU), keeps the rolling minimum, maximum and mean over the last
+ * sensorWINDOW_FRAMES frames, and prints them once per window.  Frames the
+ * producer could not hand over are counted.  sensor_bench.c compares the
+ * throughput of both paths.
+ *
+ * Static Allocation:
+ * By default every task, queue and the timer are allocated from the FreeRTOS
+ * heap.  Setting mainUSE_STATIC_ALLOCATION to 1 creates them with the
+ * *Static() API instead, from one arena whose size is worked out at compile
+ * time from the tasks and queues the selected modes create, so nothing
+ * created by ipsa_sched() can fail for lack of heap at run time.  (The idle
+ * and timer task memory comes from the hooks in main.c, and the stress
+ * benchmark still creates its tasks on the heap, as that is what it
+ * measures.)  In both builds the "Startup" task, the first application task
+ * to run, prints the RAM taken by what ipsa_sched() created and the time from
+ * entering ipsa_sched() to the scheduler running it.
+ *
+ * Stack Monitor:
+ * Setting mainSTACK_MONITOR_PERIOD_MS above zero adds the low priority
+ * "Stack" task.  Every period it reads the stack high water mark of each task
+ * created by ipsa_sched(), and of the idle and timer tasks, and prints one
+ * line per task with its stack size, the most of it ever used, and a
+ * suggested size: the use seen so far plus mainSTACK_MARGIN_PERCENT, rounded
+ * up.  A task whose free stack has ever dropped below
+ * mainSTACK_WARNING_PERCENT of its size gets a warning counted against it.
+ * A last line gives the free heap and the minimum it has ever been.  The
+ * suggestions are only as good as the run: leave the demo running through
+ * every path (key presses, timer expiries) before trusting them.
+ *
+ * CPU Statistics:
+ * Setting mainCPU_STATS_PERIOD_MS above zero adds the "CPU" task, which needs
+ * the run time stats counter from ipsa_clock.h (see that file).  Every period
+ * it copies the state of every task into a preallocated array with
+ * uxTaskGetSystemState(), compares each task's run time with the previous
+ * copy, and prints one line:
+ *
+ *     cpu,<uptime_ms>,<interval_us>,<cost_us>,<task>:<permille>,...
+ *
+ * with the share of the interval each task ran for, in thousandths, the idle
+ * and timer tasks included.  cost_us is the time the task took to take the
+ * copy and build the line, which is bounded by mainCPU_STATS_MAX_TASKS; the
+ * line itself is built in a fixed buffer, so nothing is allocated.
+ *
+ * Analyzed Priorities:
+ * By default the four receive tasks share the idle priority and the send task
+ * runs one above.  sched_analyze.c is a host tool that takes the timing model
+ * of the tasks in ipsa_tasks.h and the execution times measured by
+ * wcet_bench.c, assigns rate monotonic or deadline monotonic priorities,
+ * checks with response time analysis that every task meets its deadline, and
+ * writes the priorities to ipsa_priorities.h.  Setting
+ * mainUSE_ANALYZED_PRIORITIES to 1 creates the send and receive tasks at
+ * those priorities; the build stops if the analysis found the set not
+ * schedulable.  The receive tasks then have different priorities, so on the
+ * shared queue the highest priority one, always ready before the others,
+ * would take every value and the rest would never run.  This mode therefore
+ * turns on broadcast mode, where every value from the send task and the
+ * timer releases each receive task through its own notification, which is
+ * what ipsa_tasks.h models; it cannot be combined with the queue, the
+ * priority bus or notification release.  A log of a run with
+ * mainCPU_STATS_PERIOD_MS set can be given back to sched_analyze.c to check
+ * the model against the measured utilization.
+ *
+ * Record and Replay:
+ * Two runs are rarely comparable: the sends and timer expiries fall at
+ * slightly different times, a different receive task wins each value, and
+ * Task 2 converts different random readings.  Setting mainUSE_RECORD to 1
+ * records, with ipsa_replay.c, every value sent or dropped, every timer
+ * expiry, every Task 2 input and every value received with its two
+ * latencies, each stamped with the tick count, and the low priority "Record"
+ * task writes the recording to mainRECORD_FILE mainRECORD_CAPTURE_MS after
+ * start up.  Setting mainUSE_REPLAY to 1 as well loads mainREPLAY_FILE, a
+ * recording renamed, before the scheduler starts.  The send task and the
+ * timer are then replaced by the "Replay" task, which makes the recorded
+ * sends at the recorded ticks, and Task 2 takes the recorded inputs.  Which
+ * receive task wins each value is still decided live.  replay_diff.c takes
+ * two recordings, such as the replay runs of two builds on the same input,
+ * matches the values received by send number, and prints the latency
+ * differences per event and per task.  Not available with
+ * mainUSE_NOTIFY_RELEASE, whose releases carry no send number, and replay
+ * not with mainUSE_SENSOR_FRAMES, whose readings are not recorded.
  *
  * Expected Behaviour:
  * - The queue send task writes to the queue every 200ms, so every 200ms the
@@ -83,6 +294,7 @@
 #include <stdio.h>
 #include <pthread.h>
 #include <stdlib.h>
+#include <sys/resource.h>
 
 /* Kernel includes. */
 #include "FreeRTOS.h"
@@ -92,36 +304,392 @@
 
 /* Local includes. */
 #include "console.h"
+#include "ipsa_broadcast.h"
+#include "ipsa_bus.h"
+#include "ipsa_clock.h"
+#include "ipsa_hist.h"
+#include "ipsa_log.h"
+#include "ipsa_message.h"
+#include "ipsa_periodic.h"
+#include "ipsa_pool.h"
+#include "ipsa_replay.h"
+#include "ipsa_sensor.h"
+#include "ipsa_tickless.h"
+#include "ipsa_trace.h"
+#include "ipsa_workloads.h"
+
+#if ( defined( ipsaTRACE_ENABLED ) && ( ipsaTRACE_ENABLED == 1 ) )
+    #define mainUSE_TRACE                      1
+#else
+    #define mainUSE_TRACE                      0
+#endif
+
+/* Set to 1 to take the priorities of the send and receive tasks from the
+ * schedulability analysis, see the comments at the top of this file. */
+#ifndef mainUSE_ANALYZED_PRIORITIES
+    #define mainUSE_ANALYZED_PRIORITIES        0
+#endif
+
+/* Set to 1 to deliver every value to every receive task, see the comments at
+ * the top of this file.  The analyzed priorities need it. */
+#ifndef mainUSE_BROADCAST
+    #define mainUSE_BROADCAST                  mainUSE_ANALYZED_PRIORITIES
+#endif
+
+#if ( ( mainUSE_ANALYZED_PRIORITIES == 1 ) && ( mainUSE_BROADCAST == 0 ) )
+    #error mainUSE_ANALYZED_PRIORITIES needs mainUSE_BROADCAST, on a shared queue the highest priority receive task takes every value
+#endif
+
+/* Set to 1 to release the receive tasks with task notifications, see the
+ * comments at the top of this file. */
+#ifndef mainUSE_NOTIFY_RELEASE
+    #define mainUSE_NOTIFY_RELEASE             0
+#endif
+
+#if ( ( mainUSE_NOTIFY_RELEASE == 1 ) && ( mainUSE_BROADCAST == 1 ) )
+    #error mainUSE_NOTIFY_RELEASE cannot be combined with mainUSE_BROADCAST
+#endif
+
+/* Set to 1 to send the timer values on their own lane, see the comments at
+ * the top of this file. */
+#ifndef mainUSE_PRIORITY_BUS
+    #define mainUSE_PRIORITY_BUS               0
+#endif
+
+#if ( ( mainUSE_PRIORITY_BUS == 1 ) && ( ( mainUSE_BROADCAST == 1 ) || ( mainUSE_NOTIFY_RELEASE == 1 ) ) )
+    #error mainUSE_PRIORITY_BUS cannot be combined with mainUSE_BROADCAST or mainUSE_NOTIFY_RELEASE
+#endif
+
+/* Notification bits for the two senders, and the most receive tasks that
+ * can be released by notification. */
+#define mainRELEASE_BIT_TASK                   ( 1UL << 0 )
+#define mainRELEASE_BIT_TIMER                  ( 1UL << 1 )
+#define mainMAX_RELEASE_TARGETS                ( 4 )
+
+/* Set to 1 to format console output in a separate task, see the comments at
+ * the top of this file. */
+#ifndef mainUSE_DEFERRED_LOG
+    #define mainUSE_DEFERRED_LOG               0
+#endif
+
+#if ( mainUSE_DEFERRED_LOG == 1 )
+    #define mainPRINT( ... )                   vLogPrint( __VA_ARGS__ )
+#else
+    #define mainPRINT( ... )                   console_print( __VA_ARGS__ )
+#endif
 
 /* Priorities at which the tasks are created. */
-#define mainQUEUE_RECEIVE_TASK_PRIORITY1    ( tskIDLE_PRIORITY  )
-#define mainQUEUE_RECEIVE_TASK_PRIORITY2    ( tskIDLE_PRIORITY  )
-#define mainQUEUE_RECEIVE_TASK_PRIORITY3    ( tskIDLE_PRIORITY  )
-#define mainQUEUE_RECEIVE_TASK_PRIORITY4   ( tskIDLE_PRIORITY  )
-#define mainQUEUE_SEND_TASK_PRIORITY       ( tskIDLE_PRIORITY + 1 )
+#if ( mainUSE_ANALYZED_PRIORITIES == 1 )
+    #include "ipsa_priorities.h"
+    #define mainQUEUE_RECEIVE_TASK_PRIORITY1    priorityTASK_1
+    #define mainQUEUE_RECEIVE_TASK_PRIORITY2    priorityTASK_2
+    #define mainQUEUE_RECEIVE_TASK_PRIORITY3    priorityTASK_3
+    #define mainQUEUE_RECEIVE_TASK_PRIORITY4    priorityTASK_4
+    #define mainQUEUE_SEND_TASK_PRIORITY        priorityTX
+#else
+    #define mainQUEUE_RECEIVE_TASK_PRIORITY1    ( tskIDLE_PRIORITY  )
+    #define mainQUEUE_RECEIVE_TASK_PRIORITY2    ( tskIDLE_PRIORITY  )
+    #define mainQUEUE_RECEIVE_TASK_PRIORITY3    ( tskIDLE_PRIORITY  )
+    #define mainQUEUE_RECEIVE_TASK_PRIORITY4    ( tskIDLE_PRIORITY  )
+    #define mainQUEUE_SEND_TASK_PRIORITY        ( tskIDLE_PRIORITY + 1 )
+#endif
 
 /* The rate at which data is sent to the queue.  The times are converted from
  * milliseconds to ticks using the pdMS_TO_TICKS() macro. */
 #define mainTASK_SEND_FREQUENCY_MS         pdMS_TO_TICKS( 1000UL )
 #define mainTIMER_SEND_FREQUENCY_MS        pdMS_TO_TICKS( 2000UL )
 
+/* What the periodic tasks do when a job overruns its period - ePeriodicSkip,
+ * ePeriodicCatchUp or ePeriodicDegrade, see ipsa_periodic.h. */
+#ifndef mainOVERRUN_POLICY
+    #define mainOVERRUN_POLICY             ePeriodicSkip
+#endif
+
 /* The number of items the queue can hold at once. */
 #define mainQUEUE_LENGTH                   ( 2 )
 
+/* The number of items each lane of the priority bus can hold at once. */
+#define mainBUS_URGENT_LENGTH              ( 2 )
+#define mainBUS_NORMAL_LENGTH              mainQUEUE_LENGTH
+
 /* The values sent to the queue receive task from the queue send task and the
  * queue send software timer respectively. */
 #define mainVALUE_SENT_FROM_TASK           ( 100UL )
 #define mainVALUE_SENT_FROM_TIMER          ( 200UL )
 
+/* Total number of periodic tasks added by the stress benchmark, and how many
+ * are added between two measurements.  0 disables the benchmark. */
+#ifndef mainSTRESS_TASK_COUNT
+    #define mainSTRESS_TASK_COUNT          ( 0 )
+#endif
+#define mainSTRESS_TASK_STEP               ( 25 )
+#define mainSTRESS_TASK_PRIORITY           ( tskIDLE_PRIORITY + 1 )
+#define mainSTRESS_TASK_PERIOD_MS          pdMS_TO_TICKS( 10UL )
+#define mainSCALE_TASK_PRIORITY            ( configMAX_PRIORITIES - 1 )
+#define mainSCALE_MEASURE_TIME_MS          pdMS_TO_TICKS( 2000UL )
+
+/* The send task, Task 2 and every stress task are periodic, and the deadline
+ * counters of all of them must fit in the registry in ipsa_periodic.c. */
+#define mainPERIODIC_TASKS                 ( 2 + mainSTRESS_TASK_COUNT )
+
+#if ( mainPERIODIC_TASKS > periodicMAX_TASKS )
+    #error periodicMAX_TASKS must be at least mainSTRESS_TASK_COUNT + 2, set it for ipsa_periodic.c too
+#endif
+
+/* Set to 1 to run the load sweep, see the comments at the top of this file.
+ * The background task it measures must not compete with stress tasks. */
+#ifndef mainLOAD_SWEEP
+    #define mainLOAD_SWEEP                 0
+#endif
+
+#if ( ( mainLOAD_SWEEP == 1 ) && ( mainSTRESS_TASK_COUNT > 0 ) )
+    #error mainLOAD_SWEEP cannot be combined with mainSTRESS_TASK_COUNT
+#endif
+
+#define mainLOAD_TASK_PRIORITY             ( configMAX_PRIORITIES - 1 )
+#define mainLOAD_SOURCE_PRIORITY           ( tskIDLE_PRIORITY + 2 )
+#define mainLOAD_SINK_PRIORITY             ( tskIDLE_PRIORITY + 1 )
+#define mainLOAD_SINK_TASKS                ( 3 )
+#define mainLOAD_STEP_TIME_MS              pdMS_TO_TICKS( 2000UL )
+#define mainLOAD_MAX_RATE                  ( 1000000UL )
+#define mainLOAD_DROP_LIMIT_PCT            ( 1.0 )
+
+/* How often the deferred log is written out, and the most text written at
+ * once. */
+#define mainLOG_DRAIN_TASK_PRIORITY        ( tskIDLE_PRIORITY )
+#define mainLOG_DRAIN_PERIOD_MS            pdMS_TO_TICKS( 50UL )
+#define mainLOG_DRAIN_BUFFER_SIZE          ( 2048 )
+
+/* How often the latency histograms are printed.  0 to only print them when
+ * ipsa_sched_print_latency() is called. */
+#ifndef mainLATENCY_REPORT_PERIOD_MS
+    #define mainLATENCY_REPORT_PERIOD_MS   ( 0 )
+#endif
+#define mainLATENCY_REPORT_TASK_PRIORITY   ( tskIDLE_PRIORITY )
+
+/* How long the scheduler trace runs before it is written out, and where to. */
+#define mainTRACE_CAPTURE_MS               pdMS_TO_TICKS( 10000UL )
+#define mainTRACE_FILE                     "ipsa_trace.bin"
+#define mainTRACE_TASK_PRIORITY            ( tskIDLE_PRIORITY )
+
+/* Set to 1 to convert temperatures a frame at a time, see the comments at the
+ * top of this file. */
+#ifndef mainUSE_SENSOR_FRAMES
+    #define mainUSE_SENSOR_FRAMES          0
+#endif
+#define mainSENSOR_TASK_PRIORITY           ( tskIDLE_PRIORITY + 1 )
+#define mainSENSOR_FRAME_PERIOD_MS         pdMS_TO_TICKS( 100UL )
+#define mainSENSOR_FRAME_COUNT             ( 4 )
+
+/* Task 2 is released by the queue, or once per frame in sensor frame mode. */
+#if ( mainUSE_SENSOR_FRAMES == 1 )
+    #define mainTEMPERATURE_TASK_PERIOD    mainSENSOR_FRAME_PERIOD_MS
+#else
+    #define mainTEMPERATURE_TASK_PERIOD    ( 0 )
+#endif
+
+/* Set to 1 to record the events of the run, and mainUSE_REPLAY as well to
+ * drive it from an earlier recording, see the comments at the top of this
+ * file.  A replay is always recorded too. */
+#ifndef mainUSE_RECORD
+    #define mainUSE_RECORD                 0
+#endif
+#ifndef mainUSE_REPLAY
+    #define mainUSE_REPLAY                 0
+#endif
+
+#if ( ( mainUSE_RECORD == 1 ) || ( mainUSE_REPLAY == 1 ) )
+    #define mainRECORD_EVENTS              1
+#else
+    #define mainRECORD_EVENTS              0
+#endif
+
+#if ( ( mainRECORD_EVENTS == 1 ) && ( mainUSE_NOTIFY_RELEASE == 1 ) )
+    #error mainUSE_RECORD and mainUSE_REPLAY cannot be combined with mainUSE_NOTIFY_RELEASE
+#endif
+
+#if ( ( mainUSE_REPLAY == 1 ) && ( mainUSE_SENSOR_FRAMES == 1 ) )
+    #error mainUSE_REPLAY cannot be combined with mainUSE_SENSOR_FRAMES
+#endif
+
+/* How long the recording runs before it is written out, where to, and the
+ * recording a replay is driven from.  The replay task runs at the top
+ * priority so the sends are made on the recorded ticks. */
+#define mainRECORD_CAPTURE_MS              pdMS_TO_TICKS( 10000UL )
+#define mainRECORD_FILE                    "ipsa_record.bin"
+#define mainREPLAY_FILE                    "ipsa_replay.bin"
+#define mainRECORD_TASK_PRIORITY           ( tskIDLE_PRIORITY )
+#define mainREPLAY_TASK_PRIORITY           ( configMAX_PRIORITIES - 1 )
+
+/* Latencies are recorded in 32 bits, which holds just over four seconds. */
+#define mainSATURATE_32( x )               ( ( ( x ) > UINT32_MAX ) ? UINT32_MAX : ( uint32_t ) ( x ) )
+
+/* How often the stack monitor reports, 0 to leave it out.  See the comments at
+ * the top of this file. */
+#ifndef mainSTACK_MONITOR_PERIOD_MS
+    #define mainSTACK_MONITOR_PERIOD_MS    ( 0 )
+#endif
+#define mainSTACK_MONITOR_TASK_PRIORITY    ( tskIDLE_PRIORITY )
+#define mainSTACK_MONITOR_MAX_TASKS        ( 24 )
+#define mainSTACK_MARGIN_PERCENT           ( 25 )
+#define mainSTACK_WARNING_PERCENT          ( 10 )
+#define mainSTACK_ROUNDING_WORDS           ( 16 )
+
+#if ( ( mainSTACK_MONITOR_PERIOD_MS > 0 ) && ( INCLUDE_uxTaskGetStackHighWaterMark != 1 ) )
+    #error The stack monitor needs INCLUDE_uxTaskGetStackHighWaterMark set to 1
+#endif
+
+/* How often the CPU statistics are printed, 0 to leave them out.  See the
+ * comments at the top of this file. */
+#ifndef mainCPU_STATS_PERIOD_MS
+    #define mainCPU_STATS_PERIOD_MS        ( 0 )
+#endif
+#define mainCPU_STATS_TASK_PRIORITY        ( configMAX_PRIORITIES - 1 )
+#define mainCPU_STATS_MAX_TASKS            ( 32 )
+#define mainCPU_STATS_LINE_SIZE            ( 64 + ( mainCPU_STATS_MAX_TASKS * ( configMAX_TASK_NAME_LEN + 8 ) ) )
+
+#if ( ( mainCPU_STATS_PERIOD_MS > 0 ) && ( ( configGENERATE_RUN_TIME_STATS != 1 ) || ( configUSE_TRACE_FACILITY != 1 ) ) )
+    #error The CPU statistics need configGENERATE_RUN_TIME_STATS and configUSE_TRACE_FACILITY set to 1
+#endif
+
+/* Set to 1 to allocate every object from a static arena, see the comments at
+ * the top of this file. */
+#ifndef mainUSE_STATIC_ALLOCATION
+    #define mainUSE_STATIC_ALLOCATION      0
+#endif
+#define mainSTARTUP_TASK_PRIORITY          ( configMAX_PRIORITIES - 1 )
+
+#if ( ( mainUSE_STATIC_ALLOCATION == 1 ) && ( configSUPPORT_STATIC_ALLOCATION != 1 ) )
+    #error mainUSE_STATIC_ALLOCATION needs configSUPPORT_STATIC_ALLOCATION set to 1
+#endif
+
+/* Stack sizes, in words, of the receive tasks and of the tasks that format
+ * output. */
+#define mainRECEIVE_TASK_STACK_SIZE        ( configMINIMAL_STACK_SIZE )
+#define mainSERVICE_TASK_STACK_SIZE        ( configMINIMAL_STACK_SIZE * 2 )
+
+/* Stop the scheduler after this many milliseconds of tick time.  0 to run
+ * for ever. */
+#ifndef mainRUN_FOR_MS
+    #define mainRUN_FOR_MS                 ( 0 )
+#endif
+#define mainHORIZON_TASK_PRIORITY          ( configMAX_PRIORITIES - 1 )
+
+#if ( mainUSE_STATIC_ALLOCATION == 1 )
+
+/* What ipsa_sched() creates in the selected modes: the tasks, the total of
+ * their stacks in words, and the queues with the bytes their items need.  A
+ * replay leaves out the send task, whose share is then spare. */
+    #define mainSTATIC_TASKS                                     \
+    ( 4 + 1 + 1 +                                                \
+      ( ( mainLATENCY_REPORT_PERIOD_MS > 0 ) ? 1 : 0 ) +         \
+      ( ( mainRUN_FOR_MS > 0 ) ? 1 : 0 ) +                       \
+      ( ( mainUSE_TRACE == 1 ) ? 1 : 0 ) +                       \
+      ( ( mainRECORD_EVENTS == 1 ) ? 1 : 0 ) +                   \
+      ( ( mainUSE_REPLAY == 1 ) ? 1 : 0 ) +                      \
+      ( ( mainUSE_DEFERRED_LOG == 1 ) ? 1 : 0 ) +                \
+      ( ( mainUSE_SENSOR_FRAMES == 1 ) ? 1 : 0 ) +               \
+      ( ( mainSTACK_MONITOR_PERIOD_MS > 0 ) ? 1 : 0 ) +          \
+      ( ( mainSTRESS_TASK_COUNT > 0 ) ? 2 : 0 ) +                \
+      ( ( mainLOAD_SWEEP == 1 ) ? 2 : 0 ) +                      \
+      ( ( mainCPU_STATS_PERIOD_MS > 0 ) ? 1 : 0 ) )
+
+    #define mainSTATIC_STACK_WORDS                                                 \
+    ( ( 4 * mainRECEIVE_TASK_STACK_SIZE ) + configMINIMAL_STACK_SIZE +             \
+      mainSERVICE_TASK_STACK_SIZE +                                                \
+      ( ( mainLATENCY_REPORT_PERIOD_MS > 0 ) ? mainSERVICE_TASK_STACK_SIZE : 0 ) + \
+      ( ( mainRUN_FOR_MS > 0 ) ? mainSERVICE_TASK_STACK_SIZE : 0 ) +               \
+      ( ( mainUSE_TRACE == 1 ) ? mainSERVICE_TASK_STACK_SIZE : 0 ) +               \
+      ( ( mainRECORD_EVENTS == 1 ) ? mainSERVICE_TASK_STACK_SIZE : 0 ) +           \
+      ( ( mainUSE_REPLAY == 1 ) ? mainSERVICE_TASK_STACK_SIZE : 0 ) +              \
+      ( ( mainUSE_DEFERRED_LOG == 1 ) ? mainSERVICE_TASK_STACK_SIZE : 0 ) +        \
+      ( ( mainUSE_SENSOR_FRAMES == 1 ) ? configMINIMAL_STACK_SIZE : 0 ) +          \
+      ( ( mainSTACK_MONITOR_PERIOD_MS > 0 ) ? mainSERVICE_TASK_STACK_SIZE : 0 ) +  \
+      ( ( mainSTRESS_TASK_COUNT > 0 ) ? ( mainSERVICE_TASK_STACK_SIZE + configMINIMAL_STACK_SIZE ) : 0 ) + \
+      ( ( mainLOAD_SWEEP == 1 ) ? ( mainSERVICE_TASK_STACK_SIZE + configMINIMAL_STACK_SIZE ) : 0 ) + \
+      ( ( mainCPU_STATS_PERIOD_MS > 0 ) ? mainSERVICE_TASK_STACK_SIZE : 0 ) )
+
+/* The priority bus takes two lanes and a counting semaphore, which has no
+ * item storage, in place of the queue. */
+    #define mainSTATIC_QUEUES                                                         \
+    ( ( ( ( mainUSE_BROADCAST == 1 ) || ( mainUSE_NOTIFY_RELEASE == 1 ) ) ? 0 : 1 ) + \
+      ( ( mainUSE_PRIORITY_BUS == 1 ) ? 2 : 0 ) +                                     \
+      ( ( mainUSE_SENSOR_FRAMES == 1 ) ? 1 : 0 ) )
+
+    #define mainSTATIC_QUEUE_BYTES                                              \
+    ( ( ( ( mainUSE_BROADCAST == 1 ) || ( mainUSE_NOTIFY_RELEASE == 1 ) ) ? 0 : \
+        ( mainUSE_PRIORITY_BUS == 1 ) ?                                         \
+        ( ( mainBUS_URGENT_LENGTH + mainBUS_NORMAL_LENGTH ) * sizeof( IpsaMessage_t ) ) : \
+        ( mainQUEUE_LENGTH * sizeof( IpsaMessage_t ) ) ) +                      \
+      ( ( mainUSE_SENSOR_FRAMES == 1 ) ? ( mainSENSOR_FRAME_COUNT * sizeof( int32_t * ) ) : 0 ) )
+
+/* Every allocation from the arena is rounded up to the port's alignment. */
+    #define mainARENA_ROUND( x )               ( ( ( x ) + portBYTE_ALIGNMENT - 1 ) & ~( ( size_t ) portBYTE_ALIGNMENT - 1 ) )
+
+    #define mainSTATIC_ARENA_SIZE                                           \
+    ( ( mainSTATIC_TASKS * mainARENA_ROUND( sizeof( StaticTask_t ) ) ) +    \
+      ( mainSTATIC_STACK_WORDS * sizeof( StackType_t ) ) +                  \
+      ( mainSTATIC_TASKS * portBYTE_ALIGNMENT ) +                           \
+      ( mainSTATIC_QUEUES * mainARENA_ROUND( sizeof( StaticQueue_t ) ) ) +  \
+      mainSTATIC_QUEUE_BYTES + ( mainSTATIC_QUEUES * portBYTE_ALIGNMENT ) + \
+      mainARENA_ROUND( sizeof( StaticTimer_t ) ) )
+
+#endif /* mainUSE_STATIC_ALLOCATION */
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Latencies recorded by one receive task, in nanoseconds.
+ */
+typedef struct TaskLatency
+{
+    Histogram_t xReleaseToStart;  /* Sender released to this task handling the message. */
+    Histogram_t xStartToFinish;   /* Time taken to handle the message. */
+} TaskLatency_t;
+
+/*
+ * Everything needed to create one receive task.  A pointer to the descriptor
+ * is passed to prvQueueReceiveTask() as its parameter, so descriptors must
+ * remain valid for the life of the task.
+ */
+typedef struct ReceiveTaskDescriptor
+{
+    const char * pcName;                /* Task name, also used in the console output. */
+    UBaseType_t uxPriority;             /* Priority the task is created at. */
+    TickType_t xPeriod;                 /* 0 to be released by the queue, otherwise the release period in ticks. */
+    configSTACK_DEPTH_TYPE usStackDepth; /* Stack size in words. */
+    void ( * pvWorkload )( void );      /* Run on each timer value, or on each periodic release. */
+    TaskLatency_t * pxLatency;          /* Where the task records its latencies, or NULL. */
+} ReceiveTaskDescriptor_t;
+
+/*
+ * What a receive task needs to wait for values, whichever way they are
+ * delivered.
+ */
+typedef struct Receiver
+{
+    BroadcastSubscriber_t * pxSubscriber; /* Broadcast mode: the task's subscription. */
+    UBaseType_t uxSlot;                   /* Notification release mode: the task's index in xReleaseTargets[]. */
+    uint32_t ulPending;                   /* Notification release mode: release bits received but not handled yet. */
+} Receiver_t;
+
+/*
+ * A task watched by the stack monitor.
+ */
+typedef struct MonitoredTask
+{
+    TaskHandle_t xHandle;                /* NULL once the task has deleted itself. */
+    const char * pcName;
+    configSTACK_DEPTH_TYPE usStackDepth; /* Stack size in words. */
+    uint32_t ulWarnings;                 /* Reports in which its free stack was below the warning level. */
+} MonitoredTask_t;
+
 /*-----------------------------------------------------------*/
 
 /*
  * The tasks as described in the comments at the top of this file.
  */
 static void prvQueueReceiveTask( void * pvParameters );
-static void prvQueueReceiveTask2( void * pvParameters );
-static void prvQueueReceiveTask3( void * pvParameters );
-static void prvQueueReceiveTask4( void * pvParameters );
 static void prvQueueSendTask( void * pvParameters );
 
 /*
@@ -129,83 +697,497 @@ static void prvQueueSendTask( void * pvParameters );
  */
 static void prvQueueSendTimerCallback( TimerHandle_t xTimerHandle );
 
+/*
+ * Send a value to, or wait for a value from, the receive tasks - through the
+ * shared queue, the broadcast channel, the priority bus or task
+ * notifications depending on mainUSE_BROADCAST, mainUSE_PRIORITY_BUS and
+ * mainUSE_NOTIFY_RELEASE.  prvSendMessage() returns
+ * pdFAIL if the value was dropped, prvReceiveMessage() if nothing arrived
+ * within xTicksToWait.  A receive task calls prvReceiverInit() once before
+ * its first prvReceiveMessage().
+ */
+static BaseType_t prvSendMessage( uint32_t ulValue );
+static BaseType_t prvReceiveMessage( Receiver_t * pxReceiver,
+                                     IpsaMessage_t * pxMessage,
+                                     TickType_t xTicksToWait );
+static void prvReceiverInit( Receiver_t * pxReceiver );
+
+/*
+ * Create a task, queue or timer, from the static arena or from the heap
+ * depending on mainUSE_STATIC_ALLOCATION.  A failure is reported and counted
+ * in uxCreateFailures, and NULL returned.
+ */
+static TaskHandle_t prvCreateTask( TaskFunction_t pxTaskCode,
+                                   const char * pcName,
+                                   configSTACK_DEPTH_TYPE usStackDepth,
+                                   void * pvParameters,
+                                   UBaseType_t uxPriority );
+static QueueHandle_t prvCreateQueue( UBaseType_t uxLength,
+                                     UBaseType_t uxItemSize );
+static TimerHandle_t prvCreateTimer( const char * pcTimerName,
+                                     TickType_t xPeriod,
+                                     UBaseType_t uxAutoReload,
+                                     TimerCallbackFunction_t pxCallbackFunction );
+
+/*
+ * Prints the start up report described in the comments at the top of this
+ * file, then deletes itself.
+ */
+static void prvStartupTask( void * pvParameters );
+
+/*
+ * Delete the calling task, first removing it from the stack monitor's list.
+ * Tasks created by prvCreateTask() must use this rather than vTaskDelete().
+ */
+static void prvDeleteSelf( void );
+
+/*
+ * The workloads run by the receive tasks when the software timer value
+ * arrives.
+ */
+static void prvStatusWorkload( void );
+static void prvTemperatureWorkload( void );
+static void prvMultiplyWorkload( void );
+static void prvSearchWorkload( void );
+
+#if ( mainLATENCY_REPORT_PERIOD_MS > 0 )
+
+/*
+ * Calls ipsa_sched_print_latency() every mainLATENCY_REPORT_PERIOD_MS.
+ */
+    static void prvLatencyReportTask( void * pvParameters );
+#endif
+
+#if ( mainRUN_FOR_MS > 0 )
+
+/*
+ * Ends the run after mainRUN_FOR_MS, see the comments at the top of this file.
+ */
+    static void prvHorizonTask( void * pvParameters );
+#endif
+
+#if ( mainUSE_TRACE == 1 )
+
+/*
+ * Writes the scheduler trace to mainTRACE_FILE once, then deletes itself.
+ */
+    static void prvTraceDumpTask( void * pvParameters );
+#endif
+
+#if ( mainRECORD_EVENTS == 1 )
+
+/*
+ * Writes the recording to mainRECORD_FILE once, then deletes itself.
+ */
+    static void prvRecordDumpTask( void * pvParameters );
+
+/*
+ * Add an event to the recording, stamped with the current tick count.
+ */
+    static void prvRecordEvent( uint8_t ucEvent,
+                                uint32_t ulTask,
+                                uint32_t ulSequence,
+                                uint32_t ulValue,
+                                uint16_t usFlags );
+#endif
+
+#if ( mainUSE_REPLAY == 1 )
+
+/*
+ * Makes the sends of the loaded recording at their recorded ticks in place of
+ * the send task and the timer, then reports and deletes itself.
+ */
+    static void prvReplayTask( void * pvParameters );
+#endif
+
+#if ( mainUSE_DEFERRED_LOG == 1 )
+
+/*
+ * Writes out the records queued by mainPRINT().
+ */
+    static void prvLogDrainTask( void * pvParameters );
+#endif
+
+#if ( mainCPU_STATS_PERIOD_MS > 0 )
+
+/*
+ * Prints the CPU statistics described in the comments at the top of this
+ * file.
+ */
+    static void prvCpuStatsTask( void * pvParameters );
+#endif
+
+#if ( mainSTACK_MONITOR_PERIOD_MS > 0 )
+
+/*
+ * The stack monitor described in the comments at the top of this file, and
+ * the function that adds a task to its list.
+ */
+    static void prvStackMonitorTask( void * pvParameters );
+    static void prvMonitorTask( TaskHandle_t xHandle,
+                                const char * pcName,
+                                configSTACK_DEPTH_TYPE usStackDepth );
+#endif
+
+#if ( mainUSE_SENSOR_FRAMES == 1 )
+
+/*
+ * Fills sensor frames for Task 2, see the comments at the top of this file.
+ */
+    static void prvSensorTask( void * pvParameters );
+#endif
+
+#if ( mainSTRESS_TASK_COUNT > 0 )
+
+/*
+ * The scaling benchmark described in the comments at the top of this file,
+ * the background task whose throughput it measures, and the workload run by
+ * each stress task.
+ */
+    static void prvScaleTask( void * pvParameters );
+    static void prvStressWorkload( void );
+#endif
+
+#if ( mainLOAD_SWEEP == 1 )
+
+/*
+ * The load sweep described in the comments at the top of this file, and the
+ * source and sink tasks of the pipeline it measures.  The source's rate in
+ * messages per second is passed as its parameter.
+ */
+    static void prvLoadTask( void * pvParameters );
+    static void prvLoadSourceTask( void * pvParameters );
+    static void prvLoadSinkTask( void * pvParameters );
+#endif
+
+#if ( ( mainSTRESS_TASK_COUNT > 0 ) || ( mainLOAD_SWEEP == 1 ) )
+
+/*
+ * Runs at the idle priority; the benchmarks take the CPU time used by the
+ * tasks they measure from the drop in its throughput.
+ */
+    static void prvBackgroundTask( void * pvParameters );
+#endif
+
 /*-----------------------------------------------------------*/
 
 /* The queue used by both tasks. */
 static QueueHandle_t xQueue = NULL;
 
+/* Set by prvHorizonTask() when it stops the scheduler on purpose. */
+static volatile BaseType_t xRunComplete = pdFALSE;
+
 /* A software timer that is started from the tick hook. */
 static TimerHandle_t xTimer = NULL;
 
+/* Values the timer callback could not send. */
+static volatile uint32_t ulTimerSendsDropped = 0;
+
+/* Numbers the sends, so the values received can be matched to a replay. */
+static uint32_t ulSendSequence = 0;
+
+#if ( mainUSE_REPLAY == 1 )
+    /* Replayed sends made after their recorded tick, replayed sends dropped,
+     * and inputs Task 2 asked for beyond those recorded. */
+    static uint32_t ulReplayLate = 0;
+    static uint32_t ulReplaySendsDropped = 0;
+    static volatile uint32_t ulReplayInputsMissing = 0;
+#endif
+
+#if ( mainUSE_BROADCAST == 1 )
+    /* The channel used in place of xQueue in broadcast mode. */
+    static Broadcast_t xBroadcast;
+#endif
+
+#if ( mainUSE_PRIORITY_BUS == 1 )
+    /* The bus used in place of xQueue in priority bus mode. */
+    static Bus_t xBus;
+#endif
+
+#if ( mainUSE_NOTIFY_RELEASE == 1 )
+    /* The receive tasks released by notification, one bit per task blocked
+     * waiting for a release, the turn used when none is, the time of the
+     * last release of each kind left for each of them, and the releases that
+     * arrived while the previous one of the same kind was still pending
+     * (merged) or before any receive task was ready (lost). */
+    static TaskHandle_t xReleaseTargets[ mainMAX_RELEASE_TARGETS ];
+    static UBaseType_t uxReleaseTargetCount = 0;
+    static UBaseType_t uxIdleReleaseTargets = 0;
+    static UBaseType_t uxNextReleaseTarget = 0;
+    static uint64_t ullReleaseTimes[ mainMAX_RELEASE_TARGETS ][ 2 ];
+    static volatile uint32_t ulReleasesMerged = 0;
+    static volatile uint32_t ulReleasesLost = 0;
+#endif
+
+#if ( mainUSE_SENSOR_FRAMES == 1 )
+    /* The frame pool, its storage, and the queue of pointers to the frames
+     * waiting to be converted. */
+    static Pool_t xSensorFramePool;
+    static uint8_t ucSensorFrameStorage[ poolSTORAGE_SIZE( sizeof( int32_t ) * sensorFRAME_SAMPLES, mainSENSOR_FRAME_COUNT ) ] __attribute__( ( aligned( poolALIGNMENT ) ) );
+    static QueueHandle_t xFullFrames = NULL;
+    static uint32_t ulSensorFramesDropped = 0;
+    static SensorStats_t xSensorStats;
+#endif
+
+#if ( mainUSE_STATIC_ALLOCATION == 1 )
+    /* Backing store for everything ipsa_sched() creates, and how much of it
+     * has been handed out. */
+    static uint8_t ucArena[ mainSTATIC_ARENA_SIZE ] __attribute__( ( aligned( portBYTE_ALIGNMENT ) ) );
+    static size_t xArenaUsed = 0;
+#endif
+
+#if ( mainCPU_STATS_PERIOD_MS > 0 )
+    /* The current and previous copies of the task states, used in turn, and
+     * the line built from them. */
+    static TaskStatus_t xCpuSnapshots[ 2 ][ mainCPU_STATS_MAX_TASKS ];
+    static char cCpuLine[ mainCPU_STATS_LINE_SIZE ];
+#endif
+
+#if ( mainSTACK_MONITOR_PERIOD_MS > 0 )
+    /* The tasks the stack monitor reports on. */
+    static MonitoredTask_t xMonitoredTasks[ mainSTACK_MONITOR_MAX_TASKS ];
+    static UBaseType_t uxMonitoredTaskCount = 0;
+#endif
+
+/* Objects that could not be created, and the figures for the start up
+ * report: when ipsa_sched() was entered and the heap it used. */
+static UBaseType_t uxCreateFailures = 0;
+static uint64_t ullEntryNs = 0;
+static size_t xHeapUsedAtStart = 0;
+
+/* Latencies of the receive tasks, indexed as xReceiveTasks[]. */
+static TaskLatency_t xReceiveLatencies[ 4 ];
+
+/* The receive tasks created by ipsa_sched(). */
+static const ReceiveTaskDescriptor_t xReceiveTasks[] =
+{
+    /* pcName    uxPriority                        xPeriod                      usStackDepth                 pvWorkload              pxLatency */
+    { "Task 1", mainQUEUE_RECEIVE_TASK_PRIORITY1, 0,                           mainRECEIVE_TASK_STACK_SIZE, prvStatusWorkload,      &( xReceiveLatencies[ 0 ] ) },
+    { "Task 2", mainQUEUE_RECEIVE_TASK_PRIORITY2, mainTEMPERATURE_TASK_PERIOD, mainRECEIVE_TASK_STACK_SIZE, prvTemperatureWorkload, &( xReceiveLatencies[ 1 ] ) },
+    { "Task 3", mainQUEUE_RECEIVE_TASK_PRIORITY3, 0,                           mainRECEIVE_TASK_STACK_SIZE, prvMultiplyWorkload,    &( xReceiveLatencies[ 2 ] ) },
+    { "Task 4", mainQUEUE_RECEIVE_TASK_PRIORITY4, 0,                           mainRECEIVE_TASK_STACK_SIZE, prvSearchWorkload,      &( xReceiveLatencies[ 3 ] ) },
+};
+
+#if ( mainSTRESS_TASK_COUNT > 0 )
+    /* Every stress task is created from this one descriptor. */
+    static const ReceiveTaskDescriptor_t xStressTask =
+    {
+        "Stress", mainSTRESS_TASK_PRIORITY, mainSTRESS_TASK_PERIOD_MS, configMINIMAL_STACK_SIZE, prvStressWorkload, NULL
+    };
+#endif
+
+#if ( mainLOAD_SWEEP == 1 )
+    /* The queue lengths swept, the pipeline's queue for the current step, and
+     * its counters: values sent and dropped by the source, values received and
+     * wake ups of the sinks. */
+    static const UBaseType_t uxLoadQueueLengths[] = { 1, 2, 8, 32, 128 };
+    static QueueHandle_t xLoadQueue = NULL;
+    static volatile uint32_t ulLoadSent = 0;
+    static volatile uint32_t ulLoadDropped = 0;
+    static uint32_t ulLoadReceived = 0;
+    static uint32_t ulLoadWakeups = 0;
+#endif
+
+#if ( ( mainSTRESS_TASK_COUNT > 0 ) || ( mainLOAD_SWEEP == 1 ) )
+    /* Incremented by prvBackgroundTask() whenever nothing else is running. */
+    static volatile uint32_t ulBackgroundLoops = 0;
+#endif
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Print the receive task latency percentiles and the periodic task deadline
+ * counters, see the comments at the top of this file.  Can be called from
+ * any task once the scheduler is running.
+ */
+void ipsa_sched_print_latency( void );
+
 /*-----------------------------------------------------------*/
 
 /*** SEE THE COMMENTS AT THE TOP OF THIS FILE ***/
 void ipsa_sched( void )
 {
     const TickType_t xTimerPeriod = mainTIMER_SEND_FREQUENCY_MS;
+    BaseType_t xChannelCreated;
+    size_t x, xHeapAtEntry;
+
+    #if ( mainUSE_REPLAY == 1 )
+    {
+        /* Read the recording before the start up time is measured. */
+        if( iReplayLoad( mainREPLAY_FILE, configTICK_RATE_HZ ) != 0 )
+        {
+            console_print( "Could not load the recording %s\n", mainREPLAY_FILE );
+            uxCreateFailures++;
+        }
+    }
+    #endif
+
+    ullEntryNs = ullIpsaClockNs();
+    xHeapAtEntry = xPortGetFreeHeapSize();
+
+    /* Create the queue, or set up the statically allocated broadcast channel
+     * or the priority bus that replaces it.  Notification release needs
+     * neither: the receive tasks register themselves as they start. */
+    #if ( mainUSE_BROADCAST == 1 )
+    {
+        vBroadcastInit( &xBroadcast );
+        xChannelCreated = pdTRUE;
+    }
+    #elif ( mainUSE_PRIORITY_BUS == 1 )
+    {
+        /* The pending count is a counting semaphore: a queue of items of
+         * size 0, which starts empty. */
+        QueueHandle_t xUrgent = prvCreateQueue( mainBUS_URGENT_LENGTH, sizeof( IpsaMessage_t ) );
+        QueueHandle_t xNormal = prvCreateQueue( mainBUS_NORMAL_LENGTH, sizeof( IpsaMessage_t ) );
+        QueueHandle_t xPending = prvCreateQueue( mainBUS_URGENT_LENGTH + mainBUS_NORMAL_LENGTH, 0U );
+
+        vBusInit( &xBus, xUrgent, xNormal, xPending );
+        xChannelCreated = ( ( xUrgent != NULL ) && ( xNormal != NULL ) && ( xPending != NULL ) );
+    }
+    #elif ( mainUSE_NOTIFY_RELEASE == 1 )
+    {
+        xChannelCreated = pdTRUE;
+    }
+    #else
+    {
+        xQueue = prvCreateQueue( mainQUEUE_LENGTH, sizeof( IpsaMessage_t ) );
+        xChannelCreated = ( xQueue != NULL );
+    }
+    #endif
+
+    if( xChannelCreated != pdFALSE )
+    {
+        /* Start the receive tasks described by the table, then the send task,
+         * as described in the comments at the top of this file. */
+        for( x = 0; x < sizeof( xReceiveTasks ) / sizeof( xReceiveTasks[ 0 ] ); x++ )
+        {
+            if( xReceiveTasks[ x ].pxLatency != NULL )
+            {
+                vHistogramReset( &( xReceiveTasks[ x ].pxLatency->xReleaseToStart ) );
+                vHistogramReset( &( xReceiveTasks[ x ].pxLatency->xStartToFinish ) );
+            }
+
+            prvCreateTask( prvQueueReceiveTask,                /* The function that implements the task. */
+                           xReceiveTasks[ x ].pcName,          /* The text name assigned to the task - for debug only as it is not used by the kernel. */
+                           xReceiveTasks[ x ].usStackDepth,    /* The size of the stack to allocate to the task. */
+                           ( void * ) &( xReceiveTasks[ x ] ), /* The parameter passed to the task - the task's descriptor. */
+                           xReceiveTasks[ x ].uxPriority );    /* The priority assigned to the task. */
+        }
+
+        #if ( mainUSE_REPLAY == 1 )
+        {
+            prvCreateTask( prvReplayTask, "Replay", mainSERVICE_TASK_STACK_SIZE, NULL, mainREPLAY_TASK_PRIORITY );
+        }
+        #else
+        {
+            prvCreateTask( prvQueueSendTask, "TX", configMINIMAL_STACK_SIZE, NULL, mainQUEUE_SEND_TASK_PRIORITY );
+        }
+        #endif
+
+        #if ( mainLATENCY_REPORT_PERIOD_MS > 0 )
+        {
+            prvCreateTask( prvLatencyReportTask, "Latency", mainSERVICE_TASK_STACK_SIZE, NULL, mainLATENCY_REPORT_TASK_PRIORITY );
+        }
+        #endif
+
+        #if ( mainRUN_FOR_MS > 0 )
+        {
+            prvCreateTask( prvHorizonTask, "Horizon", mainSERVICE_TASK_STACK_SIZE, NULL, mainHORIZON_TASK_PRIORITY );
+        }
+        #endif
+
+        #if ( mainUSE_TRACE == 1 )
+        {
+            prvCreateTask( prvTraceDumpTask, "Trace", mainSERVICE_TASK_STACK_SIZE, NULL, mainTRACE_TASK_PRIORITY );
+        }
+        #endif
+
+        #if ( mainRECORD_EVENTS == 1 )
+        {
+            prvCreateTask( prvRecordDumpTask, "Record", mainSERVICE_TASK_STACK_SIZE, NULL, mainRECORD_TASK_PRIORITY );
+        }
+        #endif
+
+        #if ( mainUSE_DEFERRED_LOG == 1 )
+        {
+            prvCreateTask( prvLogDrainTask, "Log", mainSERVICE_TASK_STACK_SIZE, NULL, mainLOG_DRAIN_TASK_PRIORITY );
+        }
+        #endif
+
+        #if ( mainUSE_SENSOR_FRAMES == 1 )
+        {
+            /* The queue holds every frame of the pool, so a send of a frame
+             * just taken from it cannot fail. */
+            vPoolInit( &xSensorFramePool, ucSensorFrameStorage, sizeof( int32_t ) * sensorFRAME_SAMPLES, mainSENSOR_FRAME_COUNT );
+            xFullFrames = prvCreateQueue( mainSENSOR_FRAME_COUNT, sizeof( int32_t * ) );
+
+            vSensorStatsReset( &xSensorStats );
+            prvCreateTask( prvSensorTask, "Sensor", configMINIMAL_STACK_SIZE, NULL, mainSENSOR_TASK_PRIORITY );
+        }
+        #endif
+
+        #if ( mainSTRESS_TASK_COUNT > 0 )
+        {
+            prvCreateTask( prvScaleTask, "Scale", mainSERVICE_TASK_STACK_SIZE, NULL, mainSCALE_TASK_PRIORITY );
+            prvCreateTask( prvBackgroundTask, "Bg", configMINIMAL_STACK_SIZE, NULL, tskIDLE_PRIORITY );
+        }
+        #endif
 
-    /* Create the queue. */
-    xQueue = xQueueCreate( mainQUEUE_LENGTH, sizeof( uint32_t ) );
-
-    if( xQueue != NULL )
-    {
-        /* Start the two tasks as described in the comments at the top of this
-         * file. */
-        xTaskCreate( prvQueueReceiveTask,             /* The function that implements the task. */
-                     "Rx",                            /* The text name assigned to the task - for debug only as it is not used by the kernel. */
-                     configMINIMAL_STACK_SIZE,        /* The size of the stack to allocate to the task. */
-                     NULL,                            /* The parameter passed to the task - not used in this simple case. */
-                     mainQUEUE_RECEIVE_TASK_PRIORITY1, /* The priority assigned to the task. */
-                     NULL );                          /* The task handle is not required, so NULL is passed. */
-	
-	
-	
-	
-	xTaskCreate( prvQueueReceiveTask2,             /* The function that implements the task. */
-                     "Rx",                            /* The text name assigned to the task - for debug only as it is not used by the kernel. */
-                     configMINIMAL_STACK_SIZE,        /* The size of the stack to allocate to the task. */
-                     NULL,                            /* The parameter passed to the task - not used in this simple case. */
-                     mainQUEUE_RECEIVE_TASK_PRIORITY2, /* The priority assigned to the task. */
-                     NULL );                          /* The task handle is not required, so NULL is passed. */
-	
-	
-	xTaskCreate( prvQueueReceiveTask3,             /* The function that implements the task. */
-                     "Rx",                            /* The text name assigned to the task - for debug only as it is not used by the kernel. */
-                     configMINIMAL_STACK_SIZE,        /* The size of the stack to allocate to the task. */
-                     NULL,                            /* The parameter passed to the task - not used in this simple case. */
-                     mainQUEUE_RECEIVE_TASK_PRIORITY3, /* The priority assigned to the task. */
-                     NULL );                          /* The task handle is not required, so NULL is passed. */
-                     
-        xTaskCreate( prvQueueReceiveTask4,             /* The function that implements the task. */
-                     "Rx",                            /* The text name assigned to the task - for debug only as it is not used by the kernel. */
-                     configMINIMAL_STACK_SIZE,        /* The size of the stack to allocate to the task. */
-                     NULL,                            /* The parameter passed to the task - not used in this simple case. */
-                     mainQUEUE_RECEIVE_TASK_PRIORITY4, /* The priority assigned to the task. */
-                     NULL );                          /* The task handle is not required, so NULL is passed. */
-	
-        xTaskCreate( prvQueueSendTask, "TX", configMINIMAL_STACK_SIZE, NULL, mainQUEUE_SEND_TASK_PRIORITY, NULL );
+        #if ( mainLOAD_SWEEP == 1 )
+        {
+            prvCreateTask( prvLoadTask, "Load", mainSERVICE_TASK_STACK_SIZE, NULL, mainLOAD_TASK_PRIORITY );
+            prvCreateTask( prvBackgroundTask, "Bg", configMINIMAL_STACK_SIZE, NULL, tskIDLE_PRIORITY );
+        }
+        #endif
 
         /* Create the software timer, but don't start it yet. */
-        xTimer = xTimerCreate( "Timer",                     /* The text name assigned to the software timer - for debug only as it is not used by the kernel. */
-                               xTimerPeriod,                /* The period of the software timer in ticks. */
-                               pdTRUE,                      /* xAutoReload is set to pdTRUE. */
-                               NULL,                        /* The timer's ID is not used. */
-                               prvQueueSendTimerCallback ); /* The function executed when the timer expires. */
+        xTimer = prvCreateTimer( "Timer",                     /* The text name assigned to the software timer - for debug only as it is not used by the kernel. */
+                                 xTimerPeriod,                /* The period of the software timer in ticks. */
+                                 pdTRUE,                      /* xAutoReload is set to pdTRUE. */
+                                 prvQueueSendTimerCallback ); /* The function executed when the timer expires. */
 
-        if( xTimer != NULL )
+        /* In a replay the replay task makes the timer's sends. */
+        if( ( xTimer != NULL ) && ( mainUSE_REPLAY == 0 ) )
         {
             xTimerStart( xTimer, 0 );
         }
 
-        /* Start the tasks and timer running. */
-        vTaskStartScheduler();
+        #if ( mainSTACK_MONITOR_PERIOD_MS > 0 )
+        {
+            prvCreateTask( prvStackMonitorTask, "Stack", mainSERVICE_TASK_STACK_SIZE, NULL, mainSTACK_MONITOR_TASK_PRIORITY );
+        }
+        #endif
+
+        #if ( mainCPU_STATS_PERIOD_MS > 0 )
+        {
+            prvCreateTask( prvCpuStatsTask, "CPU", mainSERVICE_TASK_STACK_SIZE, NULL, mainCPU_STATS_TASK_PRIORITY );
+        }
+        #endif
+
+        /* Created last so that, of the tasks at its priority, it runs first. */
+        prvCreateTask( prvStartupTask, "Startup", mainSERVICE_TASK_STACK_SIZE, NULL, mainSTARTUP_TASK_PRIORITY );
+
+        xHeapUsedAtStart = xHeapAtEntry - xPortGetFreeHeapSize();
+
+        /* Start the tasks and timer running, unless something is missing. */
+        if( uxCreateFailures == 0 )
+        {
+            vTaskStartScheduler();
+        }
+
+        if( xRunComplete != pdFALSE )
+        {
+            /* Stopped by prvHorizonTask() at the end of the run. */
+            return;
+        }
     }
 
     /* If all is well, the scheduler will now be running, and the following
      * line will never be reached.  If the following line does execute, then
      * there was insufficient FreeRTOS heap memory available for the idle and/or
-     * timer tasks	to be created.  See the memory management section on the
-     * FreeRTOS web site for more details. */
+     * timer tasks	to be created, or one of the objects above could not be
+     * created.  See the memory management section on the FreeRTOS web site for
+     * more details. */
     for( ; ; )
     {
     }
@@ -214,29 +1196,32 @@ void ipsa_sched( void )
 
 static void prvQueueSendTask( void * pvParameters )
 {
-    TickType_t xNextWakeTime;
+    Periodic_t xPeriodic;
     const TickType_t xBlockTime = mainTASK_SEND_FREQUENCY_MS;
     const uint32_t ulValueToSend = mainVALUE_SENT_FROM_TASK;
 
     /* Prevent the compiler warning about the unused parameter. */
     ( void ) pvParameters;
 
-    /* Initialise xNextWakeTime - this only needs to be done once. */
-    xNextWakeTime = xTaskGetTickCount();
+    /* Start the release sequence - this only needs to be done once. */
+    ( void ) xPeriodicInit( &xPeriodic, pcTaskGetName( NULL ), xBlockTime, mainOVERRUN_POLICY );
 
     for( ; ; )
     {
         /* Place this task in the blocked state until it is time to run again.
         *  The block time is specified in ticks, pdMS_TO_TICKS() was used to
         *  convert a time specified in milliseconds into a time specified in ticks.
-        *  While in the Blocked state this task will not consume any CPU time. */
-        vTaskDelayUntil( &xNextWakeTime, xBlockTime );
+        *  While in the Blocked state this task will not consume any CPU time.
+        *  A release that has already passed is counted rather than silently
+        *  run late. */
+        ( void ) xPeriodicWait( &xPeriodic );
 
         /* Send to the queue - causing the queue receive task to unblock and
          * write to the console.  0 is used as the block time so the send operation
          * will not block - it shouldn't need to block as the queue should always
-         * have at least one space at this point in the code. */
-        xQueueSend( xQueue, &ulValueToSend, 0U );
+         * have at least one space at this point in the code.  If it does not,
+         * the value is dropped and counted. */
+        vPeriodicCountSend( &xPeriodic, prvSendMessage( ulValueToSend ) );
     }
 }
 /*-----------------------------------------------------------*/
@@ -253,188 +1238,1336 @@ static void prvQueueSendTimerCallback( TimerHandle_t xTimerHandle )
     /* Avoid compiler warnings resulting from the unused parameter. */
     ( void ) xTimerHandle;
 
+    #if ( mainRECORD_EVENTS == 1 )
+        prvRecordEvent( replayEVENT_TIMER, 0U, 0U, 0U, 0U );
+    #endif
+
     /* Send to the queue - causing the queue receive task to unblock and
      * write out a message.  This function is called from the timer/daemon task, so
-     * must not block.  Hence the block time is set to 0. */
-    xQueueSend( xQueue, &ulValueToSend, 0U );
+     * must not block.  Hence the block time is set to 0, and a value that does
+     * not fit is counted. */
+    if( prvSendMessage( ulValueToSend ) != pdPASS )
+    {
+        ulTimerSendsDropped++;
+    }
 }
 /*-----------------------------------------------------------*/
 
-
-
-
-static void prvQueueReceiveTask( void * pvParameters )
+static BaseType_t prvSendMessage( uint32_t ulValue )
 {
-    uint32_t ulReceivedValue;
+    IpsaMessage_t xMessage;
+    BaseType_t xResult = pdPASS;
 
-    /* Prevent the compiler warning about the unused parameter. */
-    ( void ) pvParameters;
+    /* Called as soon as the sender is released, so this is the time the
+     * receive task latencies are measured from. */
+    xMessage.ulValue = ulValue;
+    xMessage.ulSequence = __atomic_add_fetch( &ulSendSequence, 1U, __ATOMIC_RELAXED );
+    xMessage.ullReleaseNs = ullIpsaClockNs();
 
-    for( ; ; )
+    #if ( mainUSE_BROADCAST == 1 )
+        vBroadcastPublish( &xBroadcast, &xMessage );
+    #elif ( mainUSE_PRIORITY_BUS == 1 )
+        xResult = xBusSend( &xBus, ( ulValue == mainVALUE_SENT_FROM_TIMER ) ? eBusUrgent : eBusNormal, &xMessage, 0U );
+    #elif ( mainUSE_NOTIFY_RELEASE == 1 )
     {
-        /* Wait until something arrives in the queue - this task will block
-         * indefinitely provided INCLUDE_vTaskSuspend is set to 1 in
-         * FreeRTOSConfig.h.  It will not use any CPU time while it is in the
-         * Blocked state. */
-        xQueueReceive( xQueue, &ulReceivedValue, portMAX_DELAY );
+        const uint32_t ulBit = ( ulValue == mainVALUE_SENT_FROM_TIMER ) ? mainRELEASE_BIT_TIMER : mainRELEASE_BIT_TASK;
+        UBaseType_t uxCount, uxSlot, uxIdle;
+        uint32_t ulPrevious = 0;
 
-        /* To get here something must have been received from the queue, but
-         * is it an expected value?  Normally calling printf() from a task is not
-         * a good idea.  Here there is lots of stack space and only one task is
-         * using console IO so it is ok.  However, note the comments at the top of
-         * this file about the risks of making Linux system calls (such as
-         * console output) from a FreeRTOS task. */
-        if( ulReceivedValue == mainVALUE_SENT_FROM_TASK )
-        {
-            console_print( "Task 1 is working\n" );
-        }
-        else if( ulReceivedValue == mainVALUE_SENT_FROM_TIMER )
+        uxCount = __atomic_load_n( &uxReleaseTargetCount, __ATOMIC_ACQUIRE );
+
+        if( uxCount == 0U )
         {
-            
-            console_print( "Everything is good !\n" );
+            ( void ) __atomic_fetch_add( &ulReleasesLost, 1U, __ATOMIC_RELAXED );
+            xResult = pdFAIL;
         }
         else
         {
-            console_print( "Unexpected message\n" );
-        }
-    }
-}
+            /* The send task and the timer daemon both send, so a blocked
+             * task is claimed, and the turn taken, atomically. */
+            uxSlot = uxCount;
+            uxIdle = __atomic_load_n( &uxIdleReleaseTargets, __ATOMIC_ACQUIRE );
 
-static void prvQueueReceiveTask2( void * pvParameters )
-{
-    uint32_t ulReceivedValue;
+            while( ( uxIdle != 0U ) && ( uxSlot == uxCount ) )
+            {
+                for( uxSlot = 0; ( uxIdle & ( ( UBaseType_t ) 1U << uxSlot ) ) == 0U; uxSlot++ )
+                {
+                }
 
-    /* Prevent the compiler warning about the unused parameter. */
-    ( void ) pvParameters;
+                if( __atomic_compare_exchange_n( &uxIdleReleaseTargets, &uxIdle, uxIdle & ~( ( UBaseType_t ) 1U << uxSlot ),
+                                                 pdFALSE, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE ) == pdFALSE )
+                {
+                    /* Another sender changed the set; uxIdle was reloaded. */
+                    uxSlot = uxCount;
+                }
+            }
 
-    for( ; ; )
+            if( uxSlot == uxCount )
+            {
+                uxSlot = __atomic_fetch_add( &uxNextReleaseTarget, 1U, __ATOMIC_RELAXED ) % uxCount;
+            }
+
+            /* The notification is a kernel call, which orders the time
+             * before the bit the receive task looks at. */
+            ullReleaseTimes[ uxSlot ][ ( ulBit == mainRELEASE_BIT_TIMER ) ? 1 : 0 ] = xMessage.ullReleaseNs;
+            ( void ) xTaskNotifyAndQuery( xReleaseTargets[ uxSlot ], ulBit, eSetBits, &ulPrevious );
+
+            if( ( ulPrevious & ulBit ) != 0U )
+            {
+                ( void ) __atomic_fetch_add( &ulReleasesMerged, 1U, __ATOMIC_RELAXED );
+                xResult = pdFAIL;
+            }
+        }
+    }
+    #else /* if ( mainUSE_BROADCAST == 1 ) */
+        xResult = xQueueSend( xQueue, &xMessage, 0U );
+    #endif /* if ( mainUSE_BROADCAST == 1 ) */
+
+    #if ( mainRECORD_EVENTS == 1 )
+        prvRecordEvent( replayEVENT_SEND, 0U, xMessage.ulSequence, ulValue, ( xResult == pdPASS ) ? 0U : replayFLAG_DROPPED );
+    #endif
+
+    return xResult;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvReceiveMessage( Receiver_t * pxReceiver,
+                                     IpsaMessage_t * pxMessage,
+                                     TickType_t xTicksToWait )
+{
+    #if ( mainUSE_BROADCAST == 1 )
+        return xBroadcastReceive( &xBroadcast, pxReceiver->pxSubscriber, pxMessage, xTicksToWait );
+    #elif ( mainUSE_PRIORITY_BUS == 1 )
+        ( void ) pxReceiver;
+        return xBusReceive( &xBus, pxMessage, NULL, xTicksToWait );
+    #elif ( mainUSE_NOTIFY_RELEASE == 1 )
     {
-        /* Wait until something arrives in the queue - this task will block
-         * indefinitely provided INCLUDE_vTaskSuspend is set to 1 in
-         * FreeRTOSConfig.h.  It will not use any CPU time while it is in the
-         * Blocked state. */
-        xQueueReceive( xQueue, &ulReceivedValue, portMAX_DELAY );
+        const UBaseType_t uxSelf = ( UBaseType_t ) 1U << pxReceiver->uxSlot;
+        BaseType_t xNotified;
 
-        /* To get here something must have been received from the queue, but
-         * is it an expected value?  Normally calling printf() from a task is not
-         * a good idea.  Here there is lots of stack space and only one task is
-         * using console IO so it is ok.  However, note the comments at the top of
-         * this file about the risks of making Linux system calls (such as
-         * console output) from a FreeRTOS task. */
-        if( ulReceivedValue == mainVALUE_SENT_FROM_TASK )
+        /* One wait can bring both bits; the second is handled on the next
+         * call without waiting. */
+        while( pxReceiver->ulPending == 0U )
         {
-            console_print( "Task 2 is working\n" );
+            /* Offer this task to the senders while it blocks.  A sender
+             * that claims it clears the bit itself. */
+            if( xTicksToWait != 0U )
+            {
+                ( void ) __atomic_fetch_or( &uxIdleReleaseTargets, uxSelf, __ATOMIC_RELEASE );
+            }
+
+            xNotified = xTaskNotifyWait( 0U, 0xffffffffUL, &( pxReceiver->ulPending ), xTicksToWait );
+            ( void ) __atomic_fetch_and( &uxIdleReleaseTargets, ~uxSelf, __ATOMIC_RELAXED );
+
+            if( xNotified == pdFALSE )
+            {
+                return pdFAIL;
+            }
+
+            pxReceiver->ulPending &= ( mainRELEASE_BIT_TASK | mainRELEASE_BIT_TIMER );
         }
-        else if( ulReceivedValue == mainVALUE_SENT_FROM_TIMER )
+
+        if( ( pxReceiver->ulPending & mainRELEASE_BIT_TASK ) != 0U )
         {
-            int temps_in_fh = 32+rand() % 50;
-            
-            double temps_in_dg = (temps_in_fh -32)/9.0*5.0;
-            console_print( "température en Fahreneit : %d F, conversion en degrée :%2f°C\n",temps_in_fh,temps_in_dg );
+            pxReceiver->ulPending &= ~mainRELEASE_BIT_TASK;
+            pxMessage->ulValue = mainVALUE_SENT_FROM_TASK;
+            pxMessage->ullReleaseNs = ullReleaseTimes[ pxReceiver->uxSlot ][ 0 ];
         }
         else
         {
-            console_print( "Unexpected message\n" );
+            pxReceiver->ulPending &= ~mainRELEASE_BIT_TIMER;
+            pxMessage->ulValue = mainVALUE_SENT_FROM_TIMER;
+            pxMessage->ullReleaseNs = ullReleaseTimes[ pxReceiver->uxSlot ][ 1 ];
         }
+
+        return pdPASS;
     }
+    #else /* if ( mainUSE_BROADCAST == 1 ) */
+        ( void ) pxReceiver;
+        return xQueueReceive( xQueue, pxMessage, xTicksToWait );
+    #endif /* if ( mainUSE_BROADCAST == 1 ) */
 }
+/*-----------------------------------------------------------*/
+
+static void prvReceiverInit( Receiver_t * pxReceiver )
+{
+    pxReceiver->pxSubscriber = NULL;
+    pxReceiver->uxSlot = 0;
+    pxReceiver->ulPending = 0;
 
+    #if ( mainUSE_BROADCAST == 1 )
+        pxReceiver->pxSubscriber = pxBroadcastSubscribe( &xBroadcast, NULL );
+    #elif ( mainUSE_NOTIFY_RELEASE == 1 )
+        vTaskSuspendAll();
+        {
+            configASSERT( uxReleaseTargetCount < mainMAX_RELEASE_TARGETS );
+            pxReceiver->uxSlot = uxReleaseTargetCount;
+            xReleaseTargets[ pxReceiver->uxSlot ] = xTaskGetCurrentTaskHandle();
 
-static void prvQueueReceiveTask3( void * pvParameters )
+            /* Publish the count last so a sender never picks an empty slot. */
+            __atomic_store_n( &uxReleaseTargetCount, uxReleaseTargetCount + 1U, __ATOMIC_RELEASE );
+        }
+        ( void ) xTaskResumeAll();
+    #endif
+}
+/*-----------------------------------------------------------*/
+
+#if ( mainUSE_STATIC_ALLOCATION == 1 )
+
+/*
+ * Hand out xSize bytes of the arena, or return NULL if it is used up - which
+ * means mainSTATIC_ARENA_SIZE no longer matches what ipsa_sched() creates.
+ */
+    static void * prvArenaAllocate( size_t xSize )
+    {
+        void * pvBlock = NULL;
+
+        xSize = mainARENA_ROUND( xSize );
+
+        if( xSize <= ( sizeof( ucArena ) - xArenaUsed ) )
+        {
+            pvBlock = &( ucArena[ xArenaUsed ] );
+            xArenaUsed += xSize;
+        }
+
+        return pvBlock;
+    }
+/*-----------------------------------------------------------*/
+
+#endif /* mainUSE_STATIC_ALLOCATION */
+
+static TaskHandle_t prvCreateTask( TaskFunction_t pxTaskCode,
+                                   const char * pcName,
+                                   configSTACK_DEPTH_TYPE usStackDepth,
+                                   void * pvParameters,
+                                   UBaseType_t uxPriority )
 {
-    uint32_t ulReceivedValue;
+    TaskHandle_t xHandle = NULL;
+
+    #if ( mainUSE_STATIC_ALLOCATION == 1 )
+    {
+        StaticTask_t * pxTaskBuffer = prvArenaAllocate( sizeof( StaticTask_t ) );
+        StackType_t * pxStack = prvArenaAllocate( usStackDepth * sizeof( StackType_t ) );
+
+        if( ( pxTaskBuffer != NULL ) && ( pxStack != NULL ) )
+        {
+            xHandle = xTaskCreateStatic( pxTaskCode, pcName, usStackDepth, pvParameters, uxPriority, pxStack, pxTaskBuffer );
+        }
+    }
+    #else
+    {
+        if( xTaskCreate( pxTaskCode, pcName, usStackDepth, pvParameters, uxPriority, &xHandle ) != pdPASS )
+        {
+            xHandle = NULL;
+        }
+    }
+    #endif
+
+    if( xHandle == NULL )
+    {
+        console_print( "Could not create task %s\n", pcName );
+        uxCreateFailures++;
+    }
+    else
+    {
+        #if ( mainSTACK_MONITOR_PERIOD_MS > 0 )
+            prvMonitorTask( xHandle, pcName, usStackDepth );
+        #endif
+    }
+
+    return xHandle;
+}
+/*-----------------------------------------------------------*/
+
+static QueueHandle_t prvCreateQueue( UBaseType_t uxLength,
+                                     UBaseType_t uxItemSize )
+{
+    QueueHandle_t xHandle = NULL;
+
+    #if ( mainUSE_STATIC_ALLOCATION == 1 )
+    {
+        /* A queue of items of size 0 (a semaphore) must have no storage. */
+        StaticQueue_t * pxQueueBuffer = prvArenaAllocate( sizeof( StaticQueue_t ) );
+        uint8_t * pucStorage = ( uxItemSize > 0U ) ? prvArenaAllocate( uxLength * uxItemSize ) : NULL;
+
+        if( ( pxQueueBuffer != NULL ) && ( ( pucStorage != NULL ) || ( uxItemSize == 0U ) ) )
+        {
+            xHandle = xQueueCreateStatic( uxLength, uxItemSize, pucStorage, pxQueueBuffer );
+        }
+    }
+    #else
+    {
+        xHandle = xQueueCreate( uxLength, uxItemSize );
+    }
+    #endif
+
+    if( xHandle == NULL )
+    {
+        console_print( "Could not create a queue\n" );
+        uxCreateFailures++;
+    }
+
+    return xHandle;
+}
+/*-----------------------------------------------------------*/
+
+static TimerHandle_t prvCreateTimer( const char * pcTimerName,
+                                     TickType_t xPeriod,
+                                     UBaseType_t uxAutoReload,
+                                     TimerCallbackFunction_t pxCallbackFunction )
+{
+    TimerHandle_t xHandle = NULL;
+
+    #if ( mainUSE_STATIC_ALLOCATION == 1 )
+    {
+        StaticTimer_t * pxTimerBuffer = prvArenaAllocate( sizeof( StaticTimer_t ) );
+
+        if( pxTimerBuffer != NULL )
+        {
+            xHandle = xTimerCreateStatic( pcTimerName, xPeriod, uxAutoReload, NULL, pxCallbackFunction, pxTimerBuffer );
+        }
+    }
+    #else
+    {
+        xHandle = xTimerCreate( pcTimerName, xPeriod, uxAutoReload, NULL, pxCallbackFunction );
+    }
+    #endif
+
+    if( xHandle == NULL )
+    {
+        console_print( "Could not create timer %s\n", pcTimerName );
+        uxCreateFailures++;
+    }
+
+    return xHandle;
+}
+/*-----------------------------------------------------------*/
+
+static void prvStartupTask( void * pvParameters )
+{
+    uint64_t ullStartNs = ullIpsaClockNs();
+    size_t xArenaBytes = 0, xArenaSize = 0;
 
-    /* Prevent the compiler warning about the unused parameter. */
     ( void ) pvParameters;
 
+    #if ( mainUSE_STATIC_ALLOCATION == 1 )
+        xArenaBytes = xArenaUsed;
+        xArenaSize = sizeof( ucArena );
+    #endif
+
+    /* The heap figure covers what ipsa_sched() created, not the idle and
+     * timer tasks the scheduler adds, so both builds are compared on the same
+     * objects. */
+    console_print( "allocation,ram_bytes,arena_used,arena_size,heap_used,entry_to_first_task_us\n" );
+    console_print( "%s,%lu,%lu,%lu,%lu,%.1f\n",
+                   ( mainUSE_STATIC_ALLOCATION == 1 ) ? "static" : "heap",
+                   ( unsigned long ) ( xArenaSize + xHeapUsedAtStart ),
+                   ( unsigned long ) xArenaBytes,
+                   ( unsigned long ) xArenaSize,
+                   ( unsigned long ) xHeapUsedAtStart,
+                   ( ullStartNs - ullEntryNs ) / 1000.0 );
+
+    prvDeleteSelf();
+}
+/*-----------------------------------------------------------*/
+
+static void prvDeleteSelf( void )
+{
+    #if ( mainSTACK_MONITOR_PERIOD_MS > 0 )
+    {
+        TaskHandle_t xSelf = xTaskGetCurrentTaskHandle();
+        UBaseType_t ux;
+
+        /* The monitor samples a task with the scheduler suspended, so once
+         * the entry is cleared it can no longer be looking at this task. */
+        vTaskSuspendAll();
+        {
+            for( ux = 0; ux < uxMonitoredTaskCount; ux++ )
+            {
+                if( xMonitoredTasks[ ux ].xHandle == xSelf )
+                {
+                    xMonitoredTasks[ ux ].xHandle = NULL;
+                }
+            }
+        }
+        ( void ) xTaskResumeAll();
+    }
+    #endif /* if ( mainSTACK_MONITOR_PERIOD_MS > 0 ) */
+
+    vTaskDelete( NULL );
+}
+/*-----------------------------------------------------------*/
+static void prvQueueReceiveTask( void * pvParameters )
+{
+    const ReceiveTaskDescriptor_t * pxTask = ( const ReceiveTaskDescriptor_t * ) pvParameters;
+    IpsaMessage_t xReceivedMessage;
+    Receiver_t xReceiver;
+    Periodic_t xPeriodic;
+    uint64_t ullStartNs, ullFinishNs;
+
+    if( pxTask->xPeriod != 0 )
+    {
+        /* A periodic task - it does not use the queue, but runs its workload
+         * once per period. */
+        ( void ) xPeriodicInit( &xPeriodic, pxTask->pcName, pxTask->xPeriod, mainOVERRUN_POLICY );
+
+        for( ; ; )
+        {
+            ( void ) xPeriodicWait( &xPeriodic );
+            pxTask->pvWorkload();
+        }
+    }
+
+    prvReceiverInit( &xReceiver );
+
     for( ; ; )
     {
         /* Wait until something arrives in the queue - this task will block
          * indefinitely provided INCLUDE_vTaskSuspend is set to 1 in
          * FreeRTOSConfig.h.  It will not use any CPU time while it is in the
          * Blocked state. */
-        xQueueReceive( xQueue, &ulReceivedValue, portMAX_DELAY );
+        ( void ) prvReceiveMessage( &xReceiver, &xReceivedMessage, portMAX_DELAY );
 
-        /* To get here something must have been received from the queue, but
-         * is it an expected value?  Normally calling printf() from a task is not
-         * a good idea.  Here there is lots of stack space and only one task is
-         * using console IO so it is ok.  However, note the comments at the top of
-         * this file about the risks of making Linux system calls (such as
-         * console output) from a FreeRTOS task. */
-        if( ulReceivedValue == mainVALUE_SENT_FROM_TASK )
+        /* Handle everything that is already waiting before blocking again. */
+        do
         {
-            console_print( "Task 3 is working\n" );
+            ullStartNs = ullIpsaClockNs();
+
+            /* To get here something must have been received from the queue, but
+             * is it an expected value?  Normally calling printf() from a task is not
+             * a good idea.  Here there is lots of stack space and only one task is
+             * using console IO so it is ok.  However, note the comments at the top of
+             * this file about the risks of making Linux system calls (such as
+             * console output) from a FreeRTOS task. */
+            if( xReceivedMessage.ulValue == mainVALUE_SENT_FROM_TASK )
+            {
+                mainPRINT( "%s is working\n", pxTask->pcName );
+            }
+            else if( xReceivedMessage.ulValue == mainVALUE_SENT_FROM_TIMER )
+            {
+                pxTask->pvWorkload();
+            }
+            else
+            {
+                mainPRINT( "Unexpected message\n" );
+            }
+
+            if( pxTask->pxLatency != NULL )
+            {
+                ullFinishNs = ullIpsaClockNs();
+                vHistogramRecord( &( pxTask->pxLatency->xReleaseToStart ), ullStartNs - xReceivedMessage.ullReleaseNs );
+                vHistogramRecord( &( pxTask->pxLatency->xStartToFinish ), ullFinishNs - ullStartNs );
+
+                #if ( mainRECORD_EVENTS == 1 )
+                {
+                    ReplayRecord_t xRecord;
+
+                    xRecord.ulTick = ( uint32_t ) xTaskGetTickCount();
+                    xRecord.ucEvent = replayEVENT_RECEIVE;
+                    xRecord.ucTask = ( uint8_t ) ( pxTask - xReceiveTasks );
+                    xRecord.usFlags = 0U;
+                    xRecord.ulSequence = xReceivedMessage.ulSequence;
+                    xRecord.ulValue = xReceivedMessage.ulValue;
+                    xRecord.ulReleaseToStartNs = mainSATURATE_32( ullStartNs - xReceivedMessage.ullReleaseNs );
+                    xRecord.ulStartToFinishNs = mainSATURATE_32( ullFinishNs - ullStartNs );
+                    vReplayRecord( &xRecord );
+                }
+                #endif
+            }
+        } while( prvReceiveMessage( &xReceiver, &xReceivedMessage, 0U ) == pdPASS );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvStatusWorkload( void )
+{
+    mainPRINT( "Everything is good !\n" );
+}
+/*-----------------------------------------------------------*/
+
+#if ( mainUSE_SENSOR_FRAMES == 1 )
+
+    static void prvTemperatureWorkload( void )
+    {
+        static SensorCelsius_t xCelsius[ sensorFRAME_SAMPLES ];
+        static uint32_t ulFramesConverted = 0;
+        SensorCelsius_t xMin, xMax, xMean;
+        int32_t * plFrame;
+        uint32_t ulSamples;
+
+        /* Convert every frame the producer has handed over, normally one. */
+        while( xQueueReceive( xFullFrames, &plFrame, 0U ) == pdPASS )
+        {
+            vPoolAccept( &xSensorFramePool, plFrame );
+            vSensorConvert( plFrame, xCelsius, sensorFRAME_SAMPLES );
+            vPoolFree( &xSensorFramePool, plFrame );
+
+            vSensorStatsAddFrame( &xSensorStats, xCelsius, sensorFRAME_SAMPLES );
+
+            if( ( ++ulFramesConverted % sensorWINDOW_FRAMES ) == 0U )
+            {
+                ulSamples = ulSensorStatsGet( &xSensorStats, &xMin, &xMax, &xMean );
+
+                mainPRINT( "capteur : %lu échantillons, min %ld, max %ld, moyenne %ld (centièmes de °C)\n",
+                           ( unsigned long ) ulSamples,
+                           ( long ) lSensorCentiCelsius( xMin ),
+                           ( long ) lSensorCentiCelsius( xMax ),
+                           ( long ) lSensorCentiCelsius( xMean ) );
+
+                if( ulSensorFramesDropped != 0U )
+                {
+                    mainPRINT( "capteur : %lu trames perdues\n", ( unsigned long ) ulSensorFramesDropped );
+                }
+            }
         }
-        else if( ulReceivedValue == mainVALUE_SENT_FROM_TIMER )
+    }
+/*-----------------------------------------------------------*/
+
+    static void prvSensorTask( void * pvParameters )
+    {
+        TickType_t xNextWakeTime;
+        int32_t * plFrame;
+        size_t x;
+
+        ( void ) pvParameters;
+
+        xNextWakeTime = xTaskGetTickCount();
+
+        for( ; ; )
         {
-            long int a= 519195165119;
-            long int b= 784816654984;
-            console_print( "a*b =%ld\n",a*b );
+            vTaskDelayUntil( &xNextWakeTime, mainSENSOR_FRAME_PERIOD_MS );
+
+            /* Never wait for Task 2: if it has fallen behind and every frame
+             * is in use, this frame is lost. */
+            plFrame = pvPoolAlloc( &xSensorFramePool );
+
+            if( plFrame == NULL )
+            {
+                ulSensorFramesDropped++;
+                continue;
+            }
+
+            for( x = 0; x < sensorFRAME_SAMPLES; x++ )
+            {
+                plFrame[ x ] = 32 + rand() % 50;
+            }
+
+            vPoolHandOff( &xSensorFramePool, plFrame );
+            ( void ) xQueueSend( xFullFrames, &plFrame, 0U );
         }
-        else
+    }
+/*-----------------------------------------------------------*/
+
+#else /* mainUSE_SENSOR_FRAMES */
+
+    static void prvTemperatureWorkload( void )
+    {
+        uint32_t ulInput;
+        int temps_in_fh;
+        double temps_in_dg;
+
+        /* The reading is recorded, or taken from the recording, so a replay
+         * converts the same values. */
+        #if ( mainUSE_REPLAY == 1 )
+            if( iReplayNextInput( &ulInput ) == 0 )
+            {
+                /* More timer values were handled than in the recorded run. */
+                ulReplayInputsMissing++;
+                ulInput = ( uint32_t ) ( 32 + rand() % 50 );
+            }
+        #else
+            ulInput = ( uint32_t ) ( 32 + rand() % 50 );
+        #endif
+
+        #if ( mainRECORD_EVENTS == 1 )
         {
-            console_print( "Unexpected message\n" );
+            static uint32_t ulInputs = 0;
+
+            prvRecordEvent( replayEVENT_INPUT, 1U, ++ulInputs, ulInput, 0U );
         }
+        #endif
+
+        temps_in_fh = ( int ) ulInput;
+        temps_in_dg = dWorkloadTemperature( temps_in_fh );
+
+        mainPRINT( "température en Fahreneit : %d F, conversion en degrée :%2f°C\n", temps_in_fh, temps_in_dg );
+    }
+/*-----------------------------------------------------------*/
+
+#endif /* mainUSE_SENSOR_FRAMES */
+
+static void prvMultiplyWorkload( void )
+{
+    /* Static because a deferred log record keeps a pointer to the text.  The
+     * product never changes, so rewriting it before the drain is harmless. */
+    static char cProduct[ workloadPRODUCT_DIGITS ];
+    int iOverflow = iWorkloadMultiply( workloadMULTIPLY_A, workloadMULTIPLY_B, cProduct, sizeof( cProduct ) );
+
+    if( iOverflow == 0 )
+    {
+        mainPRINT( "a*b =%s\n", cProduct );
+    }
+    else
+    {
+        mainPRINT( "a*b =%s (dépasse 64 bits)\n", cProduct );
     }
 }
+/*-----------------------------------------------------------*/
 
-static void prvQueueReceiveTask4( void * pvParameters )
+static void prvSearchWorkload( void )
 {
-    uint32_t ulReceivedValue;
+    int iterations;
+    int i = iWorkloadSearch( iWorkloadSearchTable, workloadSEARCH_TABLE_LENGTH, workloadSEARCH_KEY, &iterations );
 
-    /* Prevent the compiler warning about the unused parameter. */
-    ( void ) pvParameters;
+    if( i >= 0 )
+    {
+        mainPRINT( "le nombre %d a été trouvé en %d itérations.\n", iWorkloadSearchTable[ i ], iterations );
+    }
+    else
+    {
+        mainPRINT( "le nombre %d n'a pas été trouvé (%d itérations).\n", workloadSEARCH_KEY, iterations );
+    }
+}
+/*-----------------------------------------------------------*/
 
-    for( ; ; )
+void ipsa_sched_print_latency( void )
+{
+    static const char * const pcPolicyNames[] = { "skip", "catch_up", "degrade" };
+    PeriodicStats_t xStats;
+    const Histogram_t * pxHistogram;
+    UBaseType_t ux;
+    size_t x;
+    int iMetric;
+
+    /* The histograms are read while the receive tasks may be updating them,
+     * so a line can be off by the message being recorded at the time. */
+    console_print( "task,metric,count,p50_us,p99_us,p99.9_us,max_us\n" );
+
+    for( x = 0; x < sizeof( xReceiveTasks ) / sizeof( xReceiveTasks[ 0 ] ); x++ )
     {
-        /* Wait until something arrives in the queue - this task will block
-         * indefinitely provided INCLUDE_vTaskSuspend is set to 1 in
-         * FreeRTOSConfig.h.  It will not use any CPU time while it is in the
-         * Blocked state. */
-        xQueueReceive( xQueue, &ulReceivedValue, portMAX_DELAY );
-
-        /* To get here something must have been received from the queue, but
-         * is it an expected value?  Normally calling printf() from a task is not
-         * a good idea.  Here there is lots of stack space and only one task is
-         * using console IO so it is ok.  However, note the comments at the top of
-         * this file about the risks of making Linux system calls (such as
-         * console output) from a FreeRTOS task. */
-        if( ulReceivedValue == mainVALUE_SENT_FROM_TASK )
-        {
-            console_print( "Task 4 is working\n" );
-        }
-        else if( ulReceivedValue == mainVALUE_SENT_FROM_TIMER )
-        {
-            
-        int y[50] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 
-        23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40, 41, 42, 43, 44, 45, 46, 47, 48, 49, 50};
-	int search_n = 10;
-
-	    
-	int taille = sizeof(y) / sizeof(y[0]) / 2; // taille de la liste :2
-	int i = y[taille];
-	int compteur = 2;
-		
-	while (i != search_n) {
-	if (i < search_n) {
-		taille = taille + taille / compteur;
-		i = y[taille];
-		compteur++;
-	} else if (i>search_n) {
-		    
-		taille = taille - taille / compteur;
-		i = y[taille];
-		compteur++;
-	}
-	}
-		       
-            console_print( "le nombre %d a été trouvé en %d itérations.\n",i,compteur-1 );
+        if( xReceiveTasks[ x ].pxLatency == NULL )
+        {
+            continue;
         }
-        else
+
+        for( iMetric = 0; iMetric < 2; iMetric++ )
         {
-            console_print( "Unexpected message\n" );
+            pxHistogram = ( iMetric == 0 ) ? &( xReceiveTasks[ x ].pxLatency->xReleaseToStart ) : &( xReceiveTasks[ x ].pxLatency->xStartToFinish );
+
+            console_print( "%s,%s,%lu,%.1f,%.1f,%.1f,%.1f\n",
+                           xReceiveTasks[ x ].pcName,
+                           ( iMetric == 0 ) ? "release_to_start" : "start_to_finish",
+                           ( unsigned long ) pxHistogram->ullCount,
+                           ullHistogramPercentile( pxHistogram, 50.0 ) / 1000.0,
+                           ullHistogramPercentile( pxHistogram, 99.0 ) / 1000.0,
+                           ullHistogramPercentile( pxHistogram, 99.9 ) / 1000.0,
+                           pxHistogram->ullMax / 1000.0 );
         }
     }
+
+    #if ( mainUSE_NOTIFY_RELEASE == 1 )
+        console_print( "releases merged %lu, lost %lu\n", ( unsigned long ) ulReleasesMerged, ( unsigned long ) ulReleasesLost );
+    #endif
+
+    #if ( mainUSE_PRIORITY_BUS == 1 )
+        console_print( "lane,sent,dropped\nurgent,%lu,%lu\nnormal,%lu,%lu\n",
+                       ( unsigned long ) xBus.ulSent[ eBusUrgent ], ( unsigned long ) xBus.ulDropped[ eBusUrgent ],
+                       ( unsigned long ) xBus.ulSent[ eBusNormal ], ( unsigned long ) xBus.ulDropped[ eBusNormal ] );
+    #endif
+
+    /* The deadline counters of the periodic tasks. */
+    console_print( "task,policy,period_ms,current_period_ms,releases,late,missed,dropped,rate_changes,max_late_ms\n" );
+
+    for( ux = 0; xPeriodicGetStats( ux, &xStats ) == pdPASS; ux++ )
+    {
+        console_print( "%s,%s,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu\n",
+                       xStats.pcName,
+                       pcPolicyNames[ xStats.ePolicy ],
+                       ( unsigned long ) ( xStats.xPeriod * portTICK_PERIOD_MS ),
+                       ( unsigned long ) ( xStats.xCurrentPeriod * portTICK_PERIOD_MS ),
+                       ( unsigned long ) xStats.ulReleases,
+                       ( unsigned long ) xStats.ulLate,
+                       ( unsigned long ) xStats.ulMissed,
+                       ( unsigned long ) xStats.ulDropped,
+                       ( unsigned long ) xStats.ulRateChanges,
+                       ( unsigned long ) ( xStats.xMaxLateness * portTICK_PERIOD_MS ) );
+    }
+
+    console_print( "periodic,unregistered,%lu\n", ( unsigned long ) ulPeriodicGetUnregistered() );
+    console_print( "timer,sends_dropped,%lu\n", ( unsigned long ) ulTimerSendsDropped );
 }
+/*-----------------------------------------------------------*/
+
+#if ( mainSTACK_MONITOR_PERIOD_MS > 0 )
+
+    static void prvMonitorTask( TaskHandle_t xHandle,
+                                const char * pcName,
+                                configSTACK_DEPTH_TYPE usStackDepth )
+    {
+        MonitoredTask_t * pxTask;
+
+        vTaskSuspendAll();
+        {
+            if( uxMonitoredTaskCount < mainSTACK_MONITOR_MAX_TASKS )
+            {
+                pxTask = &( xMonitoredTasks[ uxMonitoredTaskCount ] );
+                pxTask->xHandle = xHandle;
+                pxTask->pcName = pcName;
+                pxTask->usStackDepth = usStackDepth;
+                pxTask->ulWarnings = 0;
+                uxMonitoredTaskCount++;
+            }
+        }
+        ( void ) xTaskResumeAll();
+    }
+/*-----------------------------------------------------------*/
+
+    static void prvStackMonitorTask( void * pvParameters )
+    {
+        MonitoredTask_t * pxTask;
+        TickType_t xNextWakeTime;
+        UBaseType_t ux, uxFreeWords;
+        uint32_t ulUsed, ulSuggested;
+        BaseType_t xAlive;
+
+        ( void ) pvParameters;
+
+        /* The kernel's own tasks, which did not go through prvCreateTask(). */
+        prvMonitorTask( xTaskGetIdleTaskHandle(), "IDLE", configMINIMAL_STACK_SIZE );
+        #if ( configUSE_TIMERS == 1 )
+            prvMonitorTask( xTimerGetTimerDaemonTaskHandle(), "Tmr Svc", configTIMER_TASK_STACK_DEPTH );
+        #endif
+
+        xNextWakeTime = xTaskGetTickCount();
+
+        for( ; ; )
+        {
+            vTaskDelayUntil( &xNextWakeTime, pdMS_TO_TICKS( mainSTACK_MONITOR_PERIOD_MS ) );
+
+            console_print( "task,stack_words,max_used_words,suggested_words,warnings\n" );
+
+            for( ux = 0; ux < uxMonitoredTaskCount; ux++ )
+            {
+                pxTask = &( xMonitoredTasks[ ux ] );
+
+                /* Keep the task from deleting itself while its stack is
+                 * scanned.  The scan only covers the part of the stack that
+                 * has never been used, so it is short for a well sized
+                 * stack. */
+                vTaskSuspendAll();
+                {
+                    xAlive = ( pxTask->xHandle != NULL );
+                    uxFreeWords = xAlive ? uxTaskGetStackHighWaterMark( pxTask->xHandle ) : 0;
+                }
+                ( void ) xTaskResumeAll();
+
+                if( xAlive == pdFALSE )
+                {
+                    continue;
+                }
+
+                if( ( uxFreeWords * 100U ) < ( ( UBaseType_t ) pxTask->usStackDepth * mainSTACK_WARNING_PERCENT ) )
+                {
+                    if( pxTask->ulWarnings++ == 0U )
+                    {
+                        console_print( "Warning: %s has %lu of %lu stack words left\n",
+                                       pxTask->pcName,
+                                       ( unsigned long ) uxFreeWords,
+                                       ( unsigned long ) pxTask->usStackDepth );
+                    }
+                }
+
+                ulUsed = ( uint32_t ) pxTask->usStackDepth - ( uint32_t ) uxFreeWords;
+                ulSuggested = ulUsed + ( ( ulUsed * mainSTACK_MARGIN_PERCENT ) + 99U ) / 100U;
+                ulSuggested = ( ( ulSuggested + mainSTACK_ROUNDING_WORDS - 1U ) / mainSTACK_ROUNDING_WORDS ) * mainSTACK_ROUNDING_WORDS;
+
+                console_print( "%s,%lu,%lu,%lu,%lu\n",
+                               pxTask->pcName,
+                               ( unsigned long ) pxTask->usStackDepth,
+                               ( unsigned long ) ulUsed,
+                               ( unsigned long ) ulSuggested,
+                               ( unsigned long ) pxTask->ulWarnings );
+            }
+
+            console_print( "heap,free_bytes,min_ever_free_bytes\n" );
+            console_print( "heap,%lu,%lu\n",
+                           ( unsigned long ) xPortGetFreeHeapSize(),
+                           ( unsigned long ) xPortGetMinimumEverFreeHeapSize() );
+        }
+    }
+/*-----------------------------------------------------------*/
+
+#endif /* mainSTACK_MONITOR_PERIOD_MS */
+
+#if ( mainCPU_STATS_PERIOD_MS > 0 )
+
+    static void prvCpuStatsTask( void * pvParameters )
+    {
+        TaskStatus_t * pxNow, * pxBefore;
+        UBaseType_t uxNow, uxBefore = 0, ux, uxMatch;
+        TickType_t xNextWakeTime;
+        uint64_t ullStartNs, ullSnapshotNs, ullPreviousNs;
+        uint32_t ulIntervalUs, ulRan;
+        size_t xUsed;
+        int iBuffer = 0, iWritten;
+
+        ( void ) pvParameters;
+
+        xNextWakeTime = xTaskGetTickCount();
+        ullPreviousNs = ullIpsaClockNs();
+
+        for( ; ; )
+        {
+            vTaskDelayUntil( &xNextWakeTime, pdMS_TO_TICKS( mainCPU_STATS_PERIOD_MS ) );
+
+            ullStartNs = ullIpsaClockNs();
+            pxNow = xCpuSnapshots[ iBuffer ];
+            pxBefore = xCpuSnapshots[ iBuffer ^ 1 ];
+
+            /* Returns 0 if there are more tasks than the array holds. */
+            uxNow = uxTaskGetSystemState( pxNow, mainCPU_STATS_MAX_TASKS, NULL );
+            ullSnapshotNs = ullIpsaClockNs();
+            ulIntervalUs = ( uint32_t ) ( ( ullSnapshotNs - ullPreviousNs ) / 1000ULL );
+            ullPreviousNs = ullSnapshotNs;
+
+            xUsed = 0;
+
+            for( ux = 0; ( ux < uxNow ) && ( xUsed < sizeof( cCpuLine ) ); ux++ )
+            {
+                /* The tasks usually come back in the same order, so look at
+                 * the same position first. */
+                uxMatch = ux;
+
+                if( ( uxMatch >= uxBefore ) || ( pxBefore[ uxMatch ].xTaskNumber != pxNow[ ux ].xTaskNumber ) )
+                {
+                    for( uxMatch = 0; uxMatch < uxBefore; uxMatch++ )
+                    {
+                        if( pxBefore[ uxMatch ].xTaskNumber == pxNow[ ux ].xTaskNumber )
+                        {
+                            break;
+                        }
+                    }
+                }
+
+                /* A task created during the interval ran for all of its
+                 * count. */
+                ulRan = ( uint32_t ) pxNow[ ux ].ulRunTimeCounter;
+
+                if( uxMatch < uxBefore )
+                {
+                    ulRan -= ( uint32_t ) pxBefore[ uxMatch ].ulRunTimeCounter;
+                }
+
+                iWritten = snprintf( &( cCpuLine[ xUsed ] ), sizeof( cCpuLine ) - xUsed, ",%s:%lu",
+                                     pxNow[ ux ].pcTaskName,
+                                     ( unsigned long ) ( ( ulIntervalUs > 0U ) ? ( ( ( uint64_t ) ulRan * 1000U ) / ulIntervalUs ) : 0U ) );
+                xUsed += ( iWritten > 0 ) ? ( size_t ) iWritten : 0U;
+            }
+
+            if( xUsed >= sizeof( cCpuLine ) )
+            {
+                /* Only possible with names longer than configMAX_TASK_NAME_LEN;
+                 * snprintf() has cut the line short. */
+                xUsed = sizeof( cCpuLine ) - 1U;
+            }
+
+            cCpuLine[ xUsed ] = '\0';
+            uxBefore = uxNow;
+            iBuffer ^= 1;
+
+            console_print( "cpu,%lu,%lu,%lu%s%s\n",
+                           ( unsigned long ) ( ( ullSnapshotNs - ullEntryNs ) / 1000000ULL ),
+                           ( unsigned long ) ulIntervalUs,
+                           ( unsigned long ) ( ( ullIpsaClockNs() - ullStartNs ) / 1000ULL ),
+                           cCpuLine,
+                           ( uxNow == 0U ) ? ",overflow" : "" );
+        }
+    }
+/*-----------------------------------------------------------*/
+
+#endif /* mainCPU_STATS_PERIOD_MS */
+
+#if ( mainLATENCY_REPORT_PERIOD_MS > 0 )
+
+    static void prvLatencyReportTask( void * pvParameters )
+    {
+        TickType_t xNextWakeTime;
+
+        ( void ) pvParameters;
+
+        xNextWakeTime = xTaskGetTickCount();
+
+        for( ; ; )
+        {
+            vTaskDelayUntil( &xNextWakeTime, pdMS_TO_TICKS( mainLATENCY_REPORT_PERIOD_MS ) );
+            ipsa_sched_print_latency();
+        }
+    }
+/*-----------------------------------------------------------*/
+
+#endif /* mainLATENCY_REPORT_PERIOD_MS */
+
+#if ( mainRUN_FOR_MS > 0 )
+
+    static void prvHorizonTask( void * pvParameters )
+    {
+        uint64_t ullStartNs, ullWallNs, ullSkipped = 0;
+        uint32_t ulSleeps = 0;
+        struct rusage xStart, xEnd;
+        double dCpuS, dSwitches, dInvoluntary;
+
+        ( void ) pvParameters;
+
+        ullStartNs = ullIpsaClockNs();
+        ( void ) getrusage( RUSAGE_SELF, &xStart );
+
+        vTaskDelay( pdMS_TO_TICKS( mainRUN_FOR_MS ) );
+
+        ullWallNs = ullIpsaClockNs() - ullStartNs;
+        ( void ) getrusage( RUSAGE_SELF, &xEnd );
+
+        #if ( ( defined( ipsaVIRTUAL_TIME ) && ( ipsaVIRTUAL_TIME == 1 ) ) || ( defined( ipsaTICKLESS_IDLE ) && ( ipsaTICKLESS_IDLE == 1 ) ) )
+            ullSkipped = ullIpsaTicklessGetSuppressedTicks();
+            ulSleeps = ulIpsaTicklessGetSleeps();
+        #endif
+
+        console_print( "Ran %lu ms of tick time in %.3f s of wall clock time (x%.0f), %llu idle ticks skipped in %lu sleeps\n",
+                       ( unsigned long ) mainRUN_FOR_MS,
+                       ullWallNs / 1e9,
+                       ( ullWallNs > 0 ) ? ( mainRUN_FOR_MS * 1e6 ) / ullWallNs : 0.0,
+                       ( unsigned long long ) ullSkipped,
+                       ( unsigned long ) ulSleeps );
+
+        /* The whole process - every task thread, and the port's own. */
+        dCpuS = ( double ) ( xEnd.ru_utime.tv_sec - xStart.ru_utime.tv_sec ) + ( ( double ) ( xEnd.ru_utime.tv_usec - xStart.ru_utime.tv_usec ) / 1e6 ) +
+                ( double ) ( xEnd.ru_stime.tv_sec - xStart.ru_stime.tv_sec ) + ( ( double ) ( xEnd.ru_stime.tv_usec - xStart.ru_stime.tv_usec ) / 1e6 );
+        dSwitches = ( double ) ( xEnd.ru_nvcsw - xStart.ru_nvcsw );
+        dInvoluntary = ( double ) ( xEnd.ru_nivcsw - xStart.ru_nivcsw );
+
+        console_print( "host_cpu_s,host_cpu_pct,wakeups_per_s,involuntary_switches_per_s\n" );
+        console_print( "%.3f,%.2f,%.1f,%.1f\n",
+                       dCpuS,
+                       ( ullWallNs > 0 ) ? ( dCpuS * 1e11 ) / ullWallNs : 0.0,
+                       ( ullWallNs > 0 ) ? ( dSwitches * 1e9 ) / ullWallNs : 0.0,
+                       ( ullWallNs > 0 ) ? ( dInvoluntary * 1e9 ) / ullWallNs : 0.0 );
+
+        xRunComplete = pdTRUE;
+        vTaskEndScheduler();
+    }
+/*-----------------------------------------------------------*/
+
+#endif /* mainRUN_FOR_MS */
+
+#if ( mainUSE_TRACE == 1 )
+
+    static void prvTraceDumpTask( void * pvParameters )
+    {
+        ( void ) pvParameters;
+
+        vTaskDelay( mainTRACE_CAPTURE_MS );
+
+        if( iTraceDump( mainTRACE_FILE ) == 0 )
+        {
+            console_print( "Scheduler trace written to %s\n", mainTRACE_FILE );
+        }
+        else
+        {
+            console_print( "Could not write the scheduler trace to %s\n", mainTRACE_FILE );
+        }
+
+        prvDeleteSelf();
+    }
+/*-----------------------------------------------------------*/
+
+#endif /* mainUSE_TRACE */
+
+#if ( mainRECORD_EVENTS == 1 )
+
+    static void prvRecordEvent( uint8_t ucEvent,
+                                uint32_t ulTask,
+                                uint32_t ulSequence,
+                                uint32_t ulValue,
+                                uint16_t usFlags )
+    {
+        ReplayRecord_t xRecord;
+
+        xRecord.ulTick = ( uint32_t ) xTaskGetTickCount();
+        xRecord.ucEvent = ucEvent;
+        xRecord.ucTask = ( uint8_t ) ulTask;
+        xRecord.usFlags = usFlags;
+        xRecord.ulSequence = ulSequence;
+        xRecord.ulValue = ulValue;
+        xRecord.ulReleaseToStartNs = 0U;
+        xRecord.ulStartToFinishNs = 0U;
+        vReplayRecord( &xRecord );
+    }
+/*-----------------------------------------------------------*/
+
+    static void prvRecordDumpTask( void * pvParameters )
+    {
+        ( void ) pvParameters;
+
+        vTaskDelay( mainRECORD_CAPTURE_MS );
+
+        if( iReplayDump( mainRECORD_FILE, configTICK_RATE_HZ ) == 0 )
+        {
+            console_print( "Recording written to %s\n", mainRECORD_FILE );
+        }
+        else
+        {
+            console_print( "Could not write the recording to %s\n", mainRECORD_FILE );
+        }
+
+        prvDeleteSelf();
+    }
+/*-----------------------------------------------------------*/
+
+#endif /* mainRECORD_EVENTS */
+
+#if ( mainUSE_REPLAY == 1 )
+
+    static void prvReplayTask( void * pvParameters )
+    {
+        const ReplayRecord_t * pxEvent;
+        TickType_t xLastWakeTime;
+        uint32_t ulEvents = 0;
+
+        ( void ) pvParameters;
+
+        /* The tick count starts from 0 with the scheduler in both runs, so
+         * the recorded ticks are used as they are. */
+        xLastWakeTime = xTaskGetTickCount();
+
+        while( ( pxEvent = pxReplayNextSource() ) != NULL )
+        {
+            if( ( TickType_t ) pxEvent->ulTick > xLastWakeTime )
+            {
+                vTaskDelayUntil( &xLastWakeTime, ( TickType_t ) pxEvent->ulTick - xLastWakeTime );
+            }
+
+            if( xTaskGetTickCount() > ( TickType_t ) pxEvent->ulTick )
+            {
+                ulReplayLate++;
+            }
+
+            /* A send recorded as dropped is made again: the recording is
+             * the load offered, not what got through. */
+            if( pxEvent->ucEvent == replayEVENT_TIMER )
+            {
+                prvRecordEvent( replayEVENT_TIMER, 0U, 0U, 0U, 0U );
+            }
+            else if( prvSendMessage( pxEvent->ulValue ) != pdPASS )
+            {
+                ulReplaySendsDropped++;
+            }
+
+            ulEvents++;
+        }
+
+        console_print( "Replayed %lu events from %s, %lu late, %lu sends dropped, %lu inputs missing\n",
+                       ( unsigned long ) ulEvents,
+                       mainREPLAY_FILE,
+                       ( unsigned long ) ulReplayLate,
+                       ( unsigned long ) ulReplaySendsDropped,
+                       ( unsigned long ) ulReplayInputsMissing );
+
+        prvDeleteSelf();
+    }
+/*-----------------------------------------------------------*/
+
+#endif /* mainUSE_REPLAY */
+
+#if ( mainUSE_DEFERRED_LOG == 1 )
+
+    static void prvLogDrainTask( void * pvParameters )
+    {
+        /* Static so the buffer does not have to fit on the task's stack. */
+        static char cBuffer[ mainLOG_DRAIN_BUFFER_SIZE ];
+        TickType_t xNextWakeTime;
+
+        ( void ) pvParameters;
+
+        xNextWakeTime = xTaskGetTickCount();
+
+        for( ; ; )
+        {
+            vTaskDelayUntil( &xNextWakeTime, mainLOG_DRAIN_PERIOD_MS );
+
+            /* One console write per full buffer, however many records it
+             * holds. */
+            while( xLogDrain( cBuffer, sizeof( cBuffer ) ) > 0 )
+            {
+                console_print( "%s", cBuffer );
+            }
+        }
+    }
+/*-----------------------------------------------------------*/
+
+#endif /* mainUSE_DEFERRED_LOG */
+
+#if ( mainSTRESS_TASK_COUNT > 0 )
+
+    static void prvScaleTask( void * pvParameters )
+    {
+        UBaseType_t uxStressTasks = 0, uxToAdd;
+        size_t xHeapBefore, xHeapUsed;
+        uint32_t ulLoops, ulBaseline = 0;
+
+        ( void ) pvParameters;
+
+        xHeapBefore = xPortGetFreeHeapSize();
+
+        console_print( "stress_tasks,total_tasks,heap_used,heap_per_task,background_loops_per_s,overhead_pct\n" );
+
+        for( ; ; )
+        {
+            /* Let the system settle, then count how often the background task
+             * ran over a fixed window. */
+            ulBackgroundLoops = 0;
+            vTaskDelay( mainSCALE_MEASURE_TIME_MS );
+            ulLoops = ulBackgroundLoops;
+
+            if( uxStressTasks == 0 )
+            {
+                ulBaseline = ulLoops;
+            }
+
+            xHeapUsed = xHeapBefore - xPortGetFreeHeapSize();
+
+            console_print( "%lu,%lu,%lu,%lu,%lu,%lu\n",
+                           ( unsigned long ) uxStressTasks,
+                           ( unsigned long ) uxTaskGetNumberOfTasks(),
+                           ( unsigned long ) xHeapUsed,
+                           ( unsigned long ) ( ( uxStressTasks > 0 ) ? ( xHeapUsed / uxStressTasks ) : 0 ),
+                           ( unsigned long ) ( ( ( uint64_t ) ulLoops * configTICK_RATE_HZ ) / mainSCALE_MEASURE_TIME_MS ),
+                           ( unsigned long ) ( ( ulBaseline > ulLoops ) ? ( ( uint64_t ) ( ulBaseline - ulLoops ) * 100U ) / ulBaseline : 0 ) );
+
+            if( uxStressTasks >= mainSTRESS_TASK_COUNT )
+            {
+                break;
+            }
+
+            for( uxToAdd = mainSTRESS_TASK_STEP; ( uxToAdd > 0 ) && ( uxStressTasks < mainSTRESS_TASK_COUNT ); uxToAdd-- )
+            {
+                if( xTaskCreate( prvQueueReceiveTask, xStressTask.pcName, xStressTask.usStackDepth, ( void * ) &xStressTask, xStressTask.uxPriority, NULL ) != pdPASS )
+                {
+                    console_print( "Out of heap after %lu stress tasks\n", ( unsigned long ) uxStressTasks );
+                    prvDeleteSelf();
+                }
+
+                uxStressTasks++;
+            }
+        }
+
+        console_print( "Scaling benchmark done\n" );
+        prvDeleteSelf();
+    }
+/*-----------------------------------------------------------*/
+
+    static void prvStressWorkload( void )
+    {
+        volatile uint32_t ulSpin;
+
+        /* A short, fixed amount of work so each release costs about the same
+         * and the context switches dominate. */
+        for( ulSpin = 0; ulSpin < 100U; ulSpin++ )
+        {
+        }
+    }
+
+#endif /* mainSTRESS_TASK_COUNT */
+/*-----------------------------------------------------------*/
+
+#if ( mainLOAD_SWEEP == 1 )
+
+    static void prvLoadTask( void * pvParameters )
+    {
+        TaskHandle_t xSource, xSinks[ mainLOAD_SINK_TASKS ];
+        BaseType_t xCreated;
+        size_t xLength;
+        UBaseType_t ux;
+        uint32_t ulRate, ulLoops, ulBaseline, ulMaxSustained, ulOffered;
+        double dDropPct, dBusyNs;
+
+        ( void ) pvParameters;
+
+        /* The background throughput with nothing else running is the
+         * reference the CPU time is taken from. */
+        ulBackgroundLoops = 0;
+        vTaskDelay( mainLOAD_STEP_TIME_MS );
+        ulBaseline = ulBackgroundLoops;
+
+        console_print( "queue_length,offered_per_s,sent_per_s,received_per_s,drop_pct,messages_per_wakeup,cpu_us_per_message\n" );
+
+        for( xLength = 0; xLength < sizeof( uxLoadQueueLengths ) / sizeof( uxLoadQueueLengths[ 0 ] ); xLength++ )
+        {
+            ulMaxSustained = 0;
+
+            for( ulRate = 1; ulRate <= mainLOAD_MAX_RATE; ulRate = ( ulRate < configTICK_RATE_HZ ) ? ( ulRate * 10U ) : ( ulRate * 2U ) )
+            {
+                /* This task has the highest priority, so nothing it creates
+                 * runs before it blocks. */
+                xLoadQueue = xQueueCreate( uxLoadQueueLengths[ xLength ], sizeof( IpsaMessage_t ) );
+                xCreated = ( xLoadQueue != NULL ) ? pdPASS : pdFAIL;
+
+                for( ux = 0; ux < mainLOAD_SINK_TASKS; ux++ )
+                {
+                    xSinks[ ux ] = NULL;
+
+                    if( xCreated == pdPASS )
+                    {
+                        xCreated = xTaskCreate( prvLoadSinkTask, "Sink", configMINIMAL_STACK_SIZE, NULL, mainLOAD_SINK_PRIORITY, &( xSinks[ ux ] ) );
+                    }
+                }
+
+                xSource = NULL;
+
+                if( xCreated == pdPASS )
+                {
+                    xCreated = xTaskCreate( prvLoadSourceTask, "Source", configMINIMAL_STACK_SIZE, ( void * ) ( uintptr_t ) ulRate, mainLOAD_SOURCE_PRIORITY, &xSource );
+                }
+
+                ulLoadSent = 0;
+                ulLoadDropped = 0;
+                __atomic_store_n( &ulLoadReceived, 0U, __ATOMIC_RELAXED );
+                __atomic_store_n( &ulLoadWakeups, 0U, __ATOMIC_RELAXED );
+                ulBackgroundLoops = 0;
+
+                if( xCreated == pdPASS )
+                {
+                    vTaskDelay( mainLOAD_STEP_TIME_MS );
+                }
+
+                ulLoops = ulBackgroundLoops;
+
+                /* The sinks are blocked on the queue or ready, so they can be
+                 * deleted before it. */
+                if( xSource != NULL )
+                {
+                    vTaskDelete( xSource );
+                }
+
+                for( ux = 0; ux < mainLOAD_SINK_TASKS; ux++ )
+                {
+                    if( xSinks[ ux ] != NULL )
+                    {
+                        vTaskDelete( xSinks[ ux ] );
+                    }
+                }
+
+                if( xLoadQueue != NULL )
+                {
+                    vQueueDelete( xLoadQueue );
+                    xLoadQueue = NULL;
+                }
+
+                if( xCreated != pdPASS )
+                {
+                    console_print( "Out of heap at queue length %lu\n", ( unsigned long ) uxLoadQueueLengths[ xLength ] );
+                    prvDeleteSelf();
+                }
+
+                ulOffered = ulLoadSent + ulLoadDropped;
+                dDropPct = ( ulOffered > 0U ) ? ( ( double ) ulLoadDropped * 100.0 ) / ( double ) ulOffered : 0.0;
+                dBusyNs = ( ulBaseline > ulLoops ) ? ( ( double ) ( ulBaseline - ulLoops ) / ( double ) ulBaseline ) * ( ( double ) mainLOAD_STEP_TIME_MS * portTICK_PERIOD_MS * 1e6 ) : 0.0;
+
+                console_print( "%lu,%lu,%lu,%lu,%.2f,%.1f,%.2f\n",
+                               ( unsigned long ) uxLoadQueueLengths[ xLength ],
+                               ( unsigned long ) ( ( ( uint64_t ) ulOffered * configTICK_RATE_HZ ) / mainLOAD_STEP_TIME_MS ),
+                               ( unsigned long ) ( ( ( uint64_t ) ulLoadSent * configTICK_RATE_HZ ) / mainLOAD_STEP_TIME_MS ),
+                               ( unsigned long ) ( ( ( uint64_t ) ulLoadReceived * configTICK_RATE_HZ ) / mainLOAD_STEP_TIME_MS ),
+                               dDropPct,
+                               ( ulLoadWakeups > 0U ) ? ( double ) ulLoadReceived / ( double ) ulLoadWakeups : 0.0,
+                               ( ulLoadReceived > 0U ) ? ( dBusyNs / ( double ) ulLoadReceived ) / 1000.0 : 0.0 );
+
+                if( dDropPct > mainLOAD_DROP_LIMIT_PCT )
+                {
+                    break;
+                }
+
+                ulMaxSustained = ulRate;
+            }
+
+            console_print( "Queue length %lu sustains %lu messages/s\n", ( unsigned long ) uxLoadQueueLengths[ xLength ], ( unsigned long ) ulMaxSustained );
+        }
+
+        console_print( "Load sweep done\n" );
+        prvDeleteSelf();
+    }
+/*-----------------------------------------------------------*/
+
+    static void prvLoadSourceTask( void * pvParameters )
+    {
+        const uint32_t ulRate = ( uint32_t ) ( uintptr_t ) pvParameters;
+        TickType_t xStart, xNextWakeTime;
+        IpsaMessage_t xMessage;
+        uint64_t ullDue, ullSent = 0;
+
+        xMessage.ulValue = mainVALUE_SENT_FROM_TASK;
+        xStart = xTaskGetTickCount();
+        xNextWakeTime = xStart;
+
+        for( ; ; )
+        {
+            vTaskDelayUntil( &xNextWakeTime, 1U );
+
+            /* Send every value due by now at ulRate per second - a burst each
+             * tick when the rate is above the tick rate, a value every few
+             * ticks below it. */
+            ullDue = ( ( uint64_t ) ( xNextWakeTime - xStart ) * ulRate ) / configTICK_RATE_HZ;
+            xMessage.ullReleaseNs = ullIpsaClockNs();
+
+            for( ; ullSent < ullDue; ullSent++ )
+            {
+                if( xQueueSend( xLoadQueue, &xMessage, 0U ) == pdPASS )
+                {
+                    ulLoadSent++;
+                }
+                else
+                {
+                    ulLoadDropped++;
+                }
+            }
+        }
+    }
+/*-----------------------------------------------------------*/
+
+    static void prvLoadSinkTask( void * pvParameters )
+    {
+        IpsaMessage_t xMessage;
+        uint32_t ulBatch;
+
+        ( void ) pvParameters;
+
+        for( ; ; )
+        {
+            ( void ) xQueueReceive( xLoadQueue, &xMessage, portMAX_DELAY );
+
+            /* Drain the queue as the receive tasks do. */
+            for( ulBatch = 1; xQueueReceive( xLoadQueue, &xMessage, 0U ) == pdPASS; ulBatch++ )
+            {
+            }
+
+            /* The sinks share a priority and can preempt one another. */
+            __atomic_fetch_add( &ulLoadReceived, ulBatch, __ATOMIC_RELAXED );
+            __atomic_fetch_add( &ulLoadWakeups, 1U, __ATOMIC_RELAXED );
+        }
+    }
+
+#endif /* mainLOAD_SWEEP */
+/*-----------------------------------------------------------*/
+
+#if ( ( mainSTRESS_TASK_COUNT > 0 ) || ( mainLOAD_SWEEP == 1 ) )
+
+    static void prvBackgroundTask( void * pvParameters )
+    {
+        ( void ) pvParameters;
+
+        for( ; ; )
+        {
+            ulBackgroundLoops++;
+        }
+    }
 
+#endif
 /*-----------------------------------------------------------*/
@@ -0,0 +1,151 @@
+/*
+ * Sorted array lookups.  See ipsa_search.h.
+ */
+
+#include <stdint.h>
+
+/* Local includes. */
+#include "ipsa_search.h"
+
+/* How far ahead xSearchEytzinger() prefetches: the 16 descendants four levels
+ * down are contiguous, and 16 ints are one 64 byte cache line. */
+#define searchPREFETCH_LEVELS    ( 4 )
+
+/*-----------------------------------------------------------*/
+
+size_t xSearchBinary( const int * piSorted,
+                      size_t xLength,
+                      int iKey,
+                      size_t * pxProbes )
+{
+    size_t xLow = 0, xHigh = xLength, xMiddle, xProbes = 0;
+    size_t xResult = searchNOT_FOUND;
+
+    while( xLow < xHigh )
+    {
+        xMiddle = xLow + ( ( xHigh - xLow ) / 2 );
+        xProbes++;
+
+        if( piSorted[ xMiddle ] < iKey )
+        {
+            xLow = xMiddle + 1;
+        }
+        else if( piSorted[ xMiddle ] > iKey )
+        {
+            xHigh = xMiddle;
+        }
+        else
+        {
+            xResult = xMiddle;
+            break;
+        }
+    }
+
+    if( pxProbes != NULL )
+    {
+        *pxProbes = xProbes;
+    }
+
+    return xResult;
+}
+/*-----------------------------------------------------------*/
+
+size_t xSearchBranchless( const int * piSorted,
+                          size_t xLength,
+                          int iKey,
+                          size_t * pxProbes )
+{
+    const int * piBase = piSorted;
+    size_t xRemaining = xLength, xHalf, xIndex, xProbes = 0;
+
+    if( xLength == 0 )
+    {
+        if( pxProbes != NULL )
+        {
+            *pxProbes = 0;
+        }
+
+        return searchNOT_FOUND;
+    }
+
+    /* Narrow [ piBase, piBase + xRemaining ) to the first element not less
+     * than iKey.  The ternary compiles to a conditional move. */
+    while( xRemaining > 1 )
+    {
+        xHalf = xRemaining / 2;
+        xProbes++;
+        piBase = ( piBase[ xHalf ] < iKey ) ? &( piBase[ xHalf ] ) : piBase;
+        xRemaining -= xHalf;
+    }
+
+    xIndex = ( size_t ) ( piBase - piSorted ) + ( size_t ) ( *piBase < iKey );
+    xProbes++;
+
+    if( pxProbes != NULL )
+    {
+        *pxProbes = xProbes;
+    }
+
+    return ( ( xIndex < xLength ) && ( piSorted[ xIndex ] == iKey ) ) ? xIndex : searchNOT_FOUND;
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvEytzingerFill( const int * piSorted,
+                                size_t xLength,
+                                int * piEytzinger,
+                                size_t xNode,
+                                size_t xNext )
+{
+    /* In order traversal of the implicit tree: left subtree, node, right
+     * subtree receive consecutive sorted values.  Depth is log2( xLength ). */
+    if( xNode <= xLength )
+    {
+        xNext = prvEytzingerFill( piSorted, xLength, piEytzinger, 2 * xNode, xNext );
+        piEytzinger[ xNode ] = piSorted[ xNext++ ];
+        xNext = prvEytzingerFill( piSorted, xLength, piEytzinger, ( 2 * xNode ) + 1, xNext );
+    }
+
+    return xNext;
+}
+/*-----------------------------------------------------------*/
+
+void vSearchEytzingerBuild( const int * piSorted,
+                            size_t xLength,
+                            int * piEytzinger )
+{
+    piEytzinger[ 0 ] = 0;
+    ( void ) prvEytzingerFill( piSorted, xLength, piEytzinger, 1, 0 );
+}
+/*-----------------------------------------------------------*/
+
+size_t xSearchEytzinger( const int * piEytzinger,
+                         size_t xLength,
+                         int iKey,
+                         size_t * pxProbes )
+{
+    size_t xNode = 1, xProbes = 0;
+
+    while( xNode <= xLength )
+    {
+        /* The descendants searchPREFETCH_LEVELS down lie past the end of
+         * the array near the leaves.  Prefetching there is harmless, but
+         * forming such a pointer is not, so the address is computed as an
+         * integer. */
+        __builtin_prefetch( ( const void * ) ( ( uintptr_t ) piEytzinger + ( ( xNode << searchPREFETCH_LEVELS ) * sizeof( int ) ) ) );
+        xProbes++;
+        xNode = ( 2 * xNode ) + ( size_t ) ( piEytzinger[ xNode ] < iKey );
+    }
+
+    /* xNode went right at every level below the answer and left at the
+     * answer itself, so dropping the trailing ones and the final left turn
+     * gives the first element not less than iKey (0 if there is none). */
+    xNode >>= __builtin_ffsll( ( long long ) ~xNode );
+
+    if( pxProbes != NULL )
+    {
+        *pxProbes = xProbes;
+    }
+
+    return ( ( xNode != 0 ) && ( piEytzinger[ xNode ] == iKey ) ) ? xNode : searchNOT_FOUND;
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,194 @@
+/*
+ * Sensor frame conversion and statistics.  See ipsa_sensor.h.
+ */
+
+#include <string.h>
+
+#if defined( __AVX__ ) || defined( __SSE2__ )
+    #include <immintrin.h>
+#endif
+
+/* Local includes. */
+#include "ipsa_sensor.h"
+
+/* 5 / 9 in Q16.16, rounded to nearest.  The error is below 2e-6 degrees per
+ * degree Fahrenheit. */
+#define sensorFIVE_NINTHS_Q16    ( 36409 )
+
+/* Accumulators per statistic in vSensorStatsAddFrame(), one vector's worth
+ * of floats with AVX. */
+#define sensorSTATS_LANES        ( 8 )
+
+/* Type of the per lane sums.  A frame is short enough to be summed in single
+ * precision, which keeps the lanes as wide as the samples; Q16.16 sums need 64
+ * bits as soon as the readings are large. */
+#if ( ipsaSENSOR_FIXED_POINT == 1 )
+    typedef int64_t SensorLaneSum_t;
+#else
+    typedef float SensorLaneSum_t;
+#endif
+
+/*-----------------------------------------------------------*/
+
+void vSensorConvertFloat( const int32_t * plFahrenheit,
+                          float * pfCelsius,
+                          size_t xCount )
+{
+    size_t x = 0;
+
+    /* C = ( F - 32 ) * 5 / 9, several lanes at a time. */
+    #if defined( __AVX__ )
+    {
+        const __m256 xOffset = _mm256_set1_ps( 32.0f );
+        const __m256 xScale = _mm256_set1_ps( 5.0f / 9.0f );
+        __m256 xValues;
+
+        for( ; ( x + 8 ) <= xCount; x += 8 )
+        {
+            xValues = _mm256_cvtepi32_ps( _mm256_loadu_si256( ( const __m256i * ) &( plFahrenheit[ x ] ) ) );
+            _mm256_storeu_ps( &( pfCelsius[ x ] ), _mm256_mul_ps( _mm256_sub_ps( xValues, xOffset ), xScale ) );
+        }
+    }
+    #elif defined( __SSE2__ )
+    {
+        const __m128 xOffset = _mm_set1_ps( 32.0f );
+        const __m128 xScale = _mm_set1_ps( 5.0f / 9.0f );
+        __m128 xValues;
+
+        for( ; ( x + 4 ) <= xCount; x += 4 )
+        {
+            xValues = _mm_cvtepi32_ps( _mm_loadu_si128( ( const __m128i * ) &( plFahrenheit[ x ] ) ) );
+            _mm_storeu_ps( &( pfCelsius[ x ] ), _mm_mul_ps( _mm_sub_ps( xValues, xOffset ), xScale ) );
+        }
+    }
+    #endif /* if defined( __AVX__ ) */
+
+    for( ; x < xCount; x++ )
+    {
+        pfCelsius[ x ] = ( ( float ) plFahrenheit[ x ] - 32.0f ) * ( 5.0f / 9.0f );
+    }
+}
+/*-----------------------------------------------------------*/
+
+void vSensorConvertFixed( const int32_t * plFahrenheit,
+                          int32_t * plCelsius,
+                          size_t xCount )
+{
+    size_t x;
+
+    /* One multiply per sample.  A plain loop with no dependency between
+     * iterations, so the compiler vectorises it where it can. */
+    for( x = 0; x < xCount; x++ )
+    {
+        plCelsius[ x ] = ( plFahrenheit[ x ] - 32 ) * sensorFIVE_NINTHS_Q16;
+    }
+}
+/*-----------------------------------------------------------*/
+
+int32_t lSensorCentiCelsius( SensorCelsius_t xCelsius )
+{
+    #if ( ipsaSENSOR_FIXED_POINT == 1 )
+        return ( int32_t ) ( ( ( int64_t ) xCelsius * 100 ) / ( 1 << sensorFIXED_SHIFT ) );
+    #else
+        return ( int32_t ) ( xCelsius * 100.0f );
+    #endif
+}
+/*-----------------------------------------------------------*/
+
+void vSensorStatsReset( SensorStats_t * pxStats )
+{
+    memset( pxStats, 0, sizeof( *pxStats ) );
+}
+/*-----------------------------------------------------------*/
+
+void vSensorStatsAddFrame( SensorStats_t * pxStats,
+                           const SensorCelsius_t * pxCelsius,
+                           size_t xCount )
+{
+    SensorCelsius_t xMin[ sensorSTATS_LANES ], xMax[ sensorSTATS_LANES ];
+    SensorLaneSum_t xSum[ sensorSTATS_LANES ];
+    SensorSum_t xFrameSum = 0;
+    uint32_t ulSlot = pxStats->ulNextFrame;
+    size_t x, xLane;
+
+    /* Independent minimum, maximum and sum per lane, so the main loop has no
+     * dependency from one sample to the next and vectorises. */
+    for( xLane = 0; xLane < sensorSTATS_LANES; xLane++ )
+    {
+        xMin[ xLane ] = pxCelsius[ 0 ];
+        xMax[ xLane ] = pxCelsius[ 0 ];
+        xSum[ xLane ] = 0;
+    }
+
+    for( x = 0; ( x + sensorSTATS_LANES ) <= xCount; x += sensorSTATS_LANES )
+    {
+        for( xLane = 0; xLane < sensorSTATS_LANES; xLane++ )
+        {
+            xMin[ xLane ] = ( pxCelsius[ x + xLane ] < xMin[ xLane ] ) ? pxCelsius[ x + xLane ] : xMin[ xLane ];
+            xMax[ xLane ] = ( pxCelsius[ x + xLane ] > xMax[ xLane ] ) ? pxCelsius[ x + xLane ] : xMax[ xLane ];
+            xSum[ xLane ] += pxCelsius[ x + xLane ];
+        }
+    }
+
+    for( ; x < xCount; x++ )
+    {
+        xMin[ 0 ] = ( pxCelsius[ x ] < xMin[ 0 ] ) ? pxCelsius[ x ] : xMin[ 0 ];
+        xMax[ 0 ] = ( pxCelsius[ x ] > xMax[ 0 ] ) ? pxCelsius[ x ] : xMax[ 0 ];
+        xSum[ 0 ] += pxCelsius[ x ];
+    }
+
+    for( xLane = 0; xLane < sensorSTATS_LANES; xLane++ )
+    {
+        xMin[ 0 ] = ( xMin[ xLane ] < xMin[ 0 ] ) ? xMin[ xLane ] : xMin[ 0 ];
+        xMax[ 0 ] = ( xMax[ xLane ] > xMax[ 0 ] ) ? xMax[ xLane ] : xMax[ 0 ];
+        xFrameSum += xSum[ xLane ];
+    }
+
+    pxStats->xFrameMin[ ulSlot ] = xMin[ 0 ];
+    pxStats->xFrameMax[ ulSlot ] = xMax[ 0 ];
+    pxStats->xFrameSum[ ulSlot ] = xFrameSum;
+    pxStats->ulFrameSamples[ ulSlot ] = ( uint32_t ) xCount;
+
+    pxStats->ulNextFrame = ( ulSlot + 1U ) % sensorWINDOW_FRAMES;
+
+    if( pxStats->ulFrames < sensorWINDOW_FRAMES )
+    {
+        pxStats->ulFrames++;
+    }
+}
+/*-----------------------------------------------------------*/
+
+uint32_t ulSensorStatsGet( const SensorStats_t * pxStats,
+                           SensorCelsius_t * pxMin,
+                           SensorCelsius_t * pxMax,
+                           SensorCelsius_t * pxMean )
+{
+    SensorCelsius_t xMin, xMax;
+    SensorSum_t xSum = 0;
+    uint32_t ulSamples = 0, ul;
+
+    if( pxStats->ulFrames == 0 )
+    {
+        return 0;
+    }
+
+    /* Until the window has filled, the summaries are in slots
+     * 0 .. ulFrames - 1. */
+    xMin = pxStats->xFrameMin[ 0 ];
+    xMax = pxStats->xFrameMax[ 0 ];
+
+    for( ul = 0; ul < pxStats->ulFrames; ul++ )
+    {
+        xMin = ( pxStats->xFrameMin[ ul ] < xMin ) ? pxStats->xFrameMin[ ul ] : xMin;
+        xMax = ( pxStats->xFrameMax[ ul ] > xMax ) ? pxStats->xFrameMax[ ul ] : xMax;
+        xSum += pxStats->xFrameSum[ ul ];
+        ulSamples += pxStats->ulFrameSamples[ ul ];
+    }
+
+    *pxMin = xMin;
+    *pxMax = xMax;
+    *pxMean = ( SensorCelsius_t ) ( xSum / ( SensorSum_t ) ulSamples );
+
+    return ulSamples;
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,101 @@
+/*
+ * Block conversion of temperature sensor frames, and rolling statistics over
+ * the most recent frames, for the ipsa_sched sensor frame mode.
+ *
+ * A frame is a block of raw Fahrenheit readings.  Two conversions are
+ * provided, both of which work on whole blocks so the loop can be
+ * vectorised:
+ *   vSensorConvertFloat() - single precision, written with SSE or AVX
+ *                           intrinsics when the compiler targets them
+ *                           (-msse2 is the x86-64 default, -mavx doubles the
+ *                           width), with a scalar loop for the remainder and
+ *                           for other targets;
+ *   vSensorConvertFixed() - Q16.16 fixed point using only integer multiplies
+ *                           and shifts, for targets without an FPU.
+ * Set ipsaSENSOR_FIXED_POINT to 1 to make SensorCelsius_t, vSensorConvert()
+ * and the statistics use the fixed point path.  sensor_bench.c compares both
+ * with the per sample dWorkloadTemperature().
+ *
+ * Nothing here calls the kernel, so the host benchmark uses it as is.
+ */
+
+#ifndef IPSA_SENSOR_H
+#define IPSA_SENSOR_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef ipsaSENSOR_FIXED_POINT
+    #define ipsaSENSOR_FIXED_POINT    0
+#endif
+
+/* Readings per frame, and number of frames the rolling statistics cover. */
+#define sensorFRAME_SAMPLES           ( 64 )
+#define sensorWINDOW_FRAMES           ( 16 )
+
+/* Fractional bits of the fixed point format. */
+#define sensorFIXED_SHIFT             ( 16 )
+
+#if ( ipsaSENSOR_FIXED_POINT == 1 )
+    typedef int32_t SensorCelsius_t; /* Q16.16 degrees. */
+    typedef int64_t SensorSum_t;
+    #define vSensorConvert            vSensorConvertFixed
+#else
+    typedef float SensorCelsius_t;
+    typedef double SensorSum_t;
+    #define vSensorConvert            vSensorConvertFloat
+#endif
+
+/*
+ * Rolling minimum, maximum and mean of the samples in the last
+ * sensorWINDOW_FRAMES frames.  Each frame is summarised when it is added, so
+ * a query costs sensorWINDOW_FRAMES steps whatever the frame size.
+ */
+typedef struct SensorStats
+{
+    SensorCelsius_t xFrameMin[ sensorWINDOW_FRAMES ];
+    SensorCelsius_t xFrameMax[ sensorWINDOW_FRAMES ];
+    SensorSum_t xFrameSum[ sensorWINDOW_FRAMES ];
+    uint32_t ulFrameSamples[ sensorWINDOW_FRAMES ];
+    uint32_t ulNextFrame;  /* Slot the next frame summary goes to. */
+    uint32_t ulFrames;     /* Frames added so far, saturating at sensorWINDOW_FRAMES. */
+} SensorStats_t;
+
+/*
+ * Convert xCount Fahrenheit readings to degrees Celsius.  The fixed point
+ * version expects readings within +/-32767.
+ */
+void vSensorConvertFloat( const int32_t * plFahrenheit,
+                          float * pfCelsius,
+                          size_t xCount );
+
+void vSensorConvertFixed( const int32_t * plFahrenheit,
+                          int32_t * plCelsius,
+                          size_t xCount );
+
+/*
+ * Hundredths of a degree, rounded towards zero, for printing without
+ * floating point.
+ */
+int32_t lSensorCentiCelsius( SensorCelsius_t xCelsius );
+
+void vSensorStatsReset( SensorStats_t * pxStats );
+
+/*
+ * Replace the oldest frame of the window with the xCount converted samples at
+ * pxCelsius.  xCount must not be zero.
+ */
+void vSensorStatsAddFrame( SensorStats_t * pxStats,
+                           const SensorCelsius_t * pxCelsius,
+                           size_t xCount );
+
+/*
+ * Return the number of samples in the window and, if it is not zero, their
+ * minimum, maximum and mean.
+ */
+uint32_t ulSensorStatsGet( const SensorStats_t * pxStats,
+                           SensorCelsius_t * pxMin,
+                           SensorCelsius_t * pxMax,
+                           SensorCelsius_t * pxMean );
+
+#endif /* IPSA_SENSOR_H */
@@ -0,0 +1,108 @@
+/*
+ * Lock free single producer / single consumer ring of IpsaMessage_t, for
+ * passing messages between two threads on different cores.
+ *
+ * The write index is only written by the producer and the read index only by
+ * the consumer, each on its own cache line, so a push or a pop is a copy and
+ * one release store, with no read-modify-write instruction.  Each side also
+ * keeps its own copy of the other side's index and only reads the shared one
+ * again when that copy says the ring is full (or empty), so in the steady
+ * state the cache line of the other index is not pulled across cores on
+ * every message.  A push to a full ring fails; counting or retrying is left
+ * to the caller.
+ *
+ * Exactly one thread may push and one thread may pop.  Nothing here depends
+ * on the kernel.
+ */
+
+#ifndef IPSA_SPSC_H
+#define IPSA_SPSC_H
+
+#include <stdint.h>
+
+/* Local includes. */
+#include "ipsa_message.h"
+
+#define spscCACHE_LINE    ( 64 )
+
+typedef struct SpscRing
+{
+    /* Producer side. */
+    uint32_t ulWriteIndex __attribute__( ( aligned( spscCACHE_LINE ) ) );
+    uint32_t ulReadCopy;     /* The producer's last view of ulReadIndex. */
+
+    /* Consumer side. */
+    uint32_t ulReadIndex __attribute__( ( aligned( spscCACHE_LINE ) ) );
+    uint32_t ulWriteCopy;    /* The consumer's last view of ulWriteIndex. */
+
+    /* Read only once set up. */
+    IpsaMessage_t * pxSlots __attribute__( ( aligned( spscCACHE_LINE ) ) );
+    uint32_t ulMask;
+} SpscRing_t;
+
+/*
+ * Set up a ring over ulLength slots at pxSlots.  ulLength must be a power of
+ * two.  Must be called before either thread uses the ring.
+ */
+static inline void vSpscInit( SpscRing_t * pxRing,
+                              IpsaMessage_t * pxSlots,
+                              uint32_t ulLength )
+{
+    pxRing->ulWriteIndex = 0;
+    pxRing->ulReadCopy = 0;
+    pxRing->ulReadIndex = 0;
+    pxRing->ulWriteCopy = 0;
+    pxRing->pxSlots = pxSlots;
+    pxRing->ulMask = ulLength - 1U;
+}
+
+/*
+ * Producer only.  Returns 1 if the message was stored, 0 if the ring is full.
+ */
+static inline int iSpscPush( SpscRing_t * pxRing,
+                             const IpsaMessage_t * pxMessage )
+{
+    uint32_t ulWrite = pxRing->ulWriteIndex;
+
+    if( ( ulWrite - pxRing->ulReadCopy ) > pxRing->ulMask )
+    {
+        pxRing->ulReadCopy = __atomic_load_n( &( pxRing->ulReadIndex ), __ATOMIC_ACQUIRE );
+
+        if( ( ulWrite - pxRing->ulReadCopy ) > pxRing->ulMask )
+        {
+            return 0;
+        }
+    }
+
+    pxRing->pxSlots[ ulWrite & pxRing->ulMask ] = *pxMessage;
+    __atomic_store_n( &( pxRing->ulWriteIndex ), ulWrite + 1U, __ATOMIC_RELEASE );
+
+    return 1;
+}
+
+/*
+ * Consumer only.  Returns 1 and copies the oldest message to pxMessage, or 0
+ * if the ring is empty.
+ */
+static inline int iSpscPop( SpscRing_t * pxRing,
+                            IpsaMessage_t * pxMessage )
+{
+    uint32_t ulRead = pxRing->ulReadIndex;
+
+    if( ulRead == pxRing->ulWriteCopy )
+    {
+        pxRing->ulWriteCopy = __atomic_load_n( &( pxRing->ulWriteIndex ), __ATOMIC_ACQUIRE );
+
+        if( ulRead == pxRing->ulWriteCopy )
+        {
+            return 0;
+        }
+    }
+
+    *pxMessage = pxRing->pxSlots[ ulRead & pxRing->ulMask ];
+    __atomic_store_n( &( pxRing->ulReadIndex ), ulRead + 1U, __ATOMIC_RELEASE );
+
+    return 1;
+}
+
+#endif /* IPSA_SPSC_H */
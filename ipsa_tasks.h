@@ -0,0 +1,47 @@
+/*
+ * Timing model of the ipsa_sched tasks, for the schedulability analysis in
+ * sched_analyze.c.
+ *
+ * ipsaTASK_TABLE( X ) expands X once per task with:
+ *   xId          - identifier, used for the generated priority macro
+ *                  priority<xId> in ipsa_priorities.h;
+ *   pcName       - the task name given to the kernel, used to match the
+ *                  task in the "cpu," lines printed by ipsa_sched.c;
+ *   ulPeriodMs   - period, or for a task released by messages the period
+ *                  of the send task;
+ *   ulTimerMs    - for a task also released by the software timer's
+ *                  messages, the timer period, otherwise 0;
+ *   ulDeadlineMs - relative deadline, at most the periods;
+ *   xAssigned    - 1 if the analysis chooses the priority, 0 for a task
+ *                  whose priority is fixed above all of them (the timer
+ *                  daemon runs at configTIMER_TASK_PRIORITY);
+ *   pcKernel     - the wcet_bench.c kernel the task runs on each release,
+ *                  or "" for none;
+ *   ulCostUs     - execution time per release on top of the kernel: the
+ *                  kernel calls and the console output.
+ *
+ * This describes ipsa_sched.c built with mainUSE_ANALYZED_PRIORITIES, which
+ * needs mainUSE_BROADCAST: every value from the send task and from the timer
+ * releases every receive task, so a receive task is modelled with both
+ * periods and the cost of both the "is working" message and its workload.
+ * On the shared queue the tasks would not be released at these rates at
+ * all, as the highest priority one would take every value.  Keep it in step
+ * with the periods in ipsa_sched.c.  The service tasks added by the optional
+ * modes are not modelled.  Nothing here depends on the kernel.
+ */
+
+#ifndef IPSA_TASKS_H
+#define IPSA_TASKS_H
+
+/* *INDENT-OFF* */
+#define ipsaTASK_TABLE( X )                                                                \
+    /* xId      pcName      Period   Timer   Deadline   Assigned   Kernel          Cost */ \
+    X( TIMER,   "Tmr Svc",  2000,    0,      2000,      0,         "",             20 )    \
+    X( TX,      "TX",       1000,    0,      1000,      1,         "",             20 )    \
+    X( TASK_1,  "Task 1",   1000,    2000,   1000,      1,         "",             100 )   \
+    X( TASK_2,  "Task 2",   1000,    2000,   1000,      1,         "temperature",  100 )   \
+    X( TASK_3,  "Task 3",   1000,    2000,   1000,      1,         "multiply",     100 )   \
+    X( TASK_4,  "Task 4",   1000,    2000,   1000,      1,         "search",       100 )
+/* *INDENT-ON* */
+
+#endif /* IPSA_TASKS_H */
@@ -0,0 +1,185 @@
+/*
+ * Idle tick suppression for the Linux port.  See ipsa_tickless.h.
+ *
+ * The Linux port generates the tick with setitimer( ITIMER_REAL ) and handles
+ * it on SIGALRM, and portDISABLE_INTERRUPTS() blocks that signal, so with
+ * interrupts disabled the tick count cannot move while it is being adjusted
+ * here.  A SIGALRM raised meanwhile stays pending, which is also what lets
+ * the tickless idle mode wait for it with sigtimedwait() without the port's
+ * handler running.
+ */
+
+#include <signal.h>
+#include <sys/time.h>
+
+/* Kernel includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Local includes. */
+#include "ipsa_clock.h"
+#include "ipsa_tickless.h"
+
+#define ticklessTICK_US    ( 1000000ULL / configTICK_RATE_HZ )
+
+/*-----------------------------------------------------------*/
+
+static uint64_t ullSuppressedTicks = 0;
+static uint32_t ulSleeps = 0;
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Arm the port's tick timer to expire in ullFirstUs, then every tick.
+ */
+static void prvArmTickTimer( uint64_t ullFirstUs )
+{
+    struct itimerval xTimer;
+
+    xTimer.it_value.tv_sec = ( time_t ) ( ullFirstUs / 1000000ULL );
+    xTimer.it_value.tv_usec = ( suseconds_t ) ( ullFirstUs % 1000000ULL );
+    xTimer.it_interval.tv_sec = 0;
+    xTimer.it_interval.tv_usec = ( suseconds_t ) ticklessTICK_US;
+
+    ( void ) setitimer( ITIMER_REAL, &xTimer, NULL );
+}
+/*-----------------------------------------------------------*/
+
+#if ( defined( ipsaTICKLESS_IDLE ) && ( ipsaTICKLESS_IDLE == 1 ) )
+
+    static void prvSleep( TickType_t xExpectedIdleTime )
+    {
+        static const struct itimerval xDisarm = { { 0, 0 }, { 0, 0 } };
+        static const struct timespec xNoWait = { 0, 0 };
+        struct itimerval xTimer;
+        struct timespec xTimeout;
+        sigset_t xAlarm;
+        uint64_t ullToBoundaryUs, ullSleepUs, ullSleptUs, ullStartNs;
+        TickType_t xPassed;
+
+        if( xExpectedIdleTime > ipsaTICKLESS_MAX_IDLE_TICKS )
+        {
+            xExpectedIdleTime = ipsaTICKLESS_MAX_IDLE_TICKS;
+        }
+
+        if( getitimer( ITIMER_REAL, &xTimer ) != 0 )
+        {
+            return;
+        }
+
+        /* The next tick is ullToBoundaryUs away, and the release
+         * xExpectedIdleTime - 1 ticks after that. */
+        ullToBoundaryUs = ( ( uint64_t ) xTimer.it_value.tv_sec * 1000000ULL ) + ( uint64_t ) xTimer.it_value.tv_usec;
+        ullSleepUs = ullToBoundaryUs + ( ( uint64_t ) ( xExpectedIdleTime - 1U ) * ticklessTICK_US );
+
+        sigemptyset( &xAlarm );
+        sigaddset( &xAlarm, SIGALRM );
+
+        ullStartNs = ullIpsaClockNs();
+        prvArmTickTimer( ullSleepUs );
+
+        /* Wait one tick longer than planned, in case the timer is slack. */
+        xTimeout.tv_sec = ( time_t ) ( ( ullSleepUs + ticklessTICK_US ) / 1000000ULL );
+        xTimeout.tv_nsec = ( long ) ( ( ( ullSleepUs + ticklessTICK_US ) % 1000000ULL ) * 1000ULL );
+        ( void ) sigtimedwait( &xAlarm, NULL, &xTimeout );
+
+        /* Stop the timer and drop an expiry that came after the wait, so
+         * the only tick left to deliver is the one armed below. */
+        ( void ) setitimer( ITIMER_REAL, &xDisarm, NULL );
+        ( void ) sigtimedwait( &xAlarm, NULL, &xNoWait );
+
+        ullSleptUs = ( ullIpsaClockNs() - ullStartNs ) / 1000ULL;
+        xPassed = ( ullSleptUs >= ullToBoundaryUs ) ? ( TickType_t ) ( 1U + ( ( ullSleptUs - ullToBoundaryUs ) / ticklessTICK_US ) ) : 0U;
+
+        if( xPassed >= xExpectedIdleTime )
+        {
+            /* Reached the release: step to one tick short of it and deliver
+             * the last tick now. */
+            xPassed = xExpectedIdleTime - 1U;
+            prvArmTickTimer( 1U );
+        }
+        else if( xPassed == 0U )
+        {
+            prvArmTickTimer( ullToBoundaryUs - ullSleptUs );
+        }
+        else
+        {
+            /* Woken early: resume the tick at the next tick boundary. */
+            prvArmTickTimer( ticklessTICK_US - ( ( ullSleptUs - ullToBoundaryUs ) % ticklessTICK_US ) );
+        }
+
+        if( xPassed > 0U )
+        {
+            vTaskStepTick( xPassed );
+            ullSuppressedTicks += xPassed;
+        }
+    }
+
+#else /* ipsaTICKLESS_IDLE */
+
+    static void prvSleep( TickType_t xExpectedIdleTime )
+    {
+        TickType_t xTicksToJump;
+
+        /* Stop one tick short of the next release: the tick that reaches it
+         * must go through xTaskIncrementTick() so the task or timer is
+         * unblocked by the normal path. */
+        xTicksToJump = xExpectedIdleTime - 1U;
+
+        if( xTicksToJump > 0U )
+        {
+            vTaskStepTick( xTicksToJump );
+            ullSuppressedTicks += xTicksToJump;
+        }
+
+        /* Bring the final tick forward. */
+        prvArmTickTimer( 1U );
+    }
+
+#endif /* ipsaTICKLESS_IDLE */
+/*-----------------------------------------------------------*/
+
+void vIpsaSuppressTicksAndSleep( uint32_t ulExpectedIdleTime )
+{
+    eSleepModeStatus eStatus;
+
+    portDISABLE_INTERRUPTS();
+
+    /* A task may have been readied, or a context switch pended, between the
+     * idle task deciding to sleep and interrupts being disabled.  With no task
+     * waiting on a timeout there is no next release to jump to, but the
+     * tickless idle mode can still sleep for its longest period. */
+    eStatus = eTaskConfirmSleepModeStatus();
+
+    if( ( eStatus == eAbortSleep ) || ( ulExpectedIdleTime < 2U ) )
+    {
+        portENABLE_INTERRUPTS();
+        return;
+    }
+
+    #if ( !defined( ipsaTICKLESS_IDLE ) || ( ipsaTICKLESS_IDLE != 1 ) )
+        if( eStatus != eStandardSleep )
+        {
+            portENABLE_INTERRUPTS();
+            return;
+        }
+    #endif
+
+    prvSleep( ( TickType_t ) ulExpectedIdleTime );
+    ulSleeps++;
+
+    portENABLE_INTERRUPTS();
+}
+/*-----------------------------------------------------------*/
+
+uint64_t ullIpsaTicklessGetSuppressedTicks( void )
+{
+    return ullSuppressedTicks;
+}
+/*-----------------------------------------------------------*/
+
+uint32_t ulIpsaTicklessGetSleeps( void )
+{
+    return ulSleeps;
+}
+/*-----------------------------------------------------------*/
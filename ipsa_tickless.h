@@ -0,0 +1,81 @@
+/*
+ * Idle tick suppression for the ipsa_sched demo on the FreeRTOS Linux port.
+ *
+ * The kernel calls portSUPPRESS_TICKS_AND_SLEEP() from the idle task when no
+ * task will be ready for at least configEXPECTED_IDLE_TIME_BEFORE_SLEEP ticks.
+ * This file provides that hook, in one of two modes.
+ *
+ * Tickless idle (ipsaTICKLESS_IDLE set to 1):
+ * The port's tick timer is re-armed to expire on the tick of the next delay
+ * or timer expiry, and the idle thread sleeps until then instead of taking a
+ * signal every tick.  On waking the tick count is stepped over the ticks
+ * that passed, one short of the release, and the final tick is delivered
+ * through the normal tick interrupt path so the task or timer is released
+ * exactly as it would be with the tick running.  If the thread is woken
+ * early the tick count is stepped by the whole ticks that did pass and the
+ * tick resumes at the next tick boundary.  Sleeps are capped at
+ * ipsaTICKLESS_MAX_IDLE_TICKS, which bounds how long a key press waits for
+ * the tick hook to see it.
+ *
+ * Virtual time (ipsaVIRTUAL_TIME set to 1):
+ * Instead of waiting for the idle period to pass, the tick count jumps to one
+ * tick before the next delay or timer expiry, and the port's tick timer is
+ * re-armed to deliver the final tick straight away.  That tick runs through
+ * the normal tick interrupt path, so tasks and timers are released in exactly
+ * the order they would be in real time, at the same tick counts, while a
+ * one second period costs microseconds of wall clock time.  Only idle time is
+ * skipped: time spent running tasks still advances the tick at the real rate.
+ * Values read from ullIpsaClockNs() are wall clock times and are meaningless
+ * against the virtual tick count in this mode.
+ *
+ * To enable either mode add, for example,
+ *
+ *     #define ipsaTICKLESS_IDLE    1
+ *     #include "ipsa_tickless.h"
+ *
+ * at the end of FreeRTOSConfig.h, and build ipsa_tickless.c with the demo.
+ */
+
+#ifndef IPSA_TICKLESS_H
+#define IPSA_TICKLESS_H
+
+#include <stdint.h>
+
+/* Longest single sleep in tickless idle mode. */
+#ifndef ipsaTICKLESS_MAX_IDLE_TICKS
+    #define ipsaTICKLESS_MAX_IDLE_TICKS    ( 1000U )
+#endif
+
+#if ( ( defined( ipsaVIRTUAL_TIME ) && ( ipsaVIRTUAL_TIME == 1 ) ) || \
+    ( defined( ipsaTICKLESS_IDLE ) && ( ipsaTICKLESS_IDLE == 1 ) ) )
+
+    #if ( ( defined( ipsaVIRTUAL_TIME ) && ( ipsaVIRTUAL_TIME == 1 ) ) && \
+    ( defined( ipsaTICKLESS_IDLE ) && ( ipsaTICKLESS_IDLE == 1 ) ) )
+        #error Set only one of ipsaVIRTUAL_TIME and ipsaTICKLESS_IDLE
+    #endif
+
+    #undef configUSE_TICKLESS_IDLE
+    #define configUSE_TICKLESS_IDLE    2 /* Tick suppression provided by the application. */
+
+    #define portSUPPRESS_TICKS_AND_SLEEP( xExpectedIdleTime )    vIpsaSuppressTicksAndSleep( xExpectedIdleTime )
+
+#endif
+
+/*
+ * The portSUPPRESS_TICKS_AND_SLEEP() implementation.  Called by the idle task
+ * with the scheduler suspended.
+ */
+void vIpsaSuppressTicksAndSleep( uint32_t ulExpectedIdleTime );
+
+/*
+ * Total number of ticks that were not processed one by one because the
+ * system was idle.
+ */
+uint64_t ullIpsaTicklessGetSuppressedTicks( void );
+
+/*
+ * Number of times the idle task slept, or jumped, over suppressed ticks.
+ */
+uint32_t ulIpsaTicklessGetSleeps( void );
+
+#endif /* IPSA_TICKLESS_H */
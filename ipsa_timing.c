@@ -0,0 +1,173 @@
+/*
+ * Drift free periodic timing.  See ipsa_timing.h.
+ */
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/timerfd.h>
+
+#if ( defined( __x86_64__ ) )
+    #include <cpuid.h>
+#endif
+
+/* Local includes. */
+#include "ipsa_timing.h"
+
+TimingTsc_t xTimingTsc;
+
+/*-----------------------------------------------------------*/
+
+static struct timespec prvToTimespec( uint64_t ullNs )
+{
+    struct timespec xTime;
+
+    xTime.tv_sec = ( time_t ) ( ullNs / 1000000000ULL );
+    xTime.tv_nsec = ( long ) ( ullNs % 1000000000ULL );
+
+    return xTime;
+}
+/*-----------------------------------------------------------*/
+
+int iTimingCalibrateTsc( uint32_t ulMs )
+{
+    #if ( timingHAVE_TSC == 1 )
+        unsigned int uxEax, uxEbx, uxEcx, uxEdx;
+        uint64_t ullStartNs, ullStartTsc, ullEndNs, ullEndTsc;
+        struct timespec xPause = prvToTimespec( ( uint64_t ) ulMs * 1000000ULL );
+
+        /* CPUID 0x80000007 EDX bit 8: the TSC runs at a constant rate in
+         * every power state. */
+        if( ( __get_cpuid( 0x80000007U, &uxEax, &uxEbx, &uxEcx, &uxEdx ) == 0 ) || ( ( uxEdx & ( 1U << 8 ) ) == 0U ) )
+        {
+            return -1;
+        }
+
+        xTimingTsc.iEnabled = 0;
+
+        ullStartNs = ullTimingMonotonicNs();
+        ullStartTsc = __rdtsc();
+        ( void ) nanosleep( &xPause, NULL );
+        ullEndNs = ullTimingMonotonicNs();
+        ullEndTsc = __rdtsc();
+
+        if( ullEndTsc <= ullStartTsc )
+        {
+            return -1;
+        }
+
+        xTimingTsc.ullMult = ( uint64_t ) ( ( ( unsigned __int128 ) ( ullEndNs - ullStartNs ) << 32 ) / ( ullEndTsc - ullStartTsc ) );
+        xTimingTsc.ullBaseNs = ullEndNs;
+        xTimingTsc.ullBaseTsc = ullEndTsc;
+        xTimingTsc.iEnabled = 1;
+
+        return 0;
+    #else /* if ( timingHAVE_TSC == 1 ) */
+        ( void ) ulMs;
+
+        return -1;
+    #endif /* if ( timingHAVE_TSC == 1 ) */
+}
+/*-----------------------------------------------------------*/
+
+int iTimingStart( Timing_t * pxTiming,
+                  TimingMethod_t eMethod,
+                  uint64_t ullPeriodNs )
+{
+    struct itimerspec xSpec;
+
+    if( ullPeriodNs == 0U )
+    {
+        errno = EINVAL;
+        return -1;
+    }
+
+    memset( pxTiming, 0, sizeof( *pxTiming ) );
+    pxTiming->eMethod = eMethod;
+    pxTiming->ullPeriodNs = ullPeriodNs;
+    pxTiming->ullNextNs = ullTimingMonotonicNs() + ullPeriodNs;
+    pxTiming->iTimerFd = -1;
+
+    if( eMethod == eTimingTimerfd )
+    {
+        pxTiming->iTimerFd = timerfd_create( CLOCK_MONOTONIC, TFD_CLOEXEC );
+
+        if( pxTiming->iTimerFd < 0 )
+        {
+            return -1;
+        }
+
+        /* Armed on the absolute time of the first release, so the releases
+         * are start + k * period whenever they are read. */
+        xSpec.it_value = prvToTimespec( pxTiming->ullNextNs );
+        xSpec.it_interval = prvToTimespec( ullPeriodNs );
+
+        if( timerfd_settime( pxTiming->iTimerFd, TFD_TIMER_ABSTIME, &xSpec, NULL ) != 0 )
+        {
+            ( void ) close( pxTiming->iTimerFd );
+            pxTiming->iTimerFd = -1;
+            return -1;
+        }
+    }
+
+    return 0;
+}
+/*-----------------------------------------------------------*/
+
+uint64_t ullTimingWait( Timing_t * pxTiming )
+{
+    struct timespec xDeadline;
+    uint64_t ullNowNs, ullPassed, ullExpirations;
+    ssize_t xRead;
+
+    if( pxTiming->eMethod == eTimingTimerfd )
+    {
+        /* Blocks until at least one release has passed, and says how many. */
+        do
+        {
+            xRead = read( pxTiming->iTimerFd, &ullExpirations, sizeof( ullExpirations ) );
+        } while( ( xRead < 0 ) && ( errno == EINTR ) );
+
+        if( ( xRead != ( ssize_t ) sizeof( ullExpirations ) ) || ( ullExpirations == 0U ) )
+        {
+            ullExpirations = 1;
+        }
+
+        pxTiming->ullOverruns += ullExpirations - 1U;
+        pxTiming->ullNextNs += ( ullExpirations - 1U ) * pxTiming->ullPeriodNs;
+    }
+    else
+    {
+        ullNowNs = ullTimingMonotonicNs();
+
+        if( ullNowNs >= pxTiming->ullNextNs + pxTiming->ullPeriodNs )
+        {
+            /* Later releases have passed too: keep to the latest. */
+            ullPassed = ( ullNowNs - pxTiming->ullNextNs ) / pxTiming->ullPeriodNs;
+            pxTiming->ullOverruns += ullPassed;
+            pxTiming->ullNextNs += ullPassed * pxTiming->ullPeriodNs;
+        }
+
+        xDeadline = prvToTimespec( pxTiming->ullNextNs );
+
+        while( clock_nanosleep( CLOCK_MONOTONIC, TIMER_ABSTIME, &xDeadline, NULL ) == EINTR )
+        {
+        }
+    }
+
+    pxTiming->ullReleases++;
+    pxTiming->ullNextNs += pxTiming->ullPeriodNs;
+
+    return pxTiming->ullNextNs - pxTiming->ullPeriodNs;
+}
+/*-----------------------------------------------------------*/
+
+void vTimingStop( Timing_t * pxTiming )
+{
+    if( pxTiming->iTimerFd >= 0 )
+    {
+        ( void ) close( pxTiming->iTimerFd );
+        pxTiming->iTimerFd = -1;
+    }
+}
+/*-----------------------------------------------------------*/
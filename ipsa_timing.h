@@ -0,0 +1,113 @@
+/*
+ * Drift free periodic timing for host programs.
+ *
+ * A relative sleep( period ) loop drifts: each period also includes the time
+ * spent working and the lateness of the previous wake up, and the error only
+ * ever adds up.  Here every release has an absolute deadline on
+ * CLOCK_MONOTONIC, start + k * period, so a late wake up delays that release
+ * only.  Two ways to wait for it:
+ *   eTimingNanosleep - clock_nanosleep( TIMER_ABSTIME ) to the deadline;
+ *   eTimingTimerfd   - a periodic timerfd, armed once on an absolute start
+ *                      time; a read() also says how many releases passed,
+ *                      so overruns are counted by the kernel.
+ * Releases that have already passed when the caller comes back to wait are
+ * counted in ullOverruns and not run again, so an overrun costs the missed
+ * releases, not the schedule.
+ *
+ * ullTimingNowNs() is a clock for timestamps: CLOCK_MONOTONIC, or, once
+ * iTimingCalibrateTsc() has succeeded, the time stamp counter scaled to
+ * nanoseconds, which is cheaper to read.  The TSC is only used when the CPU
+ * says it runs at a constant rate.
+ *
+ * This file has no kernel dependency.  timing_bench.c compares the drift and
+ * jitter of sleep(), both methods here and, through ipsa_timing_bench.c, the
+ * RTOS vTaskDelayUntil().
+ */
+
+#ifndef IPSA_TIMING_H
+#define IPSA_TIMING_H
+
+#include <stdint.h>
+#include <time.h>
+
+#if defined( __x86_64__ )
+    #include <x86intrin.h>
+    #define timingHAVE_TSC    1
+#else
+    #define timingHAVE_TSC    0
+#endif
+
+typedef enum
+{
+    eTimingNanosleep = 0,
+    eTimingTimerfd
+} TimingMethod_t;
+
+typedef struct Timing
+{
+    TimingMethod_t eMethod;
+    uint64_t ullPeriodNs;
+    uint64_t ullNextNs;     /* CLOCK_MONOTONIC deadline of the next release. */
+    int iTimerFd;           /* eTimingTimerfd only. */
+    uint64_t ullReleases;   /* Releases returned by ullTimingWait(). */
+    uint64_t ullOverruns;   /* Releases that had passed before they were waited for. */
+} Timing_t;
+
+/* Conversion from TSC ticks to ns, set by iTimingCalibrateTsc(). */
+typedef struct TimingTsc
+{
+    int iEnabled;
+    uint64_t ullBaseTsc;
+    uint64_t ullBaseNs;
+    uint64_t ullMult;       /* ns per tick, as a 32.32 fixed point number. */
+} TimingTsc_t;
+
+extern TimingTsc_t xTimingTsc;
+
+static inline uint64_t ullTimingMonotonicNs( void )
+{
+    struct timespec xNow;
+
+    clock_gettime( CLOCK_MONOTONIC, &xNow );
+
+    return ( ( uint64_t ) xNow.tv_sec * 1000000000ULL ) + ( uint64_t ) xNow.tv_nsec;
+}
+
+static inline uint64_t ullTimingNowNs( void )
+{
+    #if ( timingHAVE_TSC == 1 )
+        if( xTimingTsc.iEnabled != 0 )
+        {
+            return xTimingTsc.ullBaseNs +
+                   ( uint64_t ) ( ( ( unsigned __int128 ) ( __rdtsc() - xTimingTsc.ullBaseTsc ) * xTimingTsc.ullMult ) >> 32 );
+        }
+    #endif
+
+    return ullTimingMonotonicNs();
+}
+
+/*
+ * Measure the TSC rate against CLOCK_MONOTONIC over about ulMs milliseconds
+ * and switch ullTimingNowNs() to it.  Returns 0 on success, -1 if there is no
+ * constant rate TSC, in which case ullTimingNowNs() stays on the clock.
+ */
+int iTimingCalibrateTsc( uint32_t ulMs );
+
+/*
+ * Start a release sequence with the given period.  The first release is one
+ * period from now.  Returns 0, or -1 with errno set.
+ */
+int iTimingStart( Timing_t * pxTiming,
+                  TimingMethod_t eMethod,
+                  uint64_t ullPeriodNs );
+
+/*
+ * Wait for the next release and return its deadline, in CLOCK_MONOTONIC ns.
+ * Returns at once, with the latest release that has passed, if the caller is
+ * late.
+ */
+uint64_t ullTimingWait( Timing_t * pxTiming );
+
+void vTimingStop( Timing_t * pxTiming );
+
+#endif /* IPSA_TIMING_H */
@@ -0,0 +1,128 @@
+/*
+ * The RTOS side of timing_bench.c: drift and jitter of a periodic task
+ * released with vTaskDelay() and with vTaskDelayUntil(), as prvQueueSendTask()
+ * and the receive tasks in ipsa_sched.c are.
+ *
+ * ipsa_timing_bench() is called from main() in place of ipsa_sched().  A task
+ * at the highest priority spins for benchWORK_US, then waits for the next
+ * period, benchPERIODS times with each method.  Lateness is measured on
+ * CLOCK_MONOTONIC from the ideal release time start + k * period, so it
+ * includes the error of the port's tick timer against the host clock as well
+ * as the wake up latency.  The results are printed as CSV with the columns of
+ * timing_bench.c, so the two outputs can be put side by side.  Overruns are
+ * the releases xTaskDelayUntil() found had already passed.
+ */
+
+#include <stdio.h>
+
+/* Kernel includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Local includes. */
+#include "console.h"
+#include "ipsa_clock.h"
+#include "ipsa_hist.h"
+
+#define benchTASK_PRIORITY    ( configMAX_PRIORITIES - 1 )
+
+#define benchPERIOD           pdMS_TO_TICKS( 1UL )
+#define benchPERIODS          ( 10000UL )
+#define benchWORK_US          ( 100ULL )
+
+#define benchPERIOD_NS        ( ( uint64_t ) benchPERIOD * ( 1000000000ULL / configTICK_RATE_HZ ) )
+
+/*-----------------------------------------------------------*/
+
+static void prvTimingTask( void * pvParameters );
+
+/*
+ * Run benchPERIODS periods with vTaskDelayUntil() if xAbsolute is pdTRUE,
+ * else with vTaskDelay(), and print one line of results.
+ */
+static void prvRun( BaseType_t xAbsolute );
+
+/*-----------------------------------------------------------*/
+
+static Histogram_t xLateness;
+
+/*-----------------------------------------------------------*/
+
+void ipsa_timing_bench( void )
+{
+    xTaskCreate( prvTimingTask, "Timing", configMINIMAL_STACK_SIZE * 2, NULL, benchTASK_PRIORITY, NULL );
+
+    vTaskStartScheduler();
+
+    /* Only reached if there was not enough heap for the idle task. */
+    for( ; ; )
+    {
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvTimingTask( void * pvParameters )
+{
+    ( void ) pvParameters;
+
+    console_print( "method,periods,period_us,overruns,drift_us,p50_late_us,p99_late_us,max_late_us\n" );
+
+    prvRun( pdFALSE );
+    prvRun( pdTRUE );
+
+    console_print( "Timing benchmark done\n" );
+    vTaskDelete( NULL );
+}
+/*-----------------------------------------------------------*/
+
+static void prvRun( BaseType_t xAbsolute )
+{
+    TickType_t xLastRelease;
+    uint64_t ullStartNs, ullIdealNs, ullLateNs = 0, ullWorkEndNs;
+    uint32_t ulOverruns = 0;
+    uint32_t ul;
+
+    vHistogramReset( &xLateness );
+
+    /* Start on a tick, so the first release is a whole period away. */
+    vTaskDelay( 1 );
+    xLastRelease = xTaskGetTickCount();
+    ullStartNs = ullIpsaClockNs();
+
+    for( ul = 1; ul <= benchPERIODS; ul++ )
+    {
+        if( xAbsolute != pdFALSE )
+        {
+            if( xTaskDelayUntil( &xLastRelease, benchPERIOD ) == pdFALSE )
+            {
+                ulOverruns++;
+            }
+        }
+        else
+        {
+            vTaskDelay( benchPERIOD );
+        }
+
+        ullIdealNs = ullStartNs + ( ( uint64_t ) ul * benchPERIOD_NS );
+        ullLateNs = ullIpsaClockNs();
+        ullLateNs = ( ullLateNs > ullIdealNs ) ? ullLateNs - ullIdealNs : 0U;
+        vHistogramRecord( &xLateness, ullLateNs );
+
+        ullWorkEndNs = ullIpsaClockNs() + ( benchWORK_US * 1000ULL );
+
+        while( ullIpsaClockNs() < ullWorkEndNs )
+        {
+        }
+    }
+
+    console_print( "%s,%lu,%lu,%lu,%.1f,%.1f,%.1f,%.1f\n",
+                   ( xAbsolute != pdFALSE ) ? "vTaskDelayUntil" : "vTaskDelay",
+                   ( unsigned long ) benchPERIODS,
+                   ( unsigned long ) ( benchPERIOD_NS / 1000ULL ),
+                   ( unsigned long ) ulOverruns,
+                   ullLateNs / 1000.0,
+                   ullHistogramPercentile( &xLateness, 50.0 ) / 1000.0,
+                   ullHistogramPercentile( &xLateness, 99.0 ) / 1000.0,
+                   xLateness.ullMax / 1000.0 );
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,190 @@
+/*
+ * Scheduler trace capture.  See ipsa_trace.h.
+ *
+ * Records are written from inside the kernel, in many cases with interrupts
+ * masked, so neither this file nor the hooks in ipsa_trace.h call back into
+ * the kernel: the task an event belongs to is the one last switched in,
+ * remembered here.  The write index is advanced atomically so a record
+ * written by the tick interrupt in the middle of a task level record cannot
+ * claim the same slot.
+ *
+ * Most hooks run inside a kernel critical section, but the timer expiry of a
+ * timer started after its expiry time is recorded from the timer task with
+ * nothing masked, so a task that dumps can find a slot claimed but not yet
+ * filled.  Each slot therefore also holds the write index of the record last
+ * completed in it, and the dump stops at the first record not completed.
+ * The write index is never wound back, so a stale index cannot pass for a
+ * new one, and a dump sets its top bit so no slot is claimed while it runs.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+/* Local includes. */
+#include "ipsa_clock.h"
+#include "ipsa_trace.h"
+
+#define traceBUFFER_MASK    ( traceBUFFER_RECORDS - 1U )
+
+/* Set in the write index while a dump runs. */
+#define traceSTOPPED        ( 1ULL << 63 )
+
+#if ( ( traceBUFFER_RECORDS & traceBUFFER_MASK ) != 0 )
+    #error traceBUFFER_RECORDS must be a power of two
+#endif
+
+/*-----------------------------------------------------------*/
+
+static TraceRecord_t xRecords[ traceBUFFER_RECORDS ];
+static uint64_t ullCompleted[ traceBUFFER_RECORDS ];
+static uint64_t ullWriteIndex = 0;
+static uint64_t ullDumpedIndex = 0;
+static TraceName_t xNames[ traceMAX_NAMES ];
+static uint32_t ulNameCount = 0;
+static volatile uint32_t ulRunningTask = 0;
+
+/*-----------------------------------------------------------*/
+
+void vTraceRecord( uint8_t ucEvent,
+                   uint8_t ucDetail,
+                   uint32_t ulTask,
+                   uint32_t ulObject )
+{
+    TraceRecord_t * pxRecord;
+    uint64_t ullIndex;
+
+    /* Followed even while a dump has stopped recording. */
+    if( ucEvent == traceEVENT_SWITCH_IN )
+    {
+        ulRunningTask = ulTask;
+    }
+
+    /* Claim a slot unless a dump is running, in one step. */
+    ullIndex = __atomic_load_n( &ullWriteIndex, __ATOMIC_RELAXED );
+
+    do
+    {
+        if( ( ullIndex & traceSTOPPED ) != 0U )
+        {
+            return;
+        }
+    } while( __atomic_compare_exchange_n( &ullWriteIndex, &ullIndex, ullIndex + 1U, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED ) == 0 );
+
+    pxRecord = &( xRecords[ ullIndex & traceBUFFER_MASK ] );
+    pxRecord->ullTimeNs = ullIpsaClockNs();
+    pxRecord->ucEvent = ucEvent;
+    pxRecord->ucDetail = ucDetail;
+    pxRecord->usTask = ( uint16_t ) ulTask;
+    pxRecord->ulObject = ulObject;
+
+    /* Release, so a dump that sees the index also sees the record. */
+    __atomic_store_n( &( ullCompleted[ ullIndex & traceBUFFER_MASK ] ), ullIndex + 1U, __ATOMIC_RELEASE );
+}
+/*-----------------------------------------------------------*/
+
+void vTraceRecordRunning( uint8_t ucEvent,
+                          uint8_t ucDetail,
+                          uint32_t ulObject )
+{
+    vTraceRecord( ucEvent, ucDetail, ulRunningTask, ulObject );
+}
+/*-----------------------------------------------------------*/
+
+void vTraceRecordName( uint32_t ulKind,
+                       uint32_t ulId,
+                       const char * pcName )
+{
+    uint32_t ulSlot = __atomic_fetch_add( &ulNameCount, 1U, __ATOMIC_RELAXED );
+
+    if( ulSlot < traceMAX_NAMES )
+    {
+        xNames[ ulSlot ].ulKind = ulKind;
+        xNames[ ulSlot ].ulId = ulId;
+        strncpy( xNames[ ulSlot ].cName, ( pcName != NULL ) ? pcName : "", traceNAME_LENGTH - 1U );
+        xNames[ ulSlot ].cName[ traceNAME_LENGTH - 1U ] = '\0';
+    }
+}
+/*-----------------------------------------------------------*/
+
+int iTraceDump( const char * pcPath )
+{
+    TraceFileHeader_t xHeader;
+    uint64_t ullWritten, ullFirst, ullComplete, ullIndex;
+    uint32_t ulNames;
+    FILE * pxFile;
+    int iResult = 0;
+
+    /* No slot can be claimed from here on.  A record claimed before but not
+     * yet completed is not waited for: it ends the dump. */
+    ullWritten = __atomic_fetch_or( &ullWriteIndex, traceSTOPPED, __ATOMIC_ACQUIRE );
+    ullFirst = ( ( ullWritten - ullDumpedIndex ) > traceBUFFER_RECORDS ) ? ( ullWritten - traceBUFFER_RECORDS ) : ullDumpedIndex;
+
+    for( ullComplete = ullFirst; ullComplete < ullWritten; ullComplete++ )
+    {
+        if( __atomic_load_n( &( ullCompleted[ ullComplete & traceBUFFER_MASK ] ), __ATOMIC_ACQUIRE ) != ( ullComplete + 1U ) )
+        {
+            break;
+        }
+    }
+
+    ulNames = __atomic_load_n( &ulNameCount, __ATOMIC_RELAXED );
+
+    if( ulNames > traceMAX_NAMES )
+    {
+        ulNames = traceMAX_NAMES;
+    }
+
+    memset( &xHeader, 0, sizeof( xHeader ) );
+    memcpy( xHeader.cMagic, traceFILE_MAGIC, sizeof( xHeader.cMagic ) );
+    xHeader.ulRecordSize = sizeof( TraceRecord_t );
+    xHeader.ulNameCount = ulNames;
+    xHeader.ullRecordCount = ullComplete - ullFirst;
+    xHeader.ullLostCount = ( ullWritten - ullDumpedIndex ) - xHeader.ullRecordCount;
+
+    pxFile = fopen( pcPath, "wb" );
+
+    if( pxFile == NULL )
+    {
+        iResult = -1;
+    }
+    else
+    {
+        if( ( fwrite( &xHeader, sizeof( xHeader ), 1, pxFile ) != 1 ) ||
+            ( fwrite( xNames, sizeof( TraceName_t ), ulNames, pxFile ) != ulNames ) )
+        {
+            iResult = -1;
+        }
+
+        /* Oldest first: the part of the ring after the write position, then
+         * the part before it. */
+        for( ullIndex = ullFirst; ( iResult == 0 ) && ( ullIndex < ullComplete ); )
+        {
+            uint64_t ullSlot = ullIndex & traceBUFFER_MASK;
+            uint64_t ullRun = traceBUFFER_RECORDS - ullSlot;
+
+            if( ullRun > ( ullComplete - ullIndex ) )
+            {
+                ullRun = ullComplete - ullIndex;
+            }
+
+            if( fwrite( &( xRecords[ ullSlot ] ), sizeof( TraceRecord_t ), ( size_t ) ullRun, pxFile ) != ( size_t ) ullRun )
+            {
+                iResult = -1;
+            }
+
+            ullIndex += ullRun;
+        }
+
+        if( fclose( pxFile ) != 0 )
+        {
+            iResult = -1;
+        }
+    }
+
+    /* Clear the capture by starting the next one where this one ended. */
+    ullDumpedIndex = ullWritten;
+    __atomic_store_n( &ullWriteIndex, ullWritten, __ATOMIC_RELEASE );
+
+    return iResult;
+}
+/*-----------------------------------------------------------*/
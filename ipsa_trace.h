@@ -0,0 +1,140 @@
+/*
+ * Scheduler trace capture for the ipsa_sched demo.
+ *
+ * The kernel trace macros (task switches, queue sends and receives, software
+ * timer expiries) are redirected into a preallocated ring of fixed size
+ * 16 byte records, each stamped with ullIpsaClockNs().  Recording a record is
+ * a flag test, a clock read and a few stores, so the capture can stay enabled
+ * in profiling builds.  When the ring is full the oldest records are
+ * overwritten, so the buffer always holds the most recent history.
+ *
+ * iTraceDump() writes the ring, and the names of the tasks and timers seen,
+ * to a binary file that trace2json.c converts into the Chrome trace event
+ * format (load it in chrome://tracing or https://ui.perfetto.dev).
+ *
+ * To enable the capture, set configUSE_TRACE_FACILITY to 1 and add
+ *
+ *     #define ipsaTRACE_ENABLED    1
+ *     #include "ipsa_trace.h"
+ *
+ * at the end of FreeRTOSConfig.h, and build ipsa_trace.c with the demo.
+ */
+
+#ifndef IPSA_TRACE_H
+#define IPSA_TRACE_H
+
+#include <stdint.h>
+
+/* Number of records in the ring.  Must be a power of two. */
+#ifndef traceBUFFER_RECORDS
+    #define traceBUFFER_RECORDS    ( 65536U )
+#endif
+
+/* Number of task and timer names remembered for the dump. */
+#define traceMAX_NAMES             ( 64U )
+#define traceNAME_LENGTH           ( 16U )
+
+#define traceFILE_MAGIC            "IPSATRC1"
+
+/* Record types. */
+#define traceEVENT_SWITCH_IN       ( 1U )
+#define traceEVENT_SWITCH_OUT      ( 2U )
+#define traceEVENT_QUEUE_SEND      ( 3U )
+#define traceEVENT_QUEUE_SEND_FAIL ( 4U )
+#define traceEVENT_QUEUE_RECEIVE   ( 5U )
+#define traceEVENT_TIMER_EXPIRED   ( 6U )
+
+/* Name table kinds. */
+#define traceNAME_TASK             ( 1U )
+#define traceNAME_TIMER            ( 2U )
+
+typedef struct TraceRecord
+{
+    uint64_t ullTimeNs;   /* ullIpsaClockNs() when the event happened. */
+    uint8_t ucEvent;      /* One of traceEVENT_*. */
+    uint8_t ucDetail;     /* Queue type for queue events, otherwise 0. */
+    uint16_t usTask;      /* Number of the task running, or switched in/out. */
+    uint32_t ulObject;    /* Queue or timer the event refers to. */
+} TraceRecord_t;
+
+typedef struct TraceName
+{
+    uint32_t ulKind;      /* traceNAME_TASK or traceNAME_TIMER. */
+    uint32_t ulId;        /* Task number, or timer object. */
+    char cName[ traceNAME_LENGTH ];
+} TraceName_t;
+
+/* The dump file is a TraceFileHeader_t, ulNameCount TraceName_t and then
+ * ulRecordCount TraceRecord_t, oldest first, all in host byte order. */
+typedef struct TraceFileHeader
+{
+    char cMagic[ 8 ];
+    uint32_t ulRecordSize;
+    uint32_t ulNameCount;
+    uint64_t ullRecordCount;
+    uint64_t ullLostCount;  /* Records overwritten before the dump, or still
+                             * being written when it was taken. */
+} TraceFileHeader_t;
+
+void vTraceRecord( uint8_t ucEvent,
+                   uint8_t ucDetail,
+                   uint32_t ulTask,
+                   uint32_t ulObject );
+
+/*
+ * Record an event of the running task: the task last recorded as switched
+ * in, so the event lands on the same row as that task's slices.
+ */
+void vTraceRecordRunning( uint8_t ucEvent,
+                          uint8_t ucDetail,
+                          uint32_t ulObject );
+
+void vTraceRecordName( uint32_t ulKind,
+                       uint32_t ulId,
+                       const char * pcName );
+
+/*
+ * Stop recording, write the capture to pcPath and clear it, then resume
+ * recording.  Returns 0 on success.  Makes Linux system calls, so call it from
+ * a task that can afford them.
+ */
+int iTraceDump( const char * pcPath );
+
+/*-----------------------------------------------------------*/
+
+#if ( defined( ipsaTRACE_ENABLED ) && ( ipsaTRACE_ENABLED == 1 ) )
+
+    #if ( configUSE_TRACE_FACILITY != 1 )
+        #error ipsa_trace.h needs configUSE_TRACE_FACILITY set to 1 for task and queue numbers
+    #endif
+
+    /* These expand inside tasks.c, queue.c and timers.c, where the kernel
+     * structures are visible.  Every record uses uxTCBNumber, the number the
+     * kernel gives each task, never the application's uxTaskNumber. */
+    #define traceTASK_CREATE( pxNewTCB ) \
+    vTraceRecordName( traceNAME_TASK, ( uint32_t ) ( pxNewTCB )->uxTCBNumber, ( pxNewTCB )->pcTaskName )
+
+    #define traceTASK_SWITCHED_IN() \
+    vTraceRecord( traceEVENT_SWITCH_IN, 0, ( uint32_t ) pxCurrentTCB->uxTCBNumber, 0 )
+
+    #define traceTASK_SWITCHED_OUT() \
+    vTraceRecord( traceEVENT_SWITCH_OUT, 0, ( uint32_t ) pxCurrentTCB->uxTCBNumber, 0 )
+
+    #define traceQUEUE_SEND( pxQueue ) \
+    vTraceRecordRunning( traceEVENT_QUEUE_SEND, ( pxQueue )->ucQueueType, ( uint32_t ) ( uintptr_t ) ( pxQueue ) )
+
+    #define traceQUEUE_SEND_FAILED( pxQueue ) \
+    vTraceRecordRunning( traceEVENT_QUEUE_SEND_FAIL, ( pxQueue )->ucQueueType, ( uint32_t ) ( uintptr_t ) ( pxQueue ) )
+
+    #define traceQUEUE_RECEIVE( pxQueue ) \
+    vTraceRecordRunning( traceEVENT_QUEUE_RECEIVE, ( pxQueue )->ucQueueType, ( uint32_t ) ( uintptr_t ) ( pxQueue ) )
+
+    #define traceTIMER_CREATE( pxNewTimer ) \
+    vTraceRecordName( traceNAME_TIMER, ( uint32_t ) ( uintptr_t ) ( pxNewTimer ), ( pxNewTimer )->pcTimerName )
+
+    #define traceTIMER_EXPIRED( pxTimer ) \
+    vTraceRecordRunning( traceEVENT_TIMER_EXPIRED, 0, ( uint32_t ) ( uintptr_t ) ( pxTimer ) )
+
+#endif /* ipsaTRACE_ENABLED */
+
+#endif /* IPSA_TRACE_H */
@@ -0,0 +1,90 @@
+/*
+ * Receive task workloads.  See ipsa_workloads.h.
+ */
+
+/* Local includes. */
+#include "ipsa_bigint.h"
+#include "ipsa_search.h"
+#include "ipsa_workloads.h"
+
+/*-----------------------------------------------------------*/
+
+const int iWorkloadSearchTable[ workloadSEARCH_TABLE_LENGTH ] =
+{
+    1,  2,  3,  4,  5,  6,  7,  8,  9,  10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22,
+    23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40, 41, 42, 43, 44, 45, 46, 47, 48, 49, 50
+};
+
+/*-----------------------------------------------------------*/
+
+double dWorkloadTemperature( int iFahrenheit )
+{
+    return ( iFahrenheit - 32 ) / 9.0 * 5.0;
+}
+/*-----------------------------------------------------------*/
+
+int iWorkloadMultiply( int64_t llA,
+                       int64_t llB,
+                       char * pcProduct,
+                       size_t xSize )
+{
+    BigLimb_t xA[ bigLIMBS_PER_64 ], xB[ bigLIMBS_PER_64 ], xProduct[ 2 * bigLIMBS_PER_64 ];
+    uint64_t ullA, ullB;
+    int64_t llProduct;
+    int iOverflow;
+    size_t x;
+
+    iOverflow = iBigMulChecked64( llA, llB, &llProduct );
+
+    /* Multiply the magnitudes exactly, whether or not the product fits, so the
+     * same work is done every time.  Negating in unsigned arithmetic also
+     * handles INT64_MIN. */
+    ullA = ( llA < 0 ) ? ( 0U - ( uint64_t ) llA ) : ( uint64_t ) llA;
+    ullB = ( llB < 0 ) ? ( 0U - ( uint64_t ) llB ) : ( uint64_t ) llB;
+
+    for( x = 0; x < bigLIMBS_PER_64; x++ )
+    {
+        xA[ x ] = ( BigLimb_t ) ( ullA >> ( x * bigLIMB_BITS ) );
+        xB[ x ] = ( BigLimb_t ) ( ullB >> ( x * bigLIMB_BITS ) );
+    }
+
+    vBigMulSchoolbook( xA, bigLIMBS_PER_64, xB, bigLIMBS_PER_64, xProduct );
+
+    if( xSize < 2 )
+    {
+        return -1;
+    }
+
+    if( ( ( llA < 0 ) != ( llB < 0 ) ) && ( ullA != 0U ) && ( ullB != 0U ) )
+    {
+        pcProduct[ 0 ] = '-';
+        pcProduct++;
+        xSize--;
+    }
+
+    if( xBigToDecimal( xProduct, 2 * bigLIMBS_PER_64, pcProduct, xSize ) == 0 )
+    {
+        return -1;
+    }
+
+    return iOverflow;
+}
+/*-----------------------------------------------------------*/
+
+int iWorkloadSearch( const int * piSorted,
+                     int iLength,
+                     int iKey,
+                     int * piIterations )
+{
+    size_t xProbes;
+    size_t xIndex;
+
+    /* The branchless search is the fastest variant for a table this size,
+     * see search_bench.c, and takes the same time whatever the key. */
+    xIndex = xSearchBranchless( piSorted, ( size_t ) iLength, iKey, &xProbes );
+
+    *piIterations = ( int ) xProbes;
+
+    return ( xIndex == searchNOT_FOUND ) ? -1 : ( int ) xIndex;
+}
+/*-----------------------------------------------------------*/
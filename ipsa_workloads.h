@@ -0,0 +1,51 @@
+/*
+ * The computations run by the ipsa_sched receive tasks when the software
+ * timer value arrives, split out of the tasks so they can be timed on their
+ * own - see wcet_bench.c.  Nothing here calls the kernel or prints.
+ */
+
+#ifndef IPSA_WORKLOADS_H
+#define IPSA_WORKLOADS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* The sorted table Task 4 searches, and the value it looks for. */
+#define workloadSEARCH_TABLE_LENGTH    ( 50 )
+#define workloadSEARCH_KEY             ( 10 )
+
+/* The operands Task 3 multiplies, and the space its decimal product needs:
+ * a sign, up to 38 digits and the terminator. */
+#define workloadMULTIPLY_A             ( 519195165119LL )
+#define workloadMULTIPLY_B             ( 784816654984LL )
+#define workloadPRODUCT_DIGITS         ( 40 )
+
+extern const int iWorkloadSearchTable[ workloadSEARCH_TABLE_LENGTH ];
+
+/*
+ * Task 2: convert a Fahrenheit reading to degrees Celsius.
+ */
+double dWorkloadTemperature( int iFahrenheit );
+
+/*
+ * Task 3: multiply two integers exactly and write the product to pcProduct in
+ * decimal.  Returns 0 if the product fits in 64 bits, 1 if it does not (the
+ * product written is still exact), or -1 if xSize is too small.  Products
+ * need at most workloadPRODUCT_DIGITS characters.
+ */
+int iWorkloadMultiply( int64_t llA,
+                       int64_t llB,
+                       char * pcProduct,
+                       size_t xSize );
+
+/*
+ * Task 4: look for iKey in the iLength sorted values at piSorted.  Returns its
+ * index, or -1 if it is not there, and writes the number of values compared
+ * to piIterations.
+ */
+int iWorkloadSearch( const int * piSorted,
+                     int iLength,
+                     int iKey,
+                     int * piIterations );
+
+#endif /* IPSA_WORKLOADS_H */
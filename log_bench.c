@@ -0,0 +1,194 @@
+/*
+ * Host benchmark of the time a task spends logging: console_print() against
+ * the deferred ring in ipsa_log.c.
+ *
+ * Each "task" is a thread that logs the same two messages as the ipsa_sched
+ * receive tasks.  console_print() is modelled as it is implemented in the
+ * Linux port demo: take a mutex, vprintf(), release the mutex.  In ring mode
+ * the threads only call vLogPrint(), and one drain thread formats and writes
+ * batches.
+ *
+ * Like the receive tasks, each thread logs in bursts: BURST messages, then a
+ * pause of BURST_PERIOD_US, a rate the drain keeps up with so that no record
+ * is lost.  Only the time spent inside the logging calls is counted.  A ring
+ * run that loses records would be timing the overflow path, so it is
+ * reported as invalid, with no speed-up, and the exit status is 1.  Log text
+ * goes to stdout, results to stderr, so run with stdout sent to a file or
+ * /dev/null:
+ *
+ *   gcc -O2 -pthread log_bench.c ipsa_log.c -o log_bench
+ *   ./log_bench > /dev/null
+ */
+
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "ipsa_log.h"
+
+#define THREADS           4
+#define CALLS_PER_THREAD  20000
+#define BURST             16
+#define BURST_PERIOD_US   1000
+#define DRAIN_BUFFER      8192
+
+static pthread_mutex_t console_mutex = PTHREAD_MUTEX_INITIALIZER;
+static volatile int producers_running;
+static const char * const names[ THREADS ] = { "Task 1", "Task 2", "Task 3", "Task 4" };
+
+static uint64_t now_ns( void )
+{
+	struct timespec ts;
+
+	clock_gettime( CLOCK_MONOTONIC, &ts );
+	return ( uint64_t ) ts.tv_sec * 1000000000ULL + ( uint64_t ) ts.tv_nsec;
+}
+
+/* Same shape as console_print() in the FreeRTOS Linux demo. */
+static void console_print( const char * fmt, ... )
+{
+	va_list vargs;
+
+	va_start( vargs, fmt );
+	pthread_mutex_lock( &console_mutex );
+	vprintf( fmt, vargs );
+	pthread_mutex_unlock( &console_mutex );
+	va_end( vargs );
+}
+
+struct producer {
+	int index;
+	int deferred;
+	uint64_t ns;
+};
+
+static void * producer_thread( void * arg )
+{
+	struct producer * p = arg;
+	struct timespec pause = { 0, BURST_PERIOD_US * 1000L };
+	uint64_t start;
+
+	p->ns = 0;
+
+	for ( int i = 0; i < CALLS_PER_THREAD; i++ ) {
+		int fahrenheit = 32 + i % 50;
+		double celsius = ( fahrenheit - 32 ) / 9.0 * 5.0;
+
+		start = now_ns();
+
+		if ( p->deferred ) {
+			if ( i & 1 )
+				vLogPrint( "%s is working\n", names[ p->index ] );
+			else
+				vLogPrint( "température en Fahreneit : %d F, conversion en degrée :%2f°C\n", fahrenheit, celsius );
+		} else {
+			if ( i & 1 )
+				console_print( "%s is working\n", names[ p->index ] );
+			else
+				console_print( "température en Fahreneit : %d F, conversion en degrée :%2f°C\n", fahrenheit, celsius );
+		}
+
+		p->ns += now_ns() - start;
+
+		if ( ( i + 1 ) % BURST == 0 )
+			nanosleep( &pause, NULL );
+	}
+
+	return NULL;
+}
+
+static void * drain_thread( void * arg )
+{
+	static char buffer[ DRAIN_BUFFER ];
+	size_t length;
+	unsigned long * batches = arg;
+
+	for ( ; ; ) {
+		int running = __atomic_load_n( &producers_running, __ATOMIC_ACQUIRE );
+
+		length = xLogDrain( buffer, sizeof( buffer ) );
+
+		if ( length > 0 ) {
+			fwrite( buffer, 1, length, stdout );
+			( *batches )++;
+		} else if ( !running ) {
+			break;
+		} else {
+			/* The RTOS drain task sleeps between batches too. */
+			struct timespec pause = { 0, 100000 };
+			nanosleep( &pause, NULL );
+		}
+	}
+
+	return NULL;
+}
+
+/* Returns the mean time per call in ns, or a negative value if records
+ * were lost. */
+static double run( int deferred )
+{
+	pthread_t threads[ THREADS ], drainer;
+	struct producer producers[ THREADS ];
+	unsigned long batches = 0;
+	uint64_t total = 0, worst = 0, start = now_ns();
+	uint32_t lost = 0;
+	double per_call;
+
+	producers_running = 1;
+
+	if ( deferred )
+		pthread_create( &drainer, NULL, drain_thread, &batches );
+
+	for ( int t = 0; t < THREADS; t++ ) {
+		producers[ t ].index = t;
+		producers[ t ].deferred = deferred;
+		pthread_create( &threads[ t ], NULL, producer_thread, &producers[ t ] );
+	}
+
+	for ( int t = 0; t < THREADS; t++ ) {
+		pthread_join( threads[ t ], NULL );
+		total += producers[ t ].ns;
+		if ( producers[ t ].ns > worst )
+			worst = producers[ t ].ns;
+	}
+
+	__atomic_store_n( &producers_running, 0, __ATOMIC_RELEASE );
+
+	if ( deferred )
+		pthread_join( drainer, NULL );
+
+	fflush( stdout );
+
+	per_call = ( double ) total / ( THREADS * ( double ) CALLS_PER_THREAD );
+
+	fprintf( stderr, "%-13s %10.1f ns/call in task, slowest task %8.1f ms in calls, wall %8.1f ms",
+	         deferred ? "ring" : "console_print", per_call, worst / 1e6, ( now_ns() - start ) / 1e6 );
+
+	if ( deferred ) {
+		lost = ulLogGetOverflowCount();
+		fprintf( stderr, ", %lu batches, %lu records lost", batches, ( unsigned long ) lost );
+	}
+
+	fprintf( stderr, "\n" );
+
+	return lost == 0 ? per_call : -1.0;
+}
+
+int main( void )
+{
+	double console, ring;
+
+	fprintf( stderr, "%d tasks x %d messages, in bursts of %d every %d us\n", THREADS, CALLS_PER_THREAD, BURST, BURST_PERIOD_US );
+	console = run( 0 );
+	ring = run( 1 );
+
+	if ( ring < 0.0 ) {
+		fprintf( stderr, "invalid run: the ring overflowed, so it timed the drop path; no speed-up reported\n" );
+		return 1;
+	}
+
+	fprintf( stderr, "speed-up in task %.1fx\n", ring > 0.0 ? console / ring : 0.0 );
+	return 0;
+}
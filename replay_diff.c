@@ -0,0 +1,293 @@
+/*
+ * Compare two recordings written by iReplayDump() (ipsa_replay.c), normally
+ * the replay runs of two builds of ipsa_sched.c from the same recording.
+ *
+ * The input of the two runs - the sends with their ticks and values, the
+ * timer expiries and the Task 2 inputs, in order, up to the end of the
+ * shorter run - is checked first, as the latencies can only be compared if
+ * it is the same.  The values received are then matched by send number, and
+ * by receive task where the same send reached the same task in both runs
+ * (always, in broadcast mode).  A value taken by another receive task in the
+ * candidate is still matched, and counted as moved; a value received in only
+ * one of the runs is counted against that run.
+ *
+ * For each match the candidate's latency minus the baseline's is taken, so a
+ * positive difference means the candidate was slower.  One CSV line is
+ * printed per baseline receive task and latency, with the baseline and
+ * candidate medians and the median, p99 and largest of the differences.
+ * With -e one line is printed per matched value instead.  The counts are
+ * printed on stderr.
+ *
+ *   gcc -O2 replay_diff.c -o replay_diff
+ *   ./replay_diff [-e] baseline.bin candidate.bin
+ *
+ * Exits with 0 if the inputs were the same, 1 if they were not, 2 on bad
+ * input.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "ipsa_replay.h"
+
+#define MAX_TASKS 256
+
+typedef struct {
+	ReplayFileHeader_t header;
+	ReplayRecord_t * records;
+	ReplayRecord_t ** receives;   /* Receive events, sorted by send number then task. */
+	uint64_t receive_count;
+} recording_t;
+
+typedef struct {
+	int64_t * delta[ 2 ];         /* Candidate minus baseline, per latency. */
+	uint32_t * base[ 2 ];
+	uint32_t * cand[ 2 ];
+	uint64_t count;
+} task_diff_t;
+
+static const char * metrics[ 2 ] = { "release_to_start", "start_to_finish" };
+
+static task_diff_t tasks[ MAX_TASKS ];
+static uint64_t capacity;      /* Most matches one task can have. */
+
+static int by_sequence( const void * a, const void * b )
+{
+	const ReplayRecord_t * x = *( const ReplayRecord_t * const * ) a;
+	const ReplayRecord_t * y = *( const ReplayRecord_t * const * ) b;
+
+	if ( x->ulSequence != y->ulSequence )
+		return x->ulSequence < y->ulSequence ? -1 : 1;
+	return ( int ) x->ucTask - ( int ) y->ucTask;
+}
+
+static int by_int64( const void * a, const void * b )
+{
+	int64_t x = *( const int64_t * ) a, y = *( const int64_t * ) b;
+
+	return ( x > y ) - ( x < y );
+}
+
+static int by_uint32( const void * a, const void * b )
+{
+	uint32_t x = *( const uint32_t * ) a, y = *( const uint32_t * ) b;
+
+	return ( x > y ) - ( x < y );
+}
+
+static int load( const char * path, recording_t * r )
+{
+	FILE * in = fopen( path, "rb" );
+
+	if ( in == NULL ) {
+		perror( path );
+		return -1;
+	}
+
+	if ( fread( &r->header, sizeof( r->header ), 1, in ) != 1 ||
+	     memcmp( r->header.cMagic, replayFILE_MAGIC, sizeof( r->header.cMagic ) ) != 0 ||
+	     r->header.ulRecordSize != sizeof( ReplayRecord_t ) ) {
+		fprintf( stderr, "%s: not a recording\n", path );
+		fclose( in );
+		return -1;
+	}
+
+	r->records = calloc( r->header.ullRecordCount + 1, sizeof( ReplayRecord_t ) );
+	r->receives = calloc( r->header.ullRecordCount + 1, sizeof( ReplayRecord_t * ) );
+
+	if ( r->records == NULL || r->receives == NULL ||
+	     fread( r->records, sizeof( ReplayRecord_t ), r->header.ullRecordCount, in ) != r->header.ullRecordCount ) {
+		fprintf( stderr, "%s: truncated recording\n", path );
+		fclose( in );
+		return -1;
+	}
+
+	fclose( in );
+
+	r->receive_count = 0;
+	for ( uint64_t i = 0; i < r->header.ullRecordCount; i++ )
+		if ( r->records[ i ].ucEvent == replayEVENT_RECEIVE )
+			r->receives[ r->receive_count++ ] = &r->records[ i ];
+
+	qsort( r->receives, r->receive_count, sizeof( r->receives[ 0 ] ), by_sequence );
+
+	if ( r->header.ullLostCount != 0 )
+		fprintf( stderr, "%s: %llu records were lost, the end of the run is missing\n", path,
+		         ( unsigned long long ) r->header.ullLostCount );
+
+	return 0;
+}
+
+/* The index of the next send, timer or input event from i, or count. */
+static uint64_t next_input( const recording_t * r, uint64_t i )
+{
+	while ( i < r->header.ullRecordCount && r->records[ i ].ucEvent == replayEVENT_RECEIVE )
+		i++;
+	return i;
+}
+
+/* Compare the inputs of the two runs, up to the end of the shorter one.
+ * Returns the number of events that differ. */
+static uint64_t compare_inputs( const recording_t * base, const recording_t * cand )
+{
+	uint64_t i = next_input( base, 0 ), j = next_input( cand, 0 ), compared = 0, differ = 0;
+
+	while ( i < base->header.ullRecordCount && j < cand->header.ullRecordCount ) {
+		const ReplayRecord_t * a = &base->records[ i ], * b = &cand->records[ j ];
+
+		if ( a->ucEvent != b->ucEvent || a->ulValue != b->ulValue ||
+		     ( a->ucEvent != replayEVENT_INPUT && a->ulTick != b->ulTick ) ) {
+			if ( differ++ == 0 )
+				fprintf( stderr, "first input difference at event %llu: type %u tick %u value %u, then type %u tick %u value %u\n",
+				         ( unsigned long long ) compared, a->ucEvent, a->ulTick, a->ulValue, b->ucEvent, b->ulTick, b->ulValue );
+		}
+
+		compared++;
+		i = next_input( base, i + 1 );
+		j = next_input( cand, j + 1 );
+	}
+
+	fprintf( stderr, "%llu input events compared, %llu differ\n", ( unsigned long long ) compared, ( unsigned long long ) differ );
+
+	return differ;
+}
+
+static void add_match( const ReplayRecord_t * a, const ReplayRecord_t * b, int per_event )
+{
+	task_diff_t * t = &tasks[ a->ucTask ];
+	uint32_t base[ 2 ] = { a->ulReleaseToStartNs, a->ulStartToFinishNs };
+	uint32_t cand[ 2 ] = { b->ulReleaseToStartNs, b->ulStartToFinishNs };
+
+	if ( per_event ) {
+		printf( "%u,%u,Task %u,Task %u,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f\n", a->ulSequence, a->ulValue, a->ucTask + 1, b->ucTask + 1,
+		        base[ 0 ] / 1000.0, cand[ 0 ] / 1000.0, ( ( double ) cand[ 0 ] - base[ 0 ] ) / 1000.0,
+		        base[ 1 ] / 1000.0, cand[ 1 ] / 1000.0, ( ( double ) cand[ 1 ] - base[ 1 ] ) / 1000.0 );
+		return;
+	}
+
+	for ( int m = 0; m < 2 && t->delta[ m ] == NULL; m++ ) {
+		t->delta[ m ] = calloc( capacity, sizeof( int64_t ) );
+		t->base[ m ] = calloc( capacity, sizeof( uint32_t ) );
+		t->cand[ m ] = calloc( capacity, sizeof( uint32_t ) );
+		if ( t->delta[ m ] == NULL || t->base[ m ] == NULL || t->cand[ m ] == NULL ) {
+			fprintf( stderr, "out of memory\n" );
+			exit( 2 );
+		}
+	}
+
+	for ( int m = 0; m < 2; m++ ) {
+		t->delta[ m ][ t->count ] = ( int64_t ) cand[ m ] - ( int64_t ) base[ m ];
+		t->base[ m ][ t->count ] = base[ m ];
+		t->cand[ m ][ t->count ] = cand[ m ];
+	}
+	t->count++;
+}
+
+int main( int argc, char * argv[] )
+{
+	recording_t base, cand;
+	unsigned char * used;
+	uint64_t differ, matched = 0, moved = 0, only_base = 0, j = 0, k;
+	int per_event = 0, opt;
+
+	while ( ( opt = getopt( argc, argv, "e" ) ) != -1 ) {
+		if ( opt == 'e' ) {
+			per_event = 1;
+		} else {
+			fprintf( stderr, "usage: %s [-e] baseline.bin candidate.bin\n", argv[ 0 ] );
+			return 2;
+		}
+	}
+
+	if ( argc - optind != 2 ) {
+		fprintf( stderr, "usage: %s [-e] baseline.bin candidate.bin\n", argv[ 0 ] );
+		return 2;
+	}
+
+	if ( load( argv[ optind ], &base ) != 0 || load( argv[ optind + 1 ], &cand ) != 0 )
+		return 2;
+
+	if ( base.header.ulTickRateHz != cand.header.ulTickRateHz ) {
+		fprintf( stderr, "the recordings were made at %u and %u Hz\n", base.header.ulTickRateHz, cand.header.ulTickRateHz );
+		return 2;
+	}
+
+	differ = compare_inputs( &base, &cand );
+
+	capacity = base.receive_count;
+	used = calloc( cand.receive_count + 1, 1 );
+
+	if ( used == NULL ) {
+		fprintf( stderr, "out of memory\n" );
+		return 2;
+	}
+
+	if ( per_event )
+		printf( "sequence,value,base_task,cand_task,base_release_to_start_us,cand_release_to_start_us,delta_release_to_start_us,"
+		        "base_start_to_finish_us,cand_start_to_finish_us,delta_start_to_finish_us\n" );
+
+	/* Both lists are sorted by send number, so walk them together: j is the
+	 * first candidate receive of the current send number. */
+	for ( uint64_t i = 0; i < base.receive_count; i++ ) {
+		const ReplayRecord_t * a = base.receives[ i ];
+		uint64_t pick = cand.receive_count;
+
+		while ( j < cand.receive_count && cand.receives[ j ]->ulSequence < a->ulSequence )
+			j++;
+
+		/* The same task first, or else any receive of the same send left. */
+		for ( k = j; k < cand.receive_count && cand.receives[ k ]->ulSequence == a->ulSequence; k++ ) {
+			if ( used[ k ] )
+				continue;
+			if ( cand.receives[ k ]->ucTask == a->ucTask ) {
+				pick = k;
+				break;
+			}
+			if ( pick == cand.receive_count )
+				pick = k;
+		}
+
+		if ( pick == cand.receive_count ) {
+			only_base++;
+			continue;
+		}
+
+		used[ pick ] = 1;
+		matched++;
+		if ( cand.receives[ pick ]->ucTask != a->ucTask )
+			moved++;
+		add_match( a, cand.receives[ pick ], per_event );
+	}
+
+	if ( !per_event ) {
+		printf( "task,metric,matched,base_p50_us,cand_p50_us,delta_p50_us,delta_p99_us,delta_max_us\n" );
+
+		for ( int t = 0; t < MAX_TASKS; t++ ) {
+			task_diff_t * d = &tasks[ t ];
+
+			if ( d->count == 0 )
+				continue;
+
+			for ( int m = 0; m < 2; m++ ) {
+				qsort( d->delta[ m ], d->count, sizeof( int64_t ), by_int64 );
+				qsort( d->base[ m ], d->count, sizeof( uint32_t ), by_uint32 );
+				qsort( d->cand[ m ], d->count, sizeof( uint32_t ), by_uint32 );
+
+				printf( "Task %d,%s,%llu,%.1f,%.1f,%.1f,%.1f,%.1f\n", t + 1, metrics[ m ], ( unsigned long long ) d->count,
+				        d->base[ m ][ d->count / 2 ] / 1000.0,
+				        d->cand[ m ][ d->count / 2 ] / 1000.0,
+				        d->delta[ m ][ d->count / 2 ] / 1000.0,
+				        d->delta[ m ][ ( d->count * 99 ) / 100 ] / 1000.0,
+				        d->delta[ m ][ d->count - 1 ] / 1000.0 );
+			}
+		}
+	}
+
+	fprintf( stderr, "%llu values matched, %llu by another task, %llu only in the baseline, %llu only in the candidate\n",
+	         ( unsigned long long ) matched, ( unsigned long long ) moved, ( unsigned long long ) only_base,
+	         ( unsigned long long ) ( cand.receive_count - matched ) );
+
+	return differ == 0 ? 0 : 1;
+}
@@ -0,0 +1,364 @@
+/*
+ * Build time schedulability analysis of the ipsa_sched tasks.
+ *
+ * Reads the task table in ipsa_tasks.h, takes the execution time of each
+ * task's kernel from the CSV printed by wcet_bench.c (the larger of the warm
+ * and cold wcet_estimate_ns) and adds the task's own cost.  It then gives
+ * the tasks priorities, rate monotonic (shorter period, higher priority) or
+ * with -d deadline monotonic (shorter deadline, higher priority), ties going
+ * to the task listed first, and runs response time analysis: the worst case
+ * response time of a task is the smallest R with
+ *
+ *     R = C + sum over higher priority tasks j of ceil( R / T_j ) * C_j
+ *
+ * and the set is schedulable if R is within the deadline for every task.  A
+ * receive task is released both by the send task and by the software timer:
+ * each release source counts as a task j of its own, and C includes one job
+ * per source, for the releases that come together.  The deadline is within
+ * the shorter period, so no earlier job of the task is still pending.
+ * Tasks with a fixed priority (the timer daemon) are placed above all the
+ * others.  One CSV line is printed per task, highest priority first, with a
+ * status of ok, warn (response time above WARN_PERCENT of the deadline) or
+ * miss.
+ *
+ * With -o the priorities are written as a header for ipsa_sched.c, built
+ * with mainUSE_ANALYZED_PRIORITIES set to 1; the header stops the build with
+ * an #error if the set is not schedulable.  The assigned tasks take the
+ * priorities from tskIDLE_PRIORITY + 1 up, so none of them shares the idle
+ * priority, and the top priority, taken by the service tasks, is left free.
+ *
+ * With -m the last "cpu," line printed by ipsa_sched.c built with
+ * mainCPU_STATS_PERIOD_MS (in a log of the simulator) is compared with the
+ * utilization the model predicts.  A task measured above its prediction means
+ * the WCET or the period in the model is wrong.
+ *
+ *   gcc -O2 sched_analyze.c -o sched_analyze -lm
+ *   ./wcet_bench > wcet.csv
+ *   ./sched_analyze [-d] [-w wcet.csv] [-m simulator.log] [-p max priorities] [-o ipsa_priorities.h]
+ *
+ * Exits with 0 if the set is schedulable, 1 if it is not, 2 on bad input.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "ipsa_tasks.h"
+
+#define DEFAULT_MAX_PRIORITIES  7 /* configMAX_PRIORITIES of the Linux demo. */
+#define WARN_PERCENT            80.0
+#define MAX_ITERATIONS          10000
+#define LINE_LENGTH             4096
+
+struct task {
+	const char * id;
+	const char * name;
+	double period_us;
+	double timer_us;     /* Second release period, 0 if none. */
+	double deadline_us;
+	int assigned;
+	const char * kernel;
+	double cost_us;
+
+	double kernel_us;    /* From the WCET CSV, -1 if not found. */
+	double wcet_us;
+	double response_us;  /* -1 if it exceeds the deadline. */
+	int priority;        /* Above tskIDLE_PRIORITY, 0 for a fixed priority task. */
+	int measured;        /* Permille from the simulator, -1 if not measured. */
+};
+
+#define TASK_ENTRY( xId, pcName, ulPeriodMs, ulTimerMs, ulDeadlineMs, xAssigned, pcKernel, ulCostUs ) \
+	{ #xId, pcName, ( ulPeriodMs ) * 1000.0, ( ulTimerMs ) * 1000.0, ( ulDeadlineMs ) * 1000.0, xAssigned, pcKernel, ulCostUs, -1.0, 0.0, 0.0, 0, -1 },
+
+static struct task tasks[] = { ipsaTASK_TABLE( TASK_ENTRY ) };
+
+#define TASK_COUNT  ( sizeof( tasks ) / sizeof( tasks[ 0 ] ) )
+
+/* Indices into tasks[], highest priority first. */
+static size_t order[ TASK_COUNT ];
+
+static int deadline_monotonic;
+
+static int read_wcet( const char * path )
+{
+	char line[ LINE_LENGTH ], kernel[ 64 ], variant[ 16 ];
+	double wcet_ns;
+	FILE * f = fopen( path, "r" );
+
+	if ( f == NULL ) {
+		perror( path );
+		return -1;
+	}
+
+	while ( fgets( line, sizeof( line ), f ) != NULL ) {
+		if ( sscanf( line, "%63[^,],%15[^,],%*[^,],%*[^,],%*[^,],%*[^,],%lf", kernel, variant, &wcet_ns ) != 3 )
+			continue;
+
+		for ( size_t t = 0; t < TASK_COUNT; t++ )
+			if ( strcmp( tasks[ t ].kernel, kernel ) == 0 && wcet_ns / 1000.0 > tasks[ t ].kernel_us )
+				tasks[ t ].kernel_us = wcet_ns / 1000.0;
+	}
+
+	fclose( f );
+	return 0;
+}
+
+/* The most releases of a task in a window of r microseconds. */
+static double releases( const struct task * task, double r )
+{
+	/* Round first so a whole number of periods is not counted as one more
+	 * release. */
+	double n = ceil( r / task->period_us - 1e-9 );
+
+	if ( task->timer_us > 0.0 )
+		n += ceil( r / task->timer_us - 1e-9 );
+
+	return n;
+}
+
+static double utilization_of( const struct task * task )
+{
+	double rate = 1.0 / task->period_us;
+
+	if ( task->timer_us > 0.0 )
+		rate += 1.0 / task->timer_us;
+
+	return task->wcet_us * rate;
+}
+
+static int higher_priority( const struct task * a, const struct task * b )
+{
+	double ka = deadline_monotonic ? a->deadline_us : a->period_us;
+	double kb = deadline_monotonic ? b->deadline_us : b->period_us;
+
+	if ( a->assigned != b->assigned )
+		return !a->assigned;
+
+	return ka < kb;
+}
+
+static void assign_priorities( void )
+{
+	size_t n = 0, assigned = 0;
+
+	/* Insertion sort, stable so ties keep the table order. */
+	for ( size_t t = 0; t < TASK_COUNT; t++ ) {
+		size_t i = n++;
+
+		while ( i > 0 && higher_priority( &tasks[ t ], &tasks[ order[ i - 1 ] ] ) ) {
+			order[ i ] = order[ i - 1 ];
+			i--;
+		}
+
+		order[ i ] = t;
+	}
+
+	for ( size_t t = 0; t < TASK_COUNT; t++ )
+		assigned += tasks[ t ].assigned ? 1 : 0;
+
+	for ( size_t i = 0; i < TASK_COUNT; i++ )
+		if ( tasks[ order[ i ] ].assigned )
+			tasks[ order[ i ] ].priority = ( int ) assigned--;
+}
+
+/* Worst case response time of order[ i ], or -1 if it misses its deadline. */
+static double response_time( size_t i )
+{
+	const struct task * task = &tasks[ order[ i ] ];
+	double own = task->timer_us > 0.0 ? 2.0 * task->wcet_us : task->wcet_us;
+	double r = own, next;
+
+	for ( int iteration = 0; iteration < MAX_ITERATIONS; iteration++ ) {
+		next = own;
+
+		for ( size_t j = 0; j < i; j++ ) {
+			const struct task * hp = &tasks[ order[ j ] ];
+
+			next += releases( hp, r ) * hp->wcet_us;
+		}
+
+		if ( next > task->deadline_us )
+			return -1.0;
+
+		if ( next == r )
+			return r;
+
+		r = next;
+	}
+
+	return -1.0;
+}
+
+static int read_measured( const char * path )
+{
+	char line[ LINE_LENGTH ], last[ LINE_LENGTH ] = "";
+	char * field, * colon, * save;
+	int commas = 0;
+	FILE * f = fopen( path, "r" );
+
+	if ( f == NULL ) {
+		perror( path );
+		return -1;
+	}
+
+	while ( fgets( line, sizeof( line ), f ) != NULL )
+		if ( strncmp( line, "cpu,", 4 ) == 0 )
+			strcpy( last, line );
+
+	fclose( f );
+
+	if ( last[ 0 ] == '\0' ) {
+		fprintf( stderr, "%s: no cpu line, build ipsa_sched.c with mainCPU_STATS_PERIOD_MS\n", path );
+		return -1;
+	}
+
+	last[ strcspn( last, "\r\n" ) ] = '\0';
+
+	/* cpu,<uptime_ms>,<interval_us>,<cost_us>,<task>:<permille>,... */
+	for ( field = strtok_r( last, ",", &save ); field != NULL; field = strtok_r( NULL, ",", &save ) ) {
+		if ( ++commas <= 4 || ( colon = strrchr( field, ':' ) ) == NULL )
+			continue;
+
+		*colon = '\0';
+
+		for ( size_t t = 0; t < TASK_COUNT; t++ )
+			if ( strcmp( tasks[ t ].name, field ) == 0 )
+				tasks[ t ].measured = atoi( colon + 1 );
+	}
+
+	return 0;
+}
+
+static int write_header( const char * path, int schedulable )
+{
+	FILE * f = fopen( path, "w" );
+
+	if ( f == NULL ) {
+		perror( path );
+		return -1;
+	}
+
+	fprintf( f, "/*\n * Generated by sched_analyze.c from ipsa_tasks.h, %s priorities.\n * Do not edit.\n */\n\n",
+	         deadline_monotonic ? "deadline monotonic" : "rate monotonic" );
+	fprintf( f, "#ifndef IPSA_PRIORITIES_H\n#define IPSA_PRIORITIES_H\n\n" );
+
+	if ( !schedulable )
+		fprintf( f, "#error The tasks in ipsa_tasks.h are not schedulable, run sched_analyze\n\n" );
+
+	for ( size_t i = 0; i < TASK_COUNT; i++ )
+		if ( tasks[ order[ i ] ].assigned )
+			fprintf( f, "#define priority%-20s ( tskIDLE_PRIORITY + %d )\n", tasks[ order[ i ] ].id, tasks[ order[ i ] ].priority );
+
+	fprintf( f, "\n#endif /* IPSA_PRIORITIES_H */\n" );
+	fclose( f );
+	return 0;
+}
+
+int main( int argc, char * argv[] )
+{
+	const char * wcet_path = NULL, * measured_path = NULL, * header_path = NULL;
+	int max_priorities = DEFAULT_MAX_PRIORITIES, assigned = 0, schedulable = 1, opt;
+	double utilization = 0.0, bound;
+
+	while ( ( opt = getopt( argc, argv, "dw:m:p:o:" ) ) != -1 ) {
+		switch ( opt ) {
+		case 'd': deadline_monotonic = 1; break;
+		case 'w': wcet_path = optarg; break;
+		case 'm': measured_path = optarg; break;
+		case 'p': max_priorities = atoi( optarg ); break;
+		case 'o': header_path = optarg; break;
+		default:
+			fprintf( stderr, "usage: %s [-d] [-w wcet.csv] [-m simulator.log] [-p max priorities] [-o header]\n", argv[ 0 ] );
+			return 2;
+		}
+	}
+
+	if ( wcet_path != NULL && read_wcet( wcet_path ) != 0 )
+		return 2;
+
+	if ( measured_path != NULL && read_measured( measured_path ) != 0 )
+		return 2;
+
+	for ( size_t t = 0; t < TASK_COUNT; t++ ) {
+		struct task * task = &tasks[ t ];
+
+		if ( task->deadline_us > task->period_us || task->period_us <= 0.0 ||
+		     task->timer_us < 0.0 || ( task->timer_us > 0.0 && task->deadline_us > task->timer_us ) ) {
+			fprintf( stderr, "%s: the deadline must be positive and at most the periods\n", task->name );
+			return 2;
+		}
+
+		if ( task->kernel[ 0 ] != '\0' && task->kernel_us < 0.0 )
+			fprintf( stderr, "warning: %s: no WCET for kernel %s, counting its own cost only\n", task->name, task->kernel );
+
+		task->wcet_us = task->cost_us + ( task->kernel_us > 0.0 ? task->kernel_us : 0.0 );
+		utilization += utilization_of( task );
+		assigned += task->assigned;
+	}
+
+	if ( assigned > max_priorities - 2 ) {
+		fprintf( stderr, "%d tasks need priorities but only %d are free between idle and the top priority\n",
+		         assigned, max_priorities - 2 );
+		return 2;
+	}
+
+	assign_priorities();
+
+	printf( "task,priority,period_ms,timer_ms,deadline_ms,wcet_us,utilization,response_us,deadline_used_pct,status\n" );
+
+	for ( size_t i = 0; i < TASK_COUNT; i++ ) {
+		struct task * task = &tasks[ order[ i ] ];
+		const char * status;
+
+		task->response_us = response_time( i );
+
+		if ( task->response_us < 0.0 ) {
+			status = "miss";
+			schedulable = 0;
+		} else {
+			status = task->response_us > task->deadline_us * WARN_PERCENT / 100.0 ? "warn" : "ok";
+		}
+
+		if ( task->assigned )
+			printf( "%s,%d,", task->name, task->priority );
+		else
+			printf( "%s,fixed,", task->name );
+
+		printf( "%.0f,%.0f,%.0f,%.1f,%.5f,", task->period_us / 1000.0, task->timer_us / 1000.0,
+		        task->deadline_us / 1000.0, task->wcet_us, utilization_of( task ) );
+
+		if ( task->response_us < 0.0 )
+			printf( "-,-,%s\n", status );
+		else
+			printf( "%.1f,%.1f,%s\n", task->response_us, 100.0 * task->response_us / task->deadline_us, status );
+	}
+
+	bound = TASK_COUNT * ( pow( 2.0, 1.0 / TASK_COUNT ) - 1.0 );
+	fprintf( stderr, "%s: utilization %.4f, rate monotonic bound %.4f, %s\n",
+	         deadline_monotonic ? "deadline monotonic" : "rate monotonic", utilization, bound,
+	         schedulable ? "schedulable" : "NOT schedulable" );
+
+	if ( measured_path != NULL ) {
+		printf( "task,predicted_permille,measured_permille,status\n" );
+
+		for ( size_t t = 0; t < TASK_COUNT; t++ ) {
+			double predicted = 1000.0 * utilization_of( &tasks[ t ] );
+
+			if ( tasks[ t ].measured < 0 ) {
+				printf( "%s,%.3f,-,not measured\n", tasks[ t ].name, predicted );
+				continue;
+			}
+
+			/* The cpu line is in whole permille, so allow one for rounding. */
+			printf( "%s,%.3f,%d,%s\n", tasks[ t ].name, predicted, tasks[ t ].measured,
+			        tasks[ t ].measured > ceil( predicted ) ? "over" : "ok" );
+		}
+	}
+
+	if ( header_path != NULL && write_header( header_path, schedulable ) != 0 )
+		return 2;
+
+	return schedulable ? 0 : 1;
+}
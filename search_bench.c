@@ -0,0 +1,155 @@
+/*
+ * Host benchmark of the sorted array lookups in ipsa_search.c, from the
+ * 50 element table Task 4 searches up to arrays far larger than the caches.
+ *
+ * For every size the array holds the even numbers 0, 2, 4, ... and is
+ * searched for a fixed pseudo random sequence of keys, half of them present
+ * (even) and half absent (odd), so both outcomes and every region of the
+ * array are exercised.  The keys are generated before the timed loop.  The
+ * result is printed as CSV, in ns per lookup, and the fastest variant for
+ * each size is reported on stderr.
+ *
+ *   gcc -O2 search_bench.c ipsa_search.c -o search_bench
+ *   ./search_bench [largest size] [lookups per size]
+ *
+ * The largest size defaults to 100 million elements, which needs about
+ * 800 MB for the sorted and Eytzinger copies.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "ipsa_search.h"
+
+#define DEFAULT_MAX_SIZE  100000000UL
+#define DEFAULT_LOOKUPS   2000000UL
+#define CACHE_LINE        64
+
+static volatile size_t sink;
+
+static uint64_t now_ns( void )
+{
+	struct timespec ts;
+
+	clock_gettime( CLOCK_MONOTONIC, &ts );
+	return ( uint64_t ) ts.tv_sec * 1000000000ULL + ( uint64_t ) ts.tv_nsec;
+}
+
+static uint32_t next_random( uint32_t * state )
+{
+	/* xorshift32: fast and good enough to scatter the keys. */
+	*state ^= *state << 13;
+	*state ^= *state >> 17;
+	*state ^= *state << 5;
+	return *state;
+}
+
+/* Time the lookup of every key and return ns per lookup.  A variant that
+ * gives a wrong answer is reported and aborts the run. */
+static double run( const char * name, size_t ( *fn )( const int *, size_t, int, size_t * ),
+                   const int * array, size_t n, const int * keys, size_t lookups )
+{
+	size_t found = 0;
+	uint64_t start = now_ns();
+
+	for ( size_t i = 0; i < lookups; i++ ) {
+		size_t index = fn( array, n, keys[ i ], NULL );
+
+		found += index != searchNOT_FOUND;
+		if ( index != searchNOT_FOUND && array[ index ] != keys[ i ] ) {
+			fprintf( stderr, "%s: wrong index for %d at size %zu\n", name, keys[ i ], n );
+			exit( 1 );
+		}
+	}
+
+	double ns = ( double ) ( now_ns() - start ) / ( double ) lookups;
+
+	/* Every even key below 2n is present and no odd one is. */
+	size_t expected = 0;
+	for ( size_t i = 0; i < lookups; i++ )
+		expected += ( keys[ i ] & 1 ) == 0 && ( size_t ) keys[ i ] < 2 * n;
+
+	if ( found != expected ) {
+		fprintf( stderr, "%s: found %zu of %zu keys at size %zu\n", name, found, expected, n );
+		exit( 1 );
+	}
+
+	sink += found;
+	return ns;
+}
+
+int main( int argc, char * argv[] )
+{
+	static const char * const names[] = { "binary", "branchless", "eytzinger" };
+	size_t max_size = argc > 1 ? strtoul( argv[ 1 ], NULL, 0 ) : DEFAULT_MAX_SIZE;
+	size_t lookups = argc > 2 ? strtoul( argv[ 2 ], NULL, 0 ) : DEFAULT_LOOKUPS;
+	int * sorted, * eytzinger, * keys;
+	uint32_t seed = 2463534242U;
+
+	if ( max_size < 1 || lookups < 1 || max_size > INT32_MAX / 2 ) {
+		fprintf( stderr, "usage: %s [largest size] [lookups per size]\n", argv[ 0 ] );
+		return 1;
+	}
+
+	sorted = malloc( max_size * sizeof( int ) );
+	eytzinger = aligned_alloc( CACHE_LINE, ( ( max_size + 1 ) * sizeof( int ) + CACHE_LINE - 1 ) / CACHE_LINE * CACHE_LINE );
+	keys = malloc( lookups * sizeof( int ) );
+
+	if ( sorted == NULL || eytzinger == NULL || keys == NULL ) {
+		fprintf( stderr, "not enough memory for %zu elements\n", max_size );
+		return 1;
+	}
+
+	for ( size_t i = 0; i < max_size; i++ )
+		sorted[ i ] = ( int ) ( 2 * i );
+
+	printf( "elements,binary_ns,branchless_ns,eytzinger_ns\n" );
+
+	/* 50 (Task 4's table), then 1-2-5 steps up to the largest size. */
+	size_t sizes[ 32 ], count = 0;
+	sizes[ count++ ] = 50;
+	for ( size_t decade = 100; decade <= max_size && count < 29; decade *= 10 ) {
+		sizes[ count++ ] = decade;
+		if ( 2 * decade <= max_size )
+			sizes[ count++ ] = 2 * decade;
+		if ( 5 * decade <= max_size )
+			sizes[ count++ ] = 5 * decade;
+	}
+	if ( sizes[ count - 1 ] != max_size && max_size > 50 )
+		sizes[ count++ ] = max_size;
+
+	for ( size_t s = 0; s < count; s++ ) {
+		size_t n = sizes[ s ];
+		double ns[ 3 ];
+		int best = 0;
+
+		if ( n > max_size )
+			continue;
+
+		for ( size_t i = 0; i < lookups; i++ ) {
+			uint32_t r = next_random( &seed );
+			keys[ i ] = ( int ) ( ( ( uint64_t ) r * n ) >> 32 ) * 2 + ( int ) ( i & 1 );
+		}
+
+		vSearchEytzingerBuild( sorted, n, eytzinger );
+
+		ns[ 0 ] = run( names[ 0 ], xSearchBinary, sorted, n, keys, lookups );
+		ns[ 1 ] = run( names[ 1 ], xSearchBranchless, sorted, n, keys, lookups );
+		ns[ 2 ] = run( names[ 2 ], xSearchEytzinger, eytzinger, n, keys, lookups );
+
+		for ( int v = 1; v < 3; v++ )
+			if ( ns[ v ] < ns[ best ] )
+				best = v;
+
+		printf( "%zu,%.2f,%.2f,%.2f\n", n, ns[ 0 ], ns[ 1 ], ns[ 2 ] );
+		fprintf( stderr, "%10zu elements: fastest %s\n", n, names[ best ] );
+		fflush( stdout );
+	}
+
+	free( sorted );
+	free( eytzinger );
+	free( keys );
+	return 0;
+}
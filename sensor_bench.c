@@ -0,0 +1,171 @@
+/*
+ * Host benchmark of the temperature conversion in samples per second: the
+ * per sample dWorkloadTemperature() Task 2 runs by default, against the block
+ * conversions in ipsa_sensor.c, with and without the rolling statistics.
+ *
+ * Every path converts the same frames of random readings in the range Task 2
+ * uses.  The best of several runs is printed as CSV, along with the largest
+ * difference from the double precision result, in degrees.
+ *
+ *   gcc -O2 sensor_bench.c ipsa_sensor.c ipsa_workloads.c ipsa_search.c ipsa_bigint.c -o sensor_bench
+ *   ./sensor_bench [frames]
+ *
+ * Add -mavx (or -march=native) to measure the AVX kernel instead of SSE2.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "ipsa_sensor.h"
+#include "ipsa_workloads.h"
+
+#define DEFAULT_FRAMES  200000
+#define RUNS            5
+
+enum path { SCALAR_DOUBLE, BLOCK_FLOAT, BLOCK_FIXED, BLOCK_FLOAT_STATS, BLOCK_FIXED_STATS, PATHS };
+
+static const char * const path_names[ PATHS ] = {
+	"scalar_double", "block_float", "block_fixed", "block_float_stats", "block_fixed_stats"
+};
+
+static volatile double sink;
+
+static uint64_t now_ns( void )
+{
+	struct timespec ts;
+
+	clock_gettime( CLOCK_MONOTONIC, &ts );
+	return ( uint64_t ) ts.tv_sec * 1000000000ULL + ( uint64_t ) ts.tv_nsec;
+}
+
+/* Statistics over the fixed point and float outputs, whichever SensorCelsius_t
+ * is in this build.  The other type is converted first, outside the timing, so
+ * only the statistics update itself is measured. */
+static void add_stats( SensorStats_t * stats, const float * f, const int32_t * q )
+{
+#if ( ipsaSENSOR_FIXED_POINT == 1 )
+	( void ) f;
+	vSensorStatsAddFrame( stats, q, sensorFRAME_SAMPLES );
+#else
+	( void ) q;
+	vSensorStatsAddFrame( stats, f, sensorFRAME_SAMPLES );
+#endif
+}
+
+static double run( enum path p, const int32_t * fahrenheit, size_t frames, double * max_error )
+{
+	static double celsius_double[ sensorFRAME_SAMPLES ];
+	static float celsius_float[ sensorFRAME_SAMPLES ];
+	static int32_t celsius_fixed[ sensorFRAME_SAMPLES ];
+	static SensorStats_t stats;
+	uint64_t start;
+	double error = 0.0;
+
+	vSensorStatsReset( &stats );
+	start = now_ns();
+
+	for ( size_t f = 0; f < frames; f++ ) {
+		const int32_t * frame = &fahrenheit[ f * sensorFRAME_SAMPLES ];
+
+		switch ( p ) {
+		case SCALAR_DOUBLE:
+			for ( int i = 0; i < sensorFRAME_SAMPLES; i++ )
+				celsius_double[ i ] = dWorkloadTemperature( frame[ i ] );
+			break;
+		case BLOCK_FLOAT:
+		case BLOCK_FLOAT_STATS:
+			vSensorConvertFloat( frame, celsius_float, sensorFRAME_SAMPLES );
+			if ( p == BLOCK_FLOAT_STATS )
+				add_stats( &stats, celsius_float, celsius_fixed );
+			break;
+		default:
+			vSensorConvertFixed( frame, celsius_fixed, sensorFRAME_SAMPLES );
+			if ( p == BLOCK_FIXED_STATS )
+				add_stats( &stats, celsius_float, celsius_fixed );
+			break;
+		}
+	}
+
+	double ns = ( double ) ( now_ns() - start );
+
+	/* Check the last frame against the reference conversion. */
+	const int32_t * last = &fahrenheit[ ( frames - 1 ) * sensorFRAME_SAMPLES ];
+	for ( int i = 0; i < sensorFRAME_SAMPLES; i++ ) {
+		double reference = dWorkloadTemperature( last[ i ] ), value;
+
+		if ( p == SCALAR_DOUBLE )
+			value = celsius_double[ i ];
+		else if ( p == BLOCK_FLOAT || p == BLOCK_FLOAT_STATS )
+			value = celsius_float[ i ];
+		else
+			value = celsius_fixed[ i ] / ( double ) ( 1 << sensorFIXED_SHIFT );
+
+		if ( fabs( value - reference ) > error )
+			error = fabs( value - reference );
+		sink += value;
+	}
+
+	*max_error = error;
+	return ( double ) frames * sensorFRAME_SAMPLES / ( ns / 1e9 );
+}
+
+int main( int argc, char * argv[] )
+{
+	size_t frames = argc > 1 ? strtoul( argv[ 1 ], NULL, 0 ) : DEFAULT_FRAMES;
+	int32_t * fahrenheit;
+
+	if ( frames == 0 ) {
+		fprintf( stderr, "usage: %s [frames]\n", argv[ 0 ] );
+		return 1;
+	}
+
+	fahrenheit = malloc( frames * sensorFRAME_SAMPLES * sizeof( int32_t ) );
+	if ( fahrenheit == NULL ) {
+		fprintf( stderr, "not enough memory for %zu frames\n", frames );
+		return 1;
+	}
+
+	srand( 1 );
+	for ( size_t i = 0; i < frames * sensorFRAME_SAMPLES; i++ )
+		fahrenheit[ i ] = 32 + rand() % 50;
+
+	fprintf( stderr, "%zu frames of %d samples, %s kernel, statistics in %s\n", frames, sensorFRAME_SAMPLES,
+#if defined( __AVX__ )
+	         "avx",
+#elif defined( __SSE2__ )
+	         "sse2",
+#else
+	         "scalar",
+#endif
+	         ipsaSENSOR_FIXED_POINT ? "fixed point" : "float" );
+
+	printf( "path,samples_per_s,speedup,max_error_deg\n" );
+
+	double baseline = 0.0;
+
+	for ( int p = 0; p < PATHS; p++ ) {
+		double best = 0.0, error = 0.0;
+
+		/* Statistics are kept in one type per build. */
+		if ( ( p == BLOCK_FLOAT_STATS && ipsaSENSOR_FIXED_POINT ) || ( p == BLOCK_FIXED_STATS && !ipsaSENSOR_FIXED_POINT ) )
+			continue;
+
+		for ( int r = 0; r < RUNS; r++ ) {
+			double rate = run( ( enum path ) p, fahrenheit, frames, &error );
+
+			if ( rate > best )
+				best = rate;
+		}
+
+		if ( p == SCALAR_DOUBLE )
+			baseline = best;
+
+		printf( "%s,%.0f,%.2f,%.2e\n", path_names[ p ], best, best / baseline, error );
+	}
+
+	free( fahrenheit );
+	return 0;
+}
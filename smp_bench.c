@@ -0,0 +1,255 @@
+/*
+ * Host benchmark of the ipsa_sched compute tasks spread over 1 to N cores
+ * with ipsa_partition.c.
+ *
+ * The task set is TASK_COPIES copies of Tasks 2, 3 and 4, running the
+ * workloads from ipsa_workloads.c (each release runs the workload
+ * work_repeat times, to stand for a heavier job).  For k cores there are k
+ * partitions, pinned to the first k CPUs this process may use, and task t
+ * goes to partition t % k.  The release source, in the role of the send
+ * task and the software timer, is the main thread, pinned to the first CPU
+ * with partition 0, and releases a task by pushing a message into its SPSC
+ * inbox.  For each k two runs are made:
+ *   throughput - every task is released again as soon as its inbox has
+ *                room, and the releases handled per second are counted;
+ *   latency    - every task is released once per PERIOD_US, on absolute
+ *                deadlines from ipsa_timing.c, and the time from release to
+ *                start is recorded.
+ * One CSV line is printed per core count, with the speedup of the
+ * throughput over one core and the release latency percentiles over all
+ * tasks.  Idle partitions yield their core rather than sleep, so each core
+ * used shows as busy.
+ *
+ *   gcc -O2 -pthread smp_bench.c ipsa_partition.c ipsa_timing.c ipsa_hist.c ipsa_workloads.c ipsa_search.c ipsa_bigint.c -o smp_bench
+ *   ./smp_bench [max cores] [seconds per run] [work repeat]
+ */
+
+#define _GNU_SOURCE
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "ipsa_hist.h"
+#include "ipsa_partition.h"
+#include "ipsa_spsc.h"
+#include "ipsa_timing.h"
+#include "ipsa_workloads.h"
+
+#define TASK_COPIES         4
+#define TASKS               ( 3 * TASK_COPIES )
+#define MAX_CORES           64
+#define INBOX_LENGTH        64
+#define PERIOD_US           1000
+#define DEFAULT_SECONDS     2
+#define DEFAULT_REPEAT      100
+
+static volatile double sink_double;
+static volatile int sink_int;
+static char sink_product[ workloadPRODUCT_DIGITS ];
+static volatile int64_t multiply_a = workloadMULTIPLY_A;
+static volatile int64_t multiply_b = workloadMULTIPLY_B;
+static unsigned work_repeat = DEFAULT_REPEAT;
+
+static PartitionTask_t tasks[ TASKS ];
+static SpscRing_t inboxes[ TASKS ];
+static IpsaMessage_t slots[ TASKS ][ INBOX_LENGTH ];
+static Partition_t partitions[ MAX_CORES ];
+
+static void run_temperature( const IpsaMessage_t * message )
+{
+	for ( unsigned i = 0; i < work_repeat; i++ )
+		sink_double = dWorkloadTemperature( 32 + ( int ) ( ( message->ulValue + i ) % 50 ) );
+}
+
+static void run_multiply( const IpsaMessage_t * message )
+{
+	( void ) message;
+
+	for ( unsigned i = 0; i < work_repeat; i++ )
+		sink_int = iWorkloadMultiply( multiply_a, multiply_b, sink_product, sizeof( sink_product ) );
+}
+
+static void run_search( const IpsaMessage_t * message )
+{
+	int iterations;
+
+	( void ) message;
+
+	for ( unsigned i = 0; i < work_repeat; i++ )
+		sink_int = iWorkloadSearch( iWorkloadSearchTable, workloadSEARCH_TABLE_LENGTH, workloadSEARCH_KEY, &iterations );
+}
+
+static void pin_self( int cpu )
+{
+	cpu_set_t set;
+
+	CPU_ZERO( &set );
+	CPU_SET( cpu, &set );
+	pthread_setaffinity_np( pthread_self(), sizeof( set ), &set );
+}
+
+/* Set up k partitions over the first k CPUs and start them.  Returns 0 or -1. */
+static int start_partitions( const int * cpus, int k )
+{
+	static const char * const names[ 3 ] = { "Task 2", "Task 3", "Task 4" };
+	static void ( * const workloads[ 3 ] )( const IpsaMessage_t * ) = { run_temperature, run_multiply, run_search };
+
+	for ( int p = 0; p < k; p++ )
+		vPartitionInit( &partitions[ p ], cpus[ p ] );
+
+	for ( int t = 0; t < TASKS; t++ ) {
+		vSpscInit( &inboxes[ t ], slots[ t ], INBOX_LENGTH );
+		tasks[ t ].pcName = names[ t % 3 ];
+		tasks[ t ].pvWorkload = workloads[ t % 3 ];
+		tasks[ t ].pxInbox = &inboxes[ t ];
+		iPartitionAddTask( &partitions[ t % k ], &tasks[ t ] );
+	}
+
+	for ( int p = 0; p < k; p++ ) {
+		if ( iPartitionStart( &partitions[ p ] ) != 0 ) {
+			fprintf( stderr, "could not start the partition on cpu %d\n", cpus[ p ] );
+
+			while ( p-- > 0 )
+				vPartitionStop( &partitions[ p ] );
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+static uint64_t stop_partitions( int k, Histogram_t * latency )
+{
+	uint64_t runs = 0;
+
+	for ( int p = 0; p < k; p++ )
+		vPartitionStop( &partitions[ p ] );
+
+	if ( latency != NULL )
+		vHistogramReset( latency );
+
+	for ( int t = 0; t < TASKS; t++ ) {
+		runs += tasks[ t ].ullRuns;
+
+		if ( latency != NULL )
+			vHistogramMerge( latency, &tasks[ t ].xReleaseToStart );
+	}
+
+	return runs;
+}
+
+static double run_throughput( const int * cpus, int k, double seconds )
+{
+	IpsaMessage_t message = { 0 };
+	uint64_t end, start;
+	int pushed;
+
+	if ( start_partitions( cpus, k ) != 0 )
+		return 0.0;
+
+	start = ullTimingMonotonicNs();
+	end = start + ( uint64_t ) ( seconds * 1e9 );
+
+	while ( ullTimingMonotonicNs() < end ) {
+		pushed = 0;
+
+		for ( int t = 0; t < TASKS; t++ ) {
+			message.ulValue++;
+			message.ullReleaseNs = ullTimingMonotonicNs();
+			pushed += iSpscPush( &inboxes[ t ], &message );
+		}
+
+		if ( !pushed )
+			sched_yield();
+	}
+
+	return ( double ) stop_partitions( k, NULL ) / ( ( double ) ( ullTimingMonotonicNs() - start ) / 1e9 );
+}
+
+static uint64_t run_latency( const int * cpus, int k, double seconds, Histogram_t * latency )
+{
+	IpsaMessage_t message = { 0 };
+	Timing_t timing;
+	uint64_t periods = ( uint64_t ) ( seconds * 1e6 / PERIOD_US ), dropped = 0;
+
+	if ( start_partitions( cpus, k ) != 0 )
+		return 0;
+
+	if ( iTimingStart( &timing, eTimingNanosleep, PERIOD_US * 1000ULL ) != 0 ) {
+		perror( "iTimingStart" );
+		stop_partitions( k, latency );
+		return 0;
+	}
+
+	for ( uint64_t i = 0; i < periods; i++ ) {
+		/* Releases are stamped with their ideal time, so a late source
+		 * counts as release latency too. */
+		message.ullReleaseNs = ullTimingWait( &timing );
+
+		for ( int t = 0; t < TASKS; t++ ) {
+			message.ulValue++;
+			dropped += iSpscPush( &inboxes[ t ], &message ) ? 0 : 1;
+		}
+	}
+
+	vTimingStop( &timing );
+	stop_partitions( k, latency );
+
+	return dropped;
+}
+
+int main( int argc, char * argv[] )
+{
+	static Histogram_t latency;
+	int max_cores = argc > 1 ? atoi( argv[ 1 ] ) : MAX_CORES;
+	double seconds = argc > 2 ? atof( argv[ 2 ] ) : DEFAULT_SECONDS;
+	int cpus[ MAX_CORES ], allowed = 0;
+	double base = 0.0, throughput;
+	uint64_t dropped;
+	cpu_set_t set;
+
+	if ( argc > 3 )
+		work_repeat = ( unsigned ) strtoul( argv[ 3 ], NULL, 0 );
+
+	if ( max_cores <= 0 || seconds <= 0.0 || work_repeat == 0 ) {
+		fprintf( stderr, "usage: %s [max cores] [seconds per run] [work repeat]\n", argv[ 0 ] );
+		return 1;
+	}
+
+	sched_getaffinity( 0, sizeof( set ), &set );
+
+	for ( int c = 0; c < CPU_SETSIZE && allowed < MAX_CORES; c++ )
+		if ( CPU_ISSET( c, &set ) )
+			cpus[ allowed++ ] = c;
+
+	if ( max_cores > allowed )
+		max_cores = allowed;
+
+	/* The source shares the first core with partition 0. */
+	pin_self( cpus[ 0 ] );
+
+	fprintf( stderr, "%d tasks, work repeat %u, cores 1 to %d\n", TASKS, work_repeat, max_cores );
+	printf( "cores,tasks,releases_per_s,speedup,dropped,p50_latency_us,p99_latency_us,max_latency_us\n" );
+
+	for ( int k = 1; k <= max_cores; k++ ) {
+		throughput = run_throughput( cpus, k, seconds );
+
+		if ( k == 1 )
+			base = throughput;
+
+		dropped = run_latency( cpus, k, seconds, &latency );
+
+		printf( "%d,%d,%.0f,%.2f,%llu,%.1f,%.1f,%.1f\n", k, TASKS, throughput, base > 0.0 ? throughput / base : 0.0,
+			( unsigned long long ) dropped,
+			ullHistogramPercentile( &latency, 50.0 ) / 1000.0,
+			ullHistogramPercentile( &latency, 99.0 ) / 1000.0,
+			latency.ullMax / 1000.0 );
+		fflush( stdout );
+	}
+
+	return 0;
+}
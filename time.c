@@ -1,18 +1,29 @@
 #include<stdio.h>
-#include<time.h>
-#include <unistd.h>
+
+#include "ipsa_timing.h"
+
+// gcc time.c ipsa_timing.c -o time
 
 int main(){
 
-	 time_t begin = time(NULL);
-    
+    Timing_t timing;
+    uint64_t begin = ullTimingMonotonicNs();
+
+    // Absolute deadlines every second: begin + 1 s, begin + 2 s, ... so the
+    // time spent printing does not add up from one period to the next.
+    if (iTimingStart( &timing, eTimingNanosleep, 1000000000ULL ) != 0){
+        perror( "iTimingStart" );
+        return 1;
+    }
+
     for (int i=0;i<5;i++){
-    
-    	sleep( 1 );    // Wait 2 seconds, but no ticks are consumed
-    	time_t end = time(NULL);
-    	unsigned long secondes = (unsigned long) difftime( end, begin );
-    	printf( "Finished in %ld sec\n", secondes );
+
+        ullTimingWait( &timing );
+        uint64_t end = ullTimingMonotonicNs();
+        double secondes = ( end - begin ) / 1e9;
+        printf( "Finished in %.6f sec\n", secondes );
     }
-    
-      
+
+    vTimingStop( &timing );
+    return 0;
 }
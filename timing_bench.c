@@ -0,0 +1,123 @@
+/*
+ * Host benchmark of periodic release timing: how far each way of waiting for
+ * the next period drifts from the ideal schedule start + k * period, and how
+ * much each release jitters around it.
+ *
+ *   sleep      - a relative nanosleep( period ) after the work, the way
+ *                time.c used sleep( 1 ): every wake up delay and the work
+ *                itself add up;
+ *   nanosleep  - ullTimingWait(), absolute clock_nanosleep() deadlines;
+ *   timerfd    - ullTimingWait() on a periodic timerfd.
+ *
+ * Each release spins for work_us, then waits for the next one.  Lateness is
+ * the time from a release's ideal time to the wake up, on CLOCK_MONOTONIC,
+ * the clock the deadlines are set on.  The work is timed with the cheaper
+ * TSC clock from ipsa_timing.h when the CPU has one; a calibration error of
+ * a few parts per million would show up as drift over a long run.  drift_us
+ * is the lateness of the last release: with absolute deadlines it stays at
+ * the wake up latency, with relative sleeps it grows with the run.  Releases
+ * an absolute method had to skip, because the previous one ran past them,
+ * are counted in overruns; a relative sleep never skips, it just falls
+ * further behind.  The RTOS vTaskDelayUntil() equivalent is
+ * ipsa_timing_bench.c, which prints the same columns.
+ *
+ *   gcc -O2 timing_bench.c ipsa_timing.c ipsa_hist.c -o timing_bench
+ *   ./timing_bench [periods] [period_us] [work_us]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "ipsa_hist.h"
+#include "ipsa_timing.h"
+
+#define DEFAULT_PERIODS    10000
+#define DEFAULT_PERIOD_US  1000
+#define DEFAULT_WORK_US    100
+
+enum method { METHOD_SLEEP, METHOD_NANOSLEEP, METHOD_TIMERFD, METHOD_COUNT };
+
+static const char * const method_names[ METHOD_COUNT ] = { "sleep", "nanosleep", "timerfd" };
+
+static Histogram_t lateness;
+
+static void spin( uint64_t ns )
+{
+	uint64_t end = ullTimingNowNs() + ns;
+
+	while( ullTimingNowNs() < end )
+		;
+}
+
+static void run( enum method method, unsigned long periods, uint64_t period_ns, uint64_t work_ns )
+{
+	struct timespec relative = { ( time_t ) ( period_ns / 1000000000ULL ), ( long ) ( period_ns % 1000000000ULL ) };
+	Timing_t timing;
+	uint64_t start = 0, ideal, late = 0;
+	unsigned long k;
+
+	vHistogramReset( &lateness );
+
+	if( method != METHOD_SLEEP &&
+	    iTimingStart( &timing, method == METHOD_TIMERFD ? eTimingTimerfd : eTimingNanosleep, period_ns ) != 0 ) {
+		perror( method_names[ method ] );
+		return;
+	}
+
+	if( method == METHOD_SLEEP )
+		start = ullTimingMonotonicNs();
+
+	for( k = 1; k <= periods; k++ ) {
+		/* ullTimingWait() returns the ideal time of the release, skipping
+		 * any that were overrun. */
+		if( method == METHOD_SLEEP ) {
+			nanosleep( &relative, NULL );
+			ideal = start + k * period_ns;
+		} else {
+			ideal = ullTimingWait( &timing );
+		}
+
+		late = ullTimingMonotonicNs();
+		late = late > ideal ? late - ideal : 0;
+		vHistogramRecord( &lateness, late );
+
+		spin( work_ns );
+	}
+
+	if( method != METHOD_SLEEP )
+		vTimingStop( &timing );
+
+	printf( "%s,%lu,%llu,%llu,%.1f,%.1f,%.1f,%.1f\n",
+		method_names[ method ], periods,
+		( unsigned long long ) ( period_ns / 1000 ),
+		method == METHOD_SLEEP ? 0ULL : ( unsigned long long ) timing.ullOverruns,
+		late / 1000.0,
+		ullHistogramPercentile( &lateness, 50.0 ) / 1000.0,
+		ullHistogramPercentile( &lateness, 99.0 ) / 1000.0,
+		lateness.ullMax / 1000.0 );
+	fflush( stdout );
+}
+
+int main( int argc, char * argv[] )
+{
+	unsigned long periods = argc > 1 ? strtoul( argv[ 1 ], NULL, 0 ) : DEFAULT_PERIODS;
+	uint64_t period_ns = ( argc > 2 ? strtoull( argv[ 2 ], NULL, 0 ) : DEFAULT_PERIOD_US ) * 1000ULL;
+	uint64_t work_ns = ( argc > 3 ? strtoull( argv[ 3 ], NULL, 0 ) : DEFAULT_WORK_US ) * 1000ULL;
+	int m;
+
+	if( periods == 0 || period_ns == 0 || work_ns >= period_ns ) {
+		fprintf( stderr, "usage: %s [periods] [period_us] [work_us < period_us]\n", argv[ 0 ] );
+		return 1;
+	}
+
+	fprintf( stderr, "clock: %s\n", iTimingCalibrateTsc( 100 ) == 0 ? "tsc" : "clock_gettime" );
+
+	printf( "method,periods,period_us,overruns,drift_us,p50_late_us,p99_late_us,max_late_us\n" );
+
+	for( m = 0; m < METHOD_COUNT; m++ )
+		run( ( enum method ) m, periods, period_ns, work_ns );
+
+	return 0;
+}
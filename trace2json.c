@@ -0,0 +1,169 @@
+/*
+ * Convert a capture written by iTraceDump() (ipsa_trace.c) into the Chrome
+ * trace event JSON format, viewable in chrome://tracing or ui.perfetto.dev.
+ *
+ * Every task gets its own row; each period between a task being switched in
+ * and switched out is one slice, so the slices show which task held the CPU
+ * and for how long.  Queue operations and timer expiries are drawn as instant
+ * events on the row of the task that performed them.  A CPU time summary per
+ * task is printed on stderr.
+ *
+ *   gcc -O2 trace2json.c -o trace2json
+ *   ./trace2json ipsa_trace.bin > ipsa_trace.json
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ipsa_trace.h"
+
+#define MAX_TASKS 65536
+
+static const char * queue_types[] = { "queue", "mutex", "counting semaphore", "binary semaphore", "recursive mutex", "queue set" };
+
+static TraceName_t * names;
+static uint32_t name_count;
+static uint64_t switched_in_at[ MAX_TASKS ];
+static uint64_t cpu_ns[ MAX_TASKS ];
+static unsigned char running[ MAX_TASKS ];
+
+static const char * lookup( uint32_t kind, uint32_t id )
+{
+	for ( uint32_t i = 0; i < name_count; i++ )
+		if ( names[ i ].ulKind == kind && names[ i ].ulId == id )
+			return names[ i ].cName;
+	return NULL;
+}
+
+static double us( uint64_t t, uint64_t origin )
+{
+	return ( double ) ( t - origin ) / 1000.0;
+}
+
+int main( int argc, char * argv[] )
+{
+	TraceFileHeader_t header;
+	TraceRecord_t * records;
+	FILE * in;
+	uint64_t origin, end, total = 0;
+
+	if ( argc != 2 ) {
+		fprintf( stderr, "usage: %s capture.bin > capture.json\n", argv[ 0 ] );
+		return 2;
+	}
+
+	in = fopen( argv[ 1 ], "rb" );
+	if ( in == NULL ) {
+		perror( argv[ 1 ] );
+		return 1;
+	}
+
+	if ( fread( &header, sizeof( header ), 1, in ) != 1 ||
+	     memcmp( header.cMagic, traceFILE_MAGIC, sizeof( header.cMagic ) ) != 0 ||
+	     header.ulRecordSize != sizeof( TraceRecord_t ) ) {
+		fprintf( stderr, "%s: not a trace capture\n", argv[ 1 ] );
+		return 1;
+	}
+
+	name_count = header.ulNameCount;
+	names = calloc( name_count + 1, sizeof( TraceName_t ) );
+	records = calloc( header.ullRecordCount + 1, sizeof( TraceRecord_t ) );
+
+	if ( names == NULL || records == NULL ||
+	     fread( names, sizeof( TraceName_t ), name_count, in ) != name_count ||
+	     fread( records, sizeof( TraceRecord_t ), header.ullRecordCount, in ) != header.ullRecordCount ) {
+		fprintf( stderr, "%s: truncated capture\n", argv[ 1 ] );
+		return 1;
+	}
+
+	fclose( in );
+
+	if ( header.ullRecordCount == 0 ) {
+		printf( "{\"traceEvents\":[]}\n" );
+		return 0;
+	}
+
+	origin = records[ 0 ].ullTimeNs;
+	end = records[ header.ullRecordCount - 1 ].ullTimeNs;
+
+	printf( "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n" );
+	printf( "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"ipsa_sched\"}}" );
+
+	for ( uint32_t i = 0; i < name_count; i++ )
+		if ( names[ i ].ulKind == traceNAME_TASK )
+			printf( ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s (%u)\"}}",
+			        names[ i ].ulId, names[ i ].cName, names[ i ].ulId );
+
+	for ( uint64_t i = 0; i < header.ullRecordCount; i++ ) {
+		const TraceRecord_t * r = &records[ i ];
+		const char * name;
+
+		switch ( r->ucEvent ) {
+		case traceEVENT_SWITCH_IN:
+			switched_in_at[ r->usTask ] = r->ullTimeNs;
+			running[ r->usTask ] = 1;
+			break;
+
+		case traceEVENT_SWITCH_OUT:
+			/* A task already running when the capture starts has no
+			 * switch in; start its slice at the first record. */
+			if ( !running[ r->usTask ] )
+				switched_in_at[ r->usTask ] = origin;
+			name = lookup( traceNAME_TASK, r->usTask );
+			printf( ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+			        name ? name : "task", r->usTask, us( switched_in_at[ r->usTask ], origin ),
+			        us( r->ullTimeNs, switched_in_at[ r->usTask ] ) );
+			cpu_ns[ r->usTask ] += r->ullTimeNs - switched_in_at[ r->usTask ];
+			total += r->ullTimeNs - switched_in_at[ r->usTask ];
+			running[ r->usTask ] = 0;
+			break;
+
+		case traceEVENT_QUEUE_SEND:
+		case traceEVENT_QUEUE_SEND_FAIL:
+		case traceEVENT_QUEUE_RECEIVE:
+			printf( ",\n{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"args\":{\"object\":\"0x%08x\",\"type\":\"%s\"}}",
+			        r->ucEvent == traceEVENT_QUEUE_SEND ? "send" : r->ucEvent == traceEVENT_QUEUE_RECEIVE ? "receive" : "send failed",
+			        r->usTask, us( r->ullTimeNs, origin ), r->ulObject,
+			        r->ucDetail < sizeof( queue_types ) / sizeof( queue_types[ 0 ] ) ? queue_types[ r->ucDetail ] : "unknown" );
+			break;
+
+		case traceEVENT_TIMER_EXPIRED:
+			name = lookup( traceNAME_TIMER, r->ulObject );
+			printf( ",\n{\"name\":\"%s expired\",\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":%u,\"ts\":%.3f}",
+			        name ? name : "timer", r->usTask, us( r->ullTimeNs, origin ) );
+			break;
+
+		default:
+			break;
+		}
+	}
+
+	/* A task still switched in at the last record, always including the one
+	 * that dumped the capture, ran until the end of it. */
+	for ( uint32_t t = 0; t < MAX_TASKS; t++ ) {
+		if ( !running[ t ] )
+			continue;
+		const char * name = lookup( traceNAME_TASK, t );
+		printf( ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+		        name ? name : "task", t, us( switched_in_at[ t ], origin ), us( end, switched_in_at[ t ] ) );
+		cpu_ns[ t ] += end - switched_in_at[ t ];
+		total += end - switched_in_at[ t ];
+	}
+
+	printf( "\n]}\n" );
+
+	fprintf( stderr, "%llu records over %.3f ms, %llu lost before the dump\n",
+	         ( unsigned long long ) header.ullRecordCount, us( end, origin ) / 1000.0,
+	         ( unsigned long long ) header.ullLostCount );
+
+	for ( uint32_t t = 0; t < MAX_TASKS; t++ ) {
+		if ( cpu_ns[ t ] == 0 )
+			continue;
+		const char * name = lookup( traceNAME_TASK, t );
+		fprintf( stderr, "%-16s %12.3f ms %6.2f%%\n", name ? name : "?", cpu_ns[ t ] / 1e6,
+		         total ? 100.0 * cpu_ns[ t ] / total : 0.0 );
+	}
+
+	return 0;
+}
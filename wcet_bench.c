@@ -0,0 +1,197 @@
+/*
+ * Host benchmark of the execution time of the receive task workloads in
+ * ipsa_workloads.c, to feed worst case execution times into priority and
+ * period assignment.
+ *
+ * Each workload is timed one call at a time, in two variants:
+ *   warm - called back to back, so its code and data stay in cache;
+ *   cold - before every call the caches are filled with other data and the
+ *          workload's own data is flushed, as after a long time blocked.
+ * The cost of the timing itself is measured first and subtracted.  The
+ * result is printed as CSV: min, median and max (the high water mark) per
+ * variant, plus a WCET estimate, the high water mark with a safety margin
+ * added, since a measured maximum is only a lower bound of the real worst
+ * case.
+ *
+ *   gcc -O2 wcet_bench.c ipsa_workloads.c ipsa_search.c ipsa_bigint.c -o wcet_bench
+ *   ./wcet_bench [warm samples] [cold samples]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#if defined( __x86_64__ ) || defined( __i386__ )
+#include <x86intrin.h>
+#define HAVE_TSC 1
+#else
+#define HAVE_TSC 0
+#endif
+
+#include "ipsa_workloads.h"
+
+#define DEFAULT_WARM_SAMPLES  1000000
+#define DEFAULT_COLD_SAMPLES  10000
+#define EVICT_BYTES           ( 8u << 20 )
+#define WCET_MARGIN           1.20
+
+static volatile double sink_double;
+static char sink_product[ workloadPRODUCT_DIGITS ];
+static volatile int sink_int;
+static volatile int64_t multiply_a = workloadMULTIPLY_A;
+static volatile int64_t multiply_b = workloadMULTIPLY_B;
+
+static unsigned char * evict_buffer;
+static double ns_per_tick = 1.0;
+
+static uint64_t clock_ns( void )
+{
+	struct timespec ts;
+
+	clock_gettime( CLOCK_MONOTONIC, &ts );
+	return ( uint64_t ) ts.tv_sec * 1000000000ULL + ( uint64_t ) ts.tv_nsec;
+}
+
+static inline uint64_t ticks( void )
+{
+#if HAVE_TSC
+	unsigned int aux;
+	uint64_t t;
+
+	_mm_lfence();
+	t = __rdtscp( &aux );
+	_mm_lfence();
+	return t;
+#else
+	return clock_ns();
+#endif
+}
+
+static void calibrate( void )
+{
+#if HAVE_TSC
+	uint64_t t0 = clock_ns(), c0 = ticks();
+
+	while ( clock_ns() - t0 < 200000000ULL )
+		;
+	ns_per_tick = ( double ) ( clock_ns() - t0 ) / ( double ) ( ticks() - c0 );
+#endif
+}
+
+static void run_temperature( unsigned i )
+{
+	sink_double = dWorkloadTemperature( 32 + ( int ) ( i % 50 ) );
+}
+
+static void run_multiply( unsigned i )
+{
+	( void ) i;
+	sink_int = iWorkloadMultiply( multiply_a, multiply_b, sink_product, sizeof( sink_product ) );
+}
+
+static void run_search( unsigned i )
+{
+	int iterations;
+
+	( void ) i;
+	sink_int = iWorkloadSearch( iWorkloadSearchTable, workloadSEARCH_TABLE_LENGTH, workloadSEARCH_KEY, &iterations );
+}
+
+static void run_nothing( unsigned i )
+{
+	( void ) i;
+}
+
+static void make_cold( void )
+{
+	/* Walk a buffer larger than the private caches so everything the
+	 * workload used is pushed out, then flush its table explicitly in case
+	 * it sits in a shared cache larger than the buffer. */
+	for ( size_t i = 0; i < EVICT_BYTES; i += 64 )
+		evict_buffer[ i ]++;
+
+#if HAVE_TSC
+	for ( size_t i = 0; i < sizeof( iWorkloadSearchTable ); i += 64 )
+		_mm_clflush( ( const char * ) iWorkloadSearchTable + i );
+	_mm_mfence();
+#endif
+}
+
+static int compare_u64( const void * a, const void * b )
+{
+	uint64_t x = *( const uint64_t * ) a, y = *( const uint64_t * ) b;
+
+	return ( x > y ) - ( x < y );
+}
+
+/* Time n calls of fn and leave the sorted per-call costs, in ticks, in out. */
+static void measure( void ( *fn )( unsigned ), int cold, size_t n, uint64_t * out, uint64_t overhead )
+{
+	for ( size_t i = 0; i < n; i++ ) {
+		uint64_t start, stop;
+
+		if ( cold )
+			make_cold();
+
+		start = ticks();
+		fn( ( unsigned ) i );
+		stop = ticks();
+
+		out[ i ] = ( stop - start > overhead ) ? stop - start - overhead : 0;
+	}
+
+	qsort( out, n, sizeof( out[ 0 ] ), compare_u64 );
+}
+
+int main( int argc, char * argv[] )
+{
+	static const struct {
+		const char * name;
+		void ( *fn )( unsigned );
+	} kernels[] = {
+		{ "temperature", run_temperature },
+		{ "multiply", run_multiply },
+		{ "search", run_search },
+	};
+	size_t warm = argc > 1 ? strtoul( argv[ 1 ], NULL, 0 ) : DEFAULT_WARM_SAMPLES;
+	size_t cold = argc > 2 ? strtoul( argv[ 2 ], NULL, 0 ) : DEFAULT_COLD_SAMPLES;
+	size_t most = warm > cold ? warm : cold;
+	uint64_t * samples = malloc( ( most ? most : 1 ) * sizeof( uint64_t ) );
+	uint64_t overhead;
+
+	evict_buffer = calloc( EVICT_BYTES, 1 );
+
+	if ( samples == NULL || evict_buffer == NULL || warm == 0 || cold == 0 ) {
+		fprintf( stderr, "usage: %s [warm samples] [cold samples]\n", argv[ 0 ] );
+		return 1;
+	}
+
+	calibrate();
+
+	/* The smallest cost of timing an empty call is the fixed overhead. */
+	measure( run_nothing, 0, warm, samples, 0 );
+	overhead = samples[ 0 ];
+
+	fprintf( stderr, "timer: %s, %.3f ns/tick, overhead %llu ticks subtracted\n",
+	         HAVE_TSC ? "tsc" : "clock_gettime", ns_per_tick, ( unsigned long long ) overhead );
+
+	printf( "kernel,variant,samples,min_ns,median_ns,max_ns,wcet_estimate_ns\n" );
+
+	for ( size_t k = 0; k < sizeof( kernels ) / sizeof( kernels[ 0 ] ); k++ ) {
+		for ( int variant = 0; variant < 2; variant++ ) {
+			size_t n = variant ? cold : warm;
+
+			measure( kernels[ k ].fn, variant, n, samples, overhead );
+
+			printf( "%s,%s,%zu,%.1f,%.1f,%.1f,%.1f\n", kernels[ k ].name, variant ? "cold" : "warm", n,
+			        samples[ 0 ] * ns_per_tick, samples[ n / 2 ] * ns_per_tick,
+			        samples[ n - 1 ] * ns_per_tick, samples[ n - 1 ] * ns_per_tick * WCET_MARGIN );
+		}
+	}
+
+	free( samples );
+	free( evict_buffer );
+	return 0;
+}